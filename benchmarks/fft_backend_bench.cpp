@@ -0,0 +1,105 @@
+// Times the real-to-complex FFTs of the radar captures with each backend in
+// the build: FFTW (measured plans) and the built-in kernels specialized on
+// size, in both precisions, and checks they agree:
+//
+//   fft_backend_bench [repeats]
+#include "fft_plan_cache.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr int SIZES[] = {512, 1024, 2048, 4096};
+
+struct Result {
+    double micros = 0.0;
+    std::vector<double> spectrum;
+};
+
+template <typename Real>
+Result timeTransform(FftPlanCache& cache, FftPrecision precision, const std::vector<double>& signal, int repeats) {
+    Result result;
+    int size = static_cast<int>(signal.size());
+    FftPlan* plan = cache.get({size, FftDirection::RealToComplex, precision, FFT_PLAN_MEASURE});
+    if (!plan) {
+        return result;
+    }
+    FftWorkspace workspace;
+    Real* in = workspace.input<Real>(*plan);
+    Real* out = workspace.output<Real>(*plan);
+    for (int i = 0; i < size; i++) {
+        in[i] = static_cast<Real>(signal[i]);
+    }
+    plan->execute(in, out);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        plan->execute(in, out);
+    }
+    result.micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+                    repeats;
+    result.spectrum.assign(out, out + size + 2);
+    return result;
+}
+}
+
+int main(int argc, char* argv[]) {
+    int repeats = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    Logger::init();
+    Logger::setLogLevel(LogLevel::ERROR);
+
+    std::vector<FftBackend> backends = {FftBackend::Static};
+    if (fftBackendAvailable(FftBackend::Fftw)) {
+        backends.insert(backends.begin(), FftBackend::Fftw);
+    }
+
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, 20.0);
+    std::cout << repeats << " repeats, us per transform" << std::endl;
+    std::cout << std::setw(6) << "size" << std::setw(10) << "precision";
+    for (FftBackend backend : backends) {
+        std::cout << std::setw(10) << fftBackendName(backend);
+    }
+    std::cout << std::setw(14) << "max diff" << std::endl;
+
+    for (int size : SIZES) {
+        // A ball return over ADC noise, like a capture
+        std::vector<double> signal(size);
+        for (int i = 0; i < size; i++) {
+            signal[i] = 300.0 * std::cos(2.0 * M_PI * 0.11 * i) + noise(rng);
+        }
+
+        for (FftPrecision precision : {FftPrecision::Double, FftPrecision::Single}) {
+            std::vector<Result> results;
+            for (FftBackend backend : backends) {
+                FftPlanCache cache(backend);
+                results.push_back(precision == FftPrecision::Double
+                                      ? timeTransform<double>(cache, precision, signal, repeats)
+                                      : timeTransform<float>(cache, precision, signal, repeats));
+            }
+
+            std::cout << std::setw(6) << size << std::setw(10)
+                      << (precision == FftPrecision::Double ? "double" : "single") << std::fixed
+                      << std::setprecision(2);
+            for (const Result& result : results) {
+                std::cout << std::setw(10) << result.micros;
+            }
+            double difference = 0.0;
+            if (results.size() > 1 && results[0].spectrum.size() == results[1].spectrum.size()) {
+                for (size_t i = 0; i < results[0].spectrum.size(); i++) {
+                    difference = std::max(difference, std::abs(results[0].spectrum[i] - results[1].spectrum[i]));
+                }
+            }
+            std::cout << std::setw(14) << std::scientific << std::setprecision(1) << difference << std::endl;
+            std::cout << std::defaultfloat;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+// Measures how radar capture throughput scales when several threads analyze
+// captures at once (rapid-fire sessions with overlapping shots):
+//
+//   fft_contention_bench [max_threads] [captures_per_thread] [capture_length]
+#include "logger.hpp"
+#include "radar.hpp"
+#include "sample_source.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+    int capturesPerThread = argc > 2 ? std::atoi(argv[2]) : 500;
+    int captureLength = argc > 3 ? std::atoi(argv[3]) : DEFAULT_SAMPLE_COUNT;
+    maxThreads = std::max(1, maxThreads);
+    
+    Logger::init();
+    Logger::setLogLevel(LogLevel::ERROR);
+    
+    SyntheticSignal signal;
+    signal.ballSpeedMPH = 120.0f;
+    SyntheticSampleSource source(signal, DEFAULT_SAMPLE_FREQ);
+    std::vector<int> capture(captureLength);
+    source.read(capture.data(), capture.size());
+    
+    RadarManager& radar = RadarManager::getInstance();
+    radar.init();
+    radar.processSamples(capture, DEFAULT_SAMPLE_FREQ);  // Create the plan up front
+    
+    std::cout << capturesPerThread << " captures of " << captureLength << " samples per thread" << std::endl;
+    double singleThreadRate = 0.0;
+    for (int threadCount = 1; threadCount <= maxThreads; threadCount++) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; t++) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < capturesPerThread; i++) {
+                    radar.processSamples(capture, DEFAULT_SAMPLE_FREQ);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        double rate = threadCount * capturesPerThread / seconds;
+        if (threadCount == 1) {
+            singleThreadRate = rate;
+        }
+        std::cout << std::setw(2) << threadCount << " threads: " << std::fixed << std::setprecision(0)
+                  << std::setw(8) << rate << " captures/s (" << std::setprecision(2)
+                  << rate / singleThreadRate << "x)" << std::endl;
+    }
+    
+    radar.cleanup();
+    return 0;
+}
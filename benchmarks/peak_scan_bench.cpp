@@ -0,0 +1,104 @@
+// Times the bin-scan stage of the radar analysis alone: from the FFT
+// output to the strongest bins. Compares the previous scan (square root of
+// every bin, re-sorting a vector of peaks on every insert) with the power
+// spectrum and fixed-size heap now used:
+//
+//   peak_scan_bench [fft_size] [spectra] [repeats]
+#include "spectrum.hpp"
+#include "aligned_allocator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr size_t TOP_PEAKS = 5;
+
+struct Peak {
+    int index;
+    double magnitude;
+};
+
+// The scan as it was: magnitudes, then a sorted vector of the top bins
+int sortedVectorScan(const double* spectrum, size_t size, AlignedVector<double>& magnitudes) {
+    size_t bins = size / 2 + 1;
+    computeMagnitudes(spectrum, bins, magnitudes.data());
+    std::vector<Peak> peaks;
+    for (size_t i = 1; i < size / 2; i++) {
+        double magnitude = magnitudes[i];
+        if (peaks.size() < TOP_PEAKS || magnitude > peaks.back().magnitude) {
+            peaks.push_back({static_cast<int>(i), magnitude});
+            std::sort(peaks.begin(), peaks.end(),
+                      [](const Peak& a, const Peak& b) { return a.magnitude > b.magnitude; });
+            if (peaks.size() > TOP_PEAKS) {
+                peaks.pop_back();
+            }
+        }
+    }
+    return peaks.front().index;
+}
+
+int heapScan(const double* spectrum, size_t size, AlignedVector<double>& powers) {
+    size_t bins = size / 2 + 1;
+    computePowers(spectrum, bins, powers.data());
+    TopBins<double, TOP_PEAKS> top;
+    top.scan(powers.data(), 1, size / 2);
+    SpectralBin<double> peaks[TOP_PEAKS];
+    top.sorted(peaks);
+    return peaks[0].index;
+}
+
+template <typename Scan>
+double timeScan(Scan scan, const std::vector<AlignedVector<double>>& spectra, size_t size, int repeats,
+                long& checksum) {
+    AlignedVector<double> buffer(size / 2 + 1);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (const auto& spectrum : spectra) {
+            checksum += scan(spectrum.data(), size, buffer);
+        }
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+           (repeats * spectra.size());
+}
+}
+
+int main(int argc, char* argv[]) {
+    size_t size = argc > 1 ? std::atoi(argv[1]) : 1024;
+    int spectrumCount = argc > 2 ? std::atoi(argv[2]) : 64;
+    int repeats = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    // Noise floor with a few returns, as the FFT leaves it: interleaved
+    // (real, imaginary) pairs
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, 50.0);
+    std::vector<AlignedVector<double>> spectra(spectrumCount, AlignedVector<double>(size + 2));
+    for (int s = 0; s < spectrumCount; s++) {
+        for (double& value : spectra[s]) {
+            value = noise(rng);
+        }
+        for (int k = 0; k < 3; k++) {
+            size_t bin = 1 + rng() % (size / 2 - 1);
+            spectra[s][2 * bin] += 20000.0 / (k + 1);
+        }
+    }
+
+    long sortedChecksum = 0;
+    long heapChecksum = 0;
+    double sortedMicros = timeScan(sortedVectorScan, spectra, size, repeats, sortedChecksum);
+    double heapMicros = timeScan(heapScan, spectra, size, repeats, heapChecksum);
+
+    std::cout << spectrumCount << " spectra of " << size / 2 + 1 << " bins, " << repeats << " repeats" << std::endl;
+    std::cout << std::fixed << std::setprecision(2)
+              << "magnitudes + sorted vector: " << sortedMicros << " us per spectrum" << std::endl
+              << "powers + top-" << TOP_PEAKS << " heap:       " << heapMicros << " us per spectrum" << std::endl;
+    if (sortedChecksum != heapChecksum) {
+        std::cout << "The scans found different peaks!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
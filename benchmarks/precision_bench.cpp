@@ -0,0 +1,74 @@
+// Compares the double and single precision radar DSP paths (window, FFT,
+// magnitudes, peak search) on the same synthetic captures:
+//
+//   precision_bench [captures] [capture_length] [repeats]
+#include "logger.hpp"
+#include "radar.hpp"
+#include "sample_source.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    int captureCount = argc > 1 ? std::atoi(argv[1]) : 50;
+    int captureLength = argc > 2 ? std::atoi(argv[2]) : DEFAULT_SAMPLE_COUNT;
+    int repeats = argc > 3 ? std::atoi(argv[3]) : 20;
+    
+    Logger::init();
+    Logger::setLogLevel(LogLevel::ERROR);
+    
+    // Club and ball returns with noise, a different shot for every capture
+    std::vector<std::vector<int>> captures(captureCount, std::vector<int>(captureLength));
+    for (int i = 0; i < captureCount; i++) {
+        SyntheticSignal signal;
+        signal.ballSpeedMPH = 60.0f + i % 100;
+        signal.clubSpeedMPH = signal.ballSpeedMPH / 1.45f;
+        signal.clubAmplitude = 150.0f;
+        signal.seed = i;
+        SyntheticSampleSource source(signal, DEFAULT_SAMPLE_FREQ);
+        source.read(captures[i].data(), captureLength);
+    }
+    
+    RadarManager& radar = RadarManager::getInstance();
+    radar.init();
+    
+    std::vector<float> speeds[2];
+    std::cout << captureCount << " captures of " << captureLength << " samples, "
+              << repeats << " repeats" << std::endl;
+    for (FftPrecision precision : {FftPrecision::Double, FftPrecision::Single}) {
+        radar.setFftPrecision(precision);
+        auto& results = speeds[precision == FftPrecision::Single];
+        
+        // Warm up: create the plan and window tables
+        radar.processSamples(captures[0], DEFAULT_SAMPLE_FREQ);
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; r++) {
+            for (const auto& capture : captures) {
+                float speed = radar.processSamples(capture, DEFAULT_SAMPLE_FREQ).speedMPH;
+                if (r == 0) {
+                    results.push_back(speed);
+                }
+            }
+        }
+        double micros = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count() / (repeats * captureCount);
+        
+        std::cout << (precision == FftPrecision::Double ? "double" : "single") << ": "
+                  << std::fixed << std::setprecision(1) << micros << " us per capture" << std::endl;
+    }
+    
+    float maxDifference = 0.0f;
+    for (int i = 0; i < captureCount; i++) {
+        maxDifference = std::max(maxDifference, std::abs(speeds[0][i] - speeds[1][i]));
+    }
+    std::cout << "Largest speed difference between precisions: " << std::setprecision(3)
+              << maxDifference << " mph" << std::endl;
+    
+    radar.cleanup();
+    return 0;
+}
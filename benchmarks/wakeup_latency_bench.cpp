@@ -0,0 +1,80 @@
+// Measures how late a thread wakes up from sleep_until, the way the radar
+// acquisition thread waits for its next SPI batch. Run it with and without
+// real-time settings on a loaded system to compare the latency distribution:
+//
+//   wakeup_latency_bench [iterations] [period_us] [--realtime] [--cpu N]
+#include "realtime.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    int iterations = 10000;
+    int periodMicros = 1000;
+    RealtimeConfig config;
+
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--realtime") {
+            config.enabled = true;
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            config.enabled = true;
+            config.cpu = std::atoi(argv[++i]);
+        } else if (positional == 0) {
+            iterations = std::atoi(argv[i]);
+            positional++;
+        } else {
+            periodMicros = std::atoi(argv[i]);
+        }
+    }
+    // atoi gives 0 for anything that isn't a number
+    if (iterations < 1 || periodMicros < 1) {
+        std::cerr << "usage: " << argv[0] << " [iterations] [period_us] [--realtime] [--cpu N]" << std::endl
+                  << "  iterations and period_us must be positive integers" << std::endl;
+        return 1;
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve(iterations);
+    RealtimeReport report;
+
+    std::thread worker([&] {
+        RealtimeController controller;
+        report = controller.apply(config);
+
+        auto period = std::chrono::microseconds(periodMicros);
+        auto deadline = std::chrono::steady_clock::now() + period;
+        for (int i = 0; i < iterations; i++) {
+            std::this_thread::sleep_until(deadline);
+            auto late = std::chrono::steady_clock::now() - deadline;
+            latencies.push_back(std::chrono::duration<double, std::micro>(late).count());
+            deadline += period;
+        }
+    });
+    worker.join();
+
+    if (config.enabled) {
+        std::cout << "Real-time settings: " << report.summary() << std::endl;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        size_t index = static_cast<size_t>(p / 100.0 * (latencies.size() - 1));
+        return latencies[index];
+    };
+
+    std::cout << "Wakeup latency over " << iterations << " wakeups every "
+              << periodMicros << " us:" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (double p : {50.0, 90.0, 99.0, 99.9}) {
+        std::cout << "  p" << p << ": " << std::setw(8) << percentile(p) << " us" << std::endl;
+    }
+    std::cout << "  max:   " << std::setw(8) << latencies.back() << " us" << std::endl;
+    return 0;
+}
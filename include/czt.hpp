@@ -0,0 +1,73 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "fft_plan_cache.hpp"
+
+// Zoomed spectrum over the golf speed band, computed with the chirp-z transform
+struct ZoomConfig {
+    bool enabled = false;
+    float minSpeedMPH = 60.0f;   // Band the zoom covers; returns outside it are
+    float maxSpeedMPH = 200.0f;  // refined as usual
+    int points = 1024;           // Spectrum points across the band
+};
+
+// Chirp-z transform: `points` values of the DFT of a `size` sample capture,
+// evenly spaced from `firstBin` to `lastBin` (in bins of the size-point DFT,
+// fractions allowed). Computed with Bluestein's algorithm as a convolution of
+// two FFTs of the next power of two of at least size + points - 1, so fine
+// resolution over a narrow band costs far less than zero-padding the whole
+// spectrum to the same spacing. The chirps and the transformed filter are
+// computed once; transform() is safe to call from several threads at once.
+class ChirpZ {
+public:
+    // Throws std::invalid_argument for an empty band and std::runtime_error if
+    // the FFTs can't be planned
+    ChirpZ(FftPlanCache& plans, size_t size, double firstBin, double lastBin, size_t points, unsigned planFlags);
+
+    // Power of each point of the zoomed spectrum of `size` (windowed) samples
+    void powers(const double* samples, double* out) const;
+    void powers(const float* samples, double* out) const;
+
+    size_t size() const { return inputSize; }
+    size_t points() const { return outputPoints; }
+    // Position of point `k` in bins of the size-point DFT
+    double bin(double k) const { return startBin + k * step; }
+    // Spacing of the points in bins
+    double spacing() const { return step; }
+
+private:
+    template <typename Real>
+    void powersOf(const Real* samples, double* out) const;
+
+    size_t inputSize;
+    size_t outputPoints;
+    double startBin;
+    double step;
+    FftPlan* forward;
+    FftPlan* backward;
+    std::vector<std::complex<double>> chirp;   // Premultiplies the input
+    std::vector<std::complex<double>> filter;  // FFT of the conjugate chirp, scaled by 1 / length
+};
+
+// Transforms built on first use per (size, first bin, last bin, points) and
+// kept. Returned transforms stay valid until clear(), which must also be
+// called before the plan cache they came from is cleared.
+class ChirpZCache {
+public:
+    const ChirpZ& get(FftPlanCache& plans, size_t size, int firstBin, int lastBin, size_t points,
+                      unsigned planFlags);
+
+    size_t size() const;
+    void clear();
+
+private:
+    using Key = std::tuple<size_t, int, int, size_t>;
+    std::map<Key, std::unique_ptr<const ChirpZ>> transforms;
+    mutable std::mutex mutex;
+};
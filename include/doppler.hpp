@@ -0,0 +1,19 @@
+#pragma once
+
+// HB100 transmit frequency in Hz
+constexpr float HB100_FREQ_HZ = 10.525e9f;
+// Speed of light in m/s
+constexpr float SPEED_OF_LIGHT_MPS = 299792458.0f;
+// Meters per second to miles per hour
+constexpr float MPS_TO_MPH = 2.23694f;
+
+// Doppler shift seen by the radar for a target moving at speedMPS:
+// f_doppler = 2 * v * f_radar / c
+inline float dopplerFrequencyForSpeed(float speedMPS) {
+    return (2.0f * speedMPS * HB100_FREQ_HZ) / SPEED_OF_LIGHT_MPS;
+}
+
+// Speed in m/s of a target producing a Doppler shift of frequencyHz
+inline float speedForDopplerFrequency(float frequencyHz) {
+    return (SPEED_OF_LIGHT_MPS * frequencyHz) / (2.0f * HB100_FREQ_HZ);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "timing.hpp"
+
+// Band energy detector settings
+struct EnergyTriggerConfig {
+    float minSpeedMPH = 40.0f;   // Band watched for a return; the club's approach is in it too,
+    float maxSpeedMPH = 200.0f;  // raise minSpeedMPH above the club speed to trigger on the ball only
+    int windowSize = 64;         // Sliding DFT length in samples (6.4 ms at 10 kHz)
+    double thresholdRatio = 10.0;  // Band energy over the noise floor that fires (10 dB)
+    double noiseTimeMs = 200.0;    // Time constant of the noise floor estimate
+    double minNoiseRms = 0.5;      // Lowest noise floor, in ADC counts RMS, so a noise-free
+                                   // stream (clean or replayed) can't fire on rounding
+    double cooldownMs = 500.0;     // Quiet time after firing, like the IR trigger's
+};
+
+// A detected return
+struct EnergyTriggerEvent {
+    uint64_t sample;     // Index in the stream of the sample that crossed the threshold
+    SteadyTime time;     // Its acquisition timestamp, if samples were pushed with timestamps
+    double energyRatio;  // Band energy over the noise floor at that sample
+};
+
+// Triggers on radar returns in the golf speed band. A Hann windowed sliding
+// DFT over the bins of the band is updated with every sample (a complex
+// multiply per bin), so a return is detected at the exact sample its energy
+// crosses the threshold, typically within one window of its onset. The noise
+// floor is measured over the first few windows, during which nothing fires,
+// then adapts while nothing is in the band; it is never taken below
+// minNoiseRms. Works on any sample stream, live or replayed.
+class RadarEnergyTrigger {
+public:
+    RadarEnergyTrigger(double sampleRate, const EnergyTriggerConfig& config = EnergyTriggerConfig());
+
+    // Called for each detection, from the thread calling push()
+    void setCallback(std::function<void(const EnergyTriggerEvent&)> callback);
+
+    // Feed samples, with their timestamps unless `times` is null. Returns the
+    // number of detections.
+    size_t push(const int* samples, size_t count, const SteadyTime* times = nullptr);
+
+    // Forget the stream so far; the detector re-arms after a warm-up
+    void reset();
+
+    // Band energy of the latest window and the current noise floor
+    double bandEnergy() const { return energy; }
+    double noiseFloor() const { return floor; }
+
+    // Band edges in DFT bins of the window (inclusive)
+    int firstBin() const { return lowBin; }
+    int lastBin() const { return highBin; }
+
+private:
+    EnergyTriggerConfig settings;
+    int lowBin;
+    int highBin;
+    std::vector<std::complex<double>> rotations;  // e^(j 2 pi k / N) * damping per bin
+    double oldestWeight;                          // damping^N for the sample leaving the window
+    double dcAlpha;
+    double noiseAlpha;
+    uint64_t cooldownSamples;
+    uint64_t warmupSamples;
+    double minFloor;  // Band energy of minNoiseRms of white noise
+
+    std::vector<std::complex<double>> bins;
+    std::vector<double> window;  // Last windowSize DC-free samples
+    uint64_t pushed = 0;
+    uint64_t quietUntil = 0;     // No detection before this sample
+    double dc = 0.0;
+    double energy = 0.0;
+    double floor = 0.0;
+    std::function<void(const EnergyTriggerEvent&)> callback;
+};
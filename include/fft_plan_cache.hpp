@@ -0,0 +1,193 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+enum class FftDirection {
+    RealToComplex,  // size real inputs -> size / 2 + 1 complex outputs
+    ComplexToReal,  // size / 2 + 1 complex inputs -> size real outputs
+    Forward,        // size complex -> size complex
+    Backward        // size complex -> size complex, unnormalized
+};
+
+enum class FftPrecision {
+    Double,  // fftw_*
+    Single   // fftwf_*
+};
+
+// What computes the transforms. Builds without FFTW (HAVE_FFTW undefined)
+// only have the built-in kernels.
+enum class FftBackend {
+    Fftw,    // FFTW plans, any size
+    Static   // Kernels specialized on size (static_fft.hpp) for powers of two
+             // from STATIC_FFT_MIN_SIZE to STATIC_FFT_MAX_SIZE; other sizes
+             // use FFTW if the build has it
+};
+
+#ifdef HAVE_FFTW
+constexpr FftBackend DEFAULT_FFT_BACKEND = FftBackend::Fftw;
+#else
+constexpr FftBackend DEFAULT_FFT_BACKEND = FftBackend::Static;
+#endif
+
+// Sizes with a built-in kernel
+constexpr int STATIC_FFT_MIN_SIZE = 16;
+constexpr int STATIC_FFT_MAX_SIZE = 8192;
+
+// Whether the build can use a backend
+bool fftBackendAvailable(FftBackend backend);
+
+// Name used on the command line: "fftw" or "static"
+const char* fftBackendName(FftBackend backend);
+bool parseFftBackend(const std::string& name, FftBackend& backend);
+
+// FFTW planner flags under their own names, so code that doesn't need FFTW
+// doesn't need its header. Plans from the built-in kernels ignore them.
+constexpr unsigned FFT_PLAN_MEASURE = 0U;
+constexpr unsigned FFT_PLAN_PATIENT = 1U << 5;
+constexpr unsigned FFT_PLAN_ESTIMATE = 1U << 6;
+constexpr unsigned FFT_PLAN_WISDOM_ONLY = 1U << 21;
+
+// A complex value as the transforms store it, laid out like fftw_complex
+using FftComplex = double[2];
+using FftComplexF = float[2];
+
+// Everything that distinguishes one FFTW plan from another
+struct FftPlanKey {
+    int size;
+    FftDirection direction;
+    FftPrecision precision;
+    unsigned flags;  // FFTW planner flags, e.g. FFTW_MEASURE
+
+    bool operator<(const FftPlanKey& other) const {
+        return std::tie(size, direction, precision, flags) <
+               std::tie(other.size, other.direction, other.precision, other.flags);
+    }
+};
+
+// A transform together with the SIMD aligned arrays it was created for: an
+// FFTW plan, or one of the built-in kernels.
+// Using the plan's own arrays is not thread-safe; threads sharing a plan
+// should each run it on their own arrays with execute(input, output).
+class FftPlan {
+public:
+    ~FftPlan();
+
+    FftPlan(const FftPlan&) = delete;
+    FftPlan& operator=(const FftPlan&) = delete;
+
+    const FftPlanKey& key() const { return planKey; }
+    int size() const { return planKey.size; }
+
+    FftBackend backend() const { return planBackend; }
+
+    // Input and output arrays, e.g. input<double>() and output<FftComplex>()
+    // for a double precision real-to-complex plan
+    template <typename T> T* input() const { return static_cast<T*>(in); }
+    template <typename T> T* output() const { return static_cast<T*>(out); }
+
+    // Run the transform from input() to output()
+    void execute();
+
+    // Run the transform on other SIMD aligned arrays of the plan's size
+    // (e.g. from FftWorkspace). Safe to call from
+    // several threads at once. The arrays must not overlap.
+    void execute(void* input, void* output) const;
+
+private:
+    friend class FftPlanCache;
+    FftPlan(const FftPlanKey& key, FftBackend backend);
+
+    // A built-in kernel; takes the input and output arrays
+    using StaticKernel = void (*)(const void*, void*);
+
+    FftPlanKey planKey;
+    FftBackend planBackend;
+    void* in = nullptr;
+    void* out = nullptr;
+    void* plan = nullptr;  // fftw_plan or fftwf_plan depending on precision
+    StaticKernel kernel = nullptr;  // Instead of the plan for FftBackend::Static
+};
+
+// Plans created on first use and reused afterwards, for any transform size.
+// Creating plans is not thread-safe in FFTW, so all plan creation and
+// destruction in the process should go through one cache.
+class FftPlanCache {
+public:
+    explicit FftPlanCache(FftBackend backend = DEFAULT_FFT_BACKEND);
+    ~FftPlanCache();
+
+    FftPlanCache(const FftPlanCache&) = delete;
+    FftPlanCache& operator=(const FftPlanCache&) = delete;
+
+    // Get the plan for `key`, creating it and its arrays the first time.
+    // If the flags include FFTW_WISDOM_ONLY and there is no wisdom for the
+    // transform, an FFTW_ESTIMATE plan is created instead (and cached under
+    // `key`). Returns null if the backend can't do the transform. Plans stay
+    // valid until clear(), setBackend() or destruction.
+    FftPlan* get(const FftPlanKey& key);
+
+    // Backend of the plans created from now on. Changing it destroys every
+    // plan, like clear(). Returns false if the build doesn't have it.
+    bool setBackend(FftBackend backend);
+    FftBackend backend() const;
+
+    // Number of cached plans
+    size_t size() const;
+
+    // Destroy all plans and free their arrays
+    void clear();
+
+private:
+    std::map<FftPlanKey, std::unique_ptr<FftPlan>> plans;
+    FftBackend planBackend;
+    mutable std::mutex mutex;
+};
+
+// Input and output arrays for running shared plans with
+// FftPlan::execute(input, output). Each thread (or worker) owns one, so
+// concurrent transforms never share memory. Arrays are allocated the first
+// time a plan's size, direction and precision is seen and reused afterwards.
+class FftWorkspace {
+public:
+    FftWorkspace() = default;
+    ~FftWorkspace();
+
+    FftWorkspace(const FftWorkspace&) = delete;
+    FftWorkspace& operator=(const FftWorkspace&) = delete;
+
+    template <typename T> T* input(const FftPlan& plan) { return static_cast<T*>(arraysFor(plan).in); }
+    template <typename T> T* output(const FftPlan& plan) { return static_cast<T*>(arraysFor(plan).out); }
+
+private:
+    struct Arrays {
+        void* in = nullptr;
+        void* out = nullptr;
+        FftPrecision precision = FftPrecision::Double;
+    };
+    Arrays& arraysFor(const FftPlan& plan);
+
+    using Key = std::tuple<int, FftDirection, FftPrecision>;
+    std::map<Key, Arrays> arrays;
+};
+
+// FFTW wisdom: planner measurements saved to disk, so plans as good as
+// FFTW_MEASURE or FFTW_PATIENT ones can be recreated instantly at startup.
+// Double precision wisdom is kept in `path`, single precision in
+// `path` + ".float". Like plan creation, these must not run concurrently
+// with anything else that plans. Without FFTW in the build there is no
+// wisdom, and they all return false.
+
+// Load wisdom. Returns false if there was no double precision wisdom to load.
+bool importFftWisdom(const std::string& path);
+
+// Save all wisdom gathered so far
+bool exportFftWisdom(const std::string& path);
+
+// Plan real-to-complex transforms of each size in both precisions with
+// FFTW_PATIENT, adding them to the wisdom. Takes seconds to minutes.
+bool planFftWisdom(const std::vector<int>& sizes);
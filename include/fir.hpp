@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "window.hpp"
+
+// Band-pass filter and decimator applied to the continuous sample stream
+struct StreamFilterConfig {
+    bool enabled = false;
+    int decimation = 1;          // Keep one sample in this many; the ADC can be oversampled by as much
+    float minSpeedMPH = 10.0f;   // Pass band in speeds; below it go DC, mains hum and people walking
+    float maxSpeedMPH = 200.0f;  // Capped below the decimated Nyquist frequency
+};
+
+// Linear phase band-pass FIR from lowHz to highHz (low-pass when lowHz is
+// 0), designed with a Kaiser window and normalized to unit gain in the middle
+// of the pass band. Throws std::invalid_argument for an empty band.
+std::vector<float> designBandPass(size_t taps, double lowHz, double highHz, double sampleRate,
+                                  double kaiserBeta = DEFAULT_KAISER_BETA);
+
+// Streaming FIR filter that keeps one output in every `factor` inputs. Only
+// the kept outputs are computed, which is the saving of the polyphase form:
+// Taps / factor multiply-adds per input sample. The filter state carries over
+// between blocks, so a stream can be pushed in blocks of any size.
+template <size_t Taps>
+class FirDecimator {
+public:
+    FirDecimator(const std::vector<float>& coefficients, int factor) : decimation(factor) {
+        if (coefficients.size() != Taps || factor < 1) {
+            throw std::invalid_argument("FIR decimator needs " + std::to_string(Taps) +
+                                        " taps and a factor of at least 1, got " +
+                                        std::to_string(coefficients.size()) + " and " + std::to_string(factor));
+        }
+        // Reversed, so the dot product runs forward over the history oldest
+        // first. The padding taps are zero.
+        taps.fill(0.0f);
+        for (size_t i = 0; i < Taps; i++) {
+            taps[i] = coefficients[Taps - 1 - i];
+        }
+        reset();
+    }
+
+    // Push one sample; returns true with the filtered value in `out` when it
+    // is one that is kept
+    bool push(float sample, float& out) {
+        // Mirrored history: the last Taps samples are always contiguous at `head`
+        history[head] = sample;
+        history[head + Taps] = sample;
+        head = head + 1 == Taps ? 0 : head + 1;
+        if (++phase < decimation) {
+            return false;
+        }
+        phase = 0;
+        out = dot(history.data() + head);
+        return true;
+    }
+
+    // Filter a block; writes the kept outputs to `out`, which needs room for
+    // count / factor + 1 values. Returns the number written.
+    template <typename Sample>
+    size_t process(const Sample* samples, size_t count, float* out) {
+        size_t written = 0;
+        for (size_t i = 0; i < count; i++) {
+            written += push(static_cast<float>(samples[i]), out[written]);
+        }
+        return written;
+    }
+
+    // Forget the stream: the history is zeroed and the next kept output is
+    // the `factor`-th sample pushed
+    void reset() {
+        history.fill(0.0f);
+        head = 0;
+        phase = 0;
+    }
+
+    int factor() const { return decimation; }
+
+    // Delay of the filter in input samples
+    static constexpr double groupDelay() { return (Taps - 1) / 2.0; }
+
+private:
+    // Independent partial sums, so the compiler can vectorize the dot
+    // product without reassociating a single float sum
+    static constexpr size_t LANES = 8;
+    static constexpr size_t PADDED = (Taps + LANES - 1) / LANES * LANES;
+
+    float dot(const float* __restrict window) const {
+        float sums[LANES] = {};
+        for (size_t i = 0; i < PADDED; i += LANES) {
+            for (size_t lane = 0; lane < LANES; lane++) {
+                sums[lane] += taps[i + lane] * window[i + lane];
+            }
+        }
+        float total = 0.0f;
+        for (float sum : sums) {
+            total += sum;
+        }
+        return total;
+    }
+
+    int decimation;
+    alignas(32) std::array<float, PADDED> taps;
+    // Two copies of the history plus room for the padding taps to read past it
+    alignas(32) std::array<float, 2 * Taps + LANES> history;
+    size_t head = 0;
+    int phase = 0;
+};
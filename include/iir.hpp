@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// DC removal applied to every sample as it is acquired
+struct DcBlockerConfig {
+    bool enabled = false;
+    float cutoffHz = 5.0f;      // Corner of the one-pole DC blocker (0.16 mph)
+    int highPassSections = 0;   // Biquad sections of a Butterworth high-pass after it, 0 for none
+    float highPassHz = 100.0f;  // Its corner (3.2 mph), to take out people walking and fans
+};
+
+// One-pole DC blocker: y[n] = x[n] - x[n-1] + pole * y[n-1], a zero at DC
+// and a pole just inside it. Follows a drifting offset, which a mean over
+// the capture can't. The first sample pushed primes it, so the output starts
+// at 0 instead of ringing down from the raw offset.
+class DcBlocker {
+public:
+    // Throws std::invalid_argument unless 0 < cutoffHz < sampleRate / 2
+    DcBlocker(double cutoffHz, double sampleRate);
+
+    float push(float sample) {
+        if (!primed) {
+            previousIn = sample;
+            primed = true;
+        }
+        double out = sample - previousIn + pole * previousOut;
+        previousIn = sample;
+        previousOut = out;
+        return static_cast<float>(out);
+    }
+
+    void reset();
+
+    double poleRadius() const { return pole; }
+
+private:
+    double pole;
+    double previousIn = 0.0;
+    double previousOut = 0.0;
+    bool primed = false;
+};
+
+// Normalized biquad: y = b0 x + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+struct BiquadCoefficients {
+    double b0, b1, b2;
+    double a1, a2;
+};
+
+// Second-order high-pass section (bilinear transform, corner prewarped).
+// Throws std::invalid_argument unless 0 < cutoffHz < sampleRate / 2 and q > 0.
+BiquadCoefficients designHighPass(double cutoffHz, double sampleRate, double q = 0.7071067811865476);
+
+// Butterworth high-pass of order 2 * sections as a cascade of sections
+std::vector<BiquadCoefficients> designButterworthHighPass(int sections, double cutoffHz, double sampleRate);
+
+// Biquad sections run one after the other, in transposed direct form II with
+// double state so the low corner stays stable
+class BiquadCascade {
+public:
+    explicit BiquadCascade(std::vector<BiquadCoefficients> sections);
+
+    float push(float sample) {
+        double value = sample;
+        for (size_t i = 0; i < coefficients.size(); i++) {
+            const BiquadCoefficients& c = coefficients[i];
+            double out = c.b0 * value + state[i][0];
+            state[i][0] = c.b1 * value - c.a1 * out + state[i][1];
+            state[i][1] = c.b2 * value - c.a2 * out;
+            value = out;
+        }
+        return static_cast<float>(value);
+    }
+
+    void reset();
+
+    size_t sections() const { return coefficients.size(); }
+
+private:
+    std::vector<BiquadCoefficients> coefficients;
+    std::vector<std::array<double, 2>> state;
+};
+
+// The DC blocker followed by the optional high-pass, as configured
+class DcFilter {
+public:
+    // Throws std::invalid_argument for an invalid corner frequency
+    DcFilter(const DcBlockerConfig& config, double sampleRate);
+
+    float push(float sample) {
+        float value = blocker.push(sample);
+        return highPass.sections() > 0 ? highPass.push(value) : value;
+    }
+
+    // Filter a block of ADC samples into 16-bit ones, rounded and clamped
+    void process(const int* samples, size_t count, int16_t* out);
+
+    void reset();
+
+private:
+    DcBlocker blocker;
+    BiquadCascade highPass;
+};
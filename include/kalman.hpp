@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "stft.hpp"
+
+// Kalman filter over the ball's speed in the STFT frames of a capture
+struct SpeedKalmanConfig {
+    bool enabled = false;
+    float measurementNoiseMPH = 0.5f;     // One-sigma error of a frame's peak speed
+    float decelerationSigma = 100.0f;     // Prior one-sigma deceleration in mph/s; drag slows a
+                                          // driven ball by about 60-100 mph/s
+    float decelerationNoise = 200.0f;     // Random walk of the deceleration in mph/s per sqrt(s)
+    float gateSigmas = 4.0f;              // Peaks further than this from the prediction aren't the ball
+    float seedTolerance = 0.05f;          // Fraction of the ball speed the last ball frame is found within
+    size_t minFrames = 3;                 // Frames needed for an estimate
+};
+
+// Constant-deceleration Kalman filter. The state is the speed (mph) and its
+// rate of change (mph/s) at a time in seconds, which can be moved forward or
+// backward; the deceleration may drift as a random walk.
+class SpeedKalmanFilter {
+public:
+    explicit SpeedKalmanFilter(const SpeedKalmanConfig& config = SpeedKalmanConfig());
+
+    // Start from a measured speed with the prior deceleration uncertainty
+    void start(double time, double speedMPH);
+
+    // Move the state to `time`, earlier or later than the current one
+    void predict(double time);
+
+    // Fuse a measured speed at the current time. Returns false, leaving the
+    // state alone, if it is outside the gate.
+    bool update(double speedMPH);
+
+    // One-sigma spread of the next measurement around speed()
+    double innovationSigma() const;
+
+    bool started() const { return running; }
+    double time() const { return now; }
+    double speed() const { return state[0]; }
+    double deceleration() const { return -state[1]; }
+    double speedSigma() const;
+
+private:
+    SpeedKalmanConfig settings;
+    bool running = false;
+    double now = 0.0;
+    double state[2] = {0.0, 0.0};                    // Speed, acceleration
+    double covariance[2][2] = {{0.0, 0.0}, {0.0, 0.0}};
+};
+
+// Ball speed extrapolated to impact
+struct LaunchSpeed {
+    float speedMPH = 0.0f;             // 0 when too few frames could be fused
+    float uncertaintyMPH = 0.0f;       // One-sigma
+    float decelerationMPHPerS = 0.0f;
+    size_t frames = 0;                 // Frames fused
+};
+
+// Speed of the ball at `impactSample` (a fractional sample index of the
+// capture the frames were computed from). The frames are filtered from the
+// last to the first, so the state ends up at the earliest ball frame with
+// every later frame behind it, and is then extrapolated the rest of the way
+// back. `ballSpeedMPH` picks out the ball among the peaks of the last frames;
+// each earlier frame contributes its peak closest to the prediction. Frames
+// whose middle is before the impact are skipped.
+LaunchSpeed estimateLaunchSpeed(const std::vector<StftFrame>& frames, double sampleRate, int frameSize,
+                                float ballSpeedMPH, double impactSample,
+                                const SpeedKalmanConfig& config = SpeedKalmanConfig());
@@ -2,20 +2,68 @@
 
 #include <vector>
 #include <functional>
+#include <string>
 #include <chrono>
 #include <mutex>
+#include <shared_mutex>
 #include <atomic>
-
-// Forward declare FFTW types to avoid including the header in the .hpp file
-typedef struct fftw_plan_s *fftw_plan;
-typedef double fftw_complex[2];
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <condition_variable>
+#include "sample_history.hpp"
+#include "spsc_ring.hpp"
+#include "sample_source.hpp"
+#include "doppler.hpp"
+#include "realtime.hpp"
+#include "window.hpp"
+#include "fft_plan_cache.hpp"
+#include "spectrum.hpp"
+#include "stft.hpp"
+#include "shot_tracker.hpp"
+#include "energy_trigger.hpp"
+#include "fir.hpp"
+#include "czt.hpp"
+#include "kalman.hpp"
+#include "iir.hpp"
 
 // Default ADC channel for HB100 radar
 constexpr int RADAR_ADC_CHANNEL = 0;
-// Default number of samples for FFT
+// Default number of samples for FFT. Captures of any other length work too,
+// their plans are created on first use.
 constexpr int DEFAULT_SAMPLE_COUNT = 1024;
+// Capture lengths planned by planWisdom()
+constexpr int WISDOM_FFT_SIZES[] = {256, 512, 1024, 2048, 4096};
+// FFTW wisdom file loaded by init(), relative to the working directory
+constexpr const char* DEFAULT_WISDOM_FILE = "fftw.wisdom";
+// Zero padding used by PeakEstimator::ZeroPadded
+constexpr int DEFAULT_ZERO_PAD_FACTOR = 4;
+// Shortest capture processSamples() will measure
+constexpr size_t MIN_SAMPLE_COUNT = 16;
 // Default sampling frequency in Hz
 constexpr int DEFAULT_SAMPLE_FREQ = 10000;
+// Size of the continuous acquisition history (~3.3 s at the default rate)
+constexpr size_t DEFAULT_HISTORY_SAMPLES = 32768;
+// Number of samples read from the ADC per acquisition block
+constexpr int ACQUISITION_BLOCK_SIZE = 64;
+// Samples taken from before the trigger when measuring from the history
+constexpr int DEFAULT_PRE_TRIGGER_SAMPLES = 256;
+// Capacity of the queue handing acquired samples to the processing thread (~0.8 s at the default rate)
+constexpr size_t DEFAULT_STREAM_QUEUE_SAMPLES = 8192;
+// Resample captures whose RMS interval jitter exceeds this fraction of the sample period
+constexpr double DEFAULT_JITTER_THRESHOLD = 0.02;
+// Weight of each idle capture in the running noise floor (~1 s time constant
+// at the default rate)
+constexpr double NOISE_FLOOR_DECAY = 0.1;
+// Length of the stream band-pass filter (~13 ms at the default rate)
+constexpr size_t STREAM_FILTER_TAPS = 127;
+
+// An acquired sample on its way from the acquisition thread to the processing thread
+struct TimedSample {
+    SteadyTime time;
+    int16_t value;
+};
 
 // Structure to hold radar measurement results
 struct RadarMeasurement {
@@ -23,6 +71,29 @@ struct RadarMeasurement {
     float speedMPH;        // Speed in miles per hour
     float signalStrength;  // Signal strength (arbitrary units)
     std::chrono::time_point<std::chrono::steady_clock> timestamp;
+    SampleTiming timing;   // Measured sample rate and jitter of the capture
+    float dopplerFrequency = 0.0f;      // Refined frequency of the dominant peak in Hz
+    float frequencyUncertainty = 0.0f;  // Approximate one-sigma error of dopplerFrequency in Hz
+    float speedUncertaintyMPH = 0.0f;   // The same error as a speed
+    // Club and ball returns separated over short-time FFT frames of the
+    // capture; 0 when that return wasn't found
+    float clubSpeedMPH = 0.0f;
+    float ballSpeedMPH = 0.0f;
+    float smashFactor = 0.0f;           // Ball speed over club speed
+    // False when no bin stood out of its surroundings (CFAR). The speed is
+    // then that of the strongest bin, and measurements are not delivered.
+    bool detected = true;
+    // How far the return stands out of the noise. The noise floor is the
+    // running estimate from the idle stream while acquiring, otherwise that
+    // of the capture itself.
+    float noiseFloor = 0.0f;   // RMS noise in ADC counts
+    float snrDB = 0.0f;        // Return power over noise power per sample; independent of window and length
+    float confidence = 0.0f;   // Chance (0-1) that the peak is not noise
+    // Ball speed at impact from a Kalman filter over the ball's frames (see
+    // setSpeedKalman()); 0 when it is off or the ball wasn't tracked
+    float launchSpeedMPH = 0.0f;
+    float launchSpeedUncertaintyMPH = 0.0f;  // One-sigma
+    float ballDecelerationMPHPerS = 0.0f;
 };
 
 class RadarManager {
@@ -35,11 +106,105 @@ public:
     
     virtual void cleanup();
 
+    // Called with every measurement. Can't be changed while acquisition is running.
     void setMeasurementCallback(std::function<void(const RadarMeasurement&)> callback);
     
     // Start a measurement (can be called from trigger callback)
     void startMeasurement();
 
+    // Start a measurement around a trigger time. While continuous acquisition
+    // is running the processing thread assembles the capture from the sample
+    // stream, so it includes samples from before the trigger fired; otherwise
+    // this is the same as startMeasurement().
+    void startMeasurement(SteadyTime triggerTime);
+
+    // Continuous acquisition: an always-on thread streams ADC samples into a
+    // fixed-size ring buffer, and through a lock-free queue to a processing
+    // thread that runs the FFT for triggered shots
+    void startAcquisition(size_t historySamples = DEFAULT_HISTORY_SAMPLES,
+                          int sampleFreq = DEFAULT_SAMPLE_FREQ);
+    void stopAcquisition();
+    bool isAcquiring() const;
+
+    // Samples dropped because the processing thread fell behind
+    uint64_t getStreamOverruns() const;
+
+    // Speed tracking: while acquiring, the processing thread also runs a
+    // short-time FFT over the sample stream, giving the dominant speed every
+    // hop. Off by default; takes effect at the next startAcquisition().
+    void setSpeedTracking(bool enabled, const StftConfig& config = StftConfig());
+
+    // Speed track frames whose middle sample was taken at or after `since`,
+    // oldest first
+    std::vector<StftFrame> getSpeedTrack(SteadyTime since = SteadyTime()) const;
+
+    // Radar trigger: while acquiring, the processing thread runs a band energy
+    // detector over the sample stream and calls `callback` (on that thread)
+    // with the timestamp of the sample where a return was detected. Takes
+    // effect at the next startAcquisition(); a null callback disables it.
+    void setEnergyTrigger(std::function<void(SteadyTime)> callback,
+                          const EnergyTriggerConfig& config = EnergyTriggerConfig());
+
+    // Stream filter: while acquiring, the processing thread band-passes the
+    // sample stream to the golf speed range and decimates it before anything
+    // else sees it, so the ADC can be oversampled. Stream captures, speed
+    // tracking and the radar trigger then run at the decimated rate; the
+    // pre-trigger sample count stays in ADC samples. Off by default; takes
+    // effect at the next startAcquisition().
+    void setStreamFilter(const StreamFilterConfig& config);
+
+    // DC blocker: while acquiring, the acquisition thread removes the ADC's
+    // offset from every sample as it is read (and optionally high-passes
+    // them), so the history and the stream hold centered samples and stream
+    // captures are windowed without a pass for their mean. Off by default;
+    // takes effect at the next startAcquisition().
+    void setDcBlocker(const DcBlockerConfig& config);
+
+    // How club and ball are separated in each measurement. The frames come
+    // from the speed tracking StftConfig.
+    void setShotTrackerConfig(const ShotTrackerConfig& config);
+
+    // Launch speed: the ball's speed in each STFT frame of a measurement is
+    // fused by a constant-deceleration Kalman filter and extrapolated back to
+    // impact, which is the trigger time for stream captures and otherwise the
+    // first ball frame. Off by default.
+    void setSpeedKalman(const SpeedKalmanConfig& config);
+
+    // Get a view of the acquisition history spanning `before` ms before and
+    // `after` ms after the trigger, without copying. Waits up to `timeout` for
+    // the post-trigger samples to be acquired.
+    bool captureWindow(SteadyTime triggerTime, std::chrono::milliseconds before,
+                       std::chrono::milliseconds after, SampleWindow& window,
+                       std::chrono::milliseconds timeout = std::chrono::milliseconds(500));
+
+    // Number of pre-trigger samples in measurements taken from the history
+    void setPreTriggerSamples(int samples);
+
+    // Real-time settings applied to the acquisition thread when it starts
+    void setRealtimeConfig(const RealtimeConfig& config);
+
+    // What the acquisition thread could actually apply
+    RealtimeReport getRealtimeReport() const;
+
+    // Replace the controller that applies real-time settings (for testing)
+    void setRealtimeController(std::unique_ptr<RealtimeController> controller);
+
+    // Select where samples come from (MCP3008, file replay, synthetic...).
+    // Must be called before init() or while acquisition is stopped. Without a
+    // source, init() sets up the MCP3008 on the bcm2835 SPI bus.
+    void setSampleSource(std::unique_ptr<SampleSource> source);
+
+    // Sample rate of the current source
+    int getSampleRate() const;
+
+    // FFTW wisdom file loaded by init(). Plans for transforms that aren't in
+    // the wisdom fall back to FFTW_ESTIMATE, so startup never measures.
+    void setWisdomFile(const std::string& path);
+
+    // Plan every size in WISDOM_FFT_SIZES with FFTW_PATIENT and save the
+    // wisdom file. Slow; meant to be run once, offline.
+    bool planWisdom();
+
     // Start a debug measurement with synthetic data    
     void startDebugMeasurement();
     
@@ -47,31 +212,273 @@ public:
     virtual std::vector<int> readSamples(int numSamples = DEFAULT_SAMPLE_COUNT, 
                                         int sampleFreq = DEFAULT_SAMPLE_FREQ);
     
+    // Read samples along with the time each one was taken
+    std::vector<int> readSamples(int numSamples, int sampleFreq,
+                                 std::vector<SteadyTime>& timestamps);
+    
     // Process samples to extract velocity
     RadarMeasurement processSamples(const std::vector<int>& samples, 
                                    int sampleFreq = DEFAULT_SAMPLE_FREQ);
     
+    // Process timestamped samples. The measured sample rate is used to convert
+    // frequencies to speed, and the capture is resampled onto a uniform grid
+    // first if its jitter is above the threshold. `impactTime`, if set, is
+    // when the ball was struck (the trigger time), for the launch speed.
+    RadarMeasurement processSamples(const std::vector<int>& samples, int sampleFreq,
+                                   const std::vector<SteadyTime>& timestamps,
+                                   SteadyTime impactTime = SteadyTime());
+
+    // Process 16-bit samples where they are, e.g. in an acquisition buffer,
+    // without copying them into a vector first. They are centered and
+    // windowed in fixed point.
+    RadarMeasurement processSamples(SampleSpan samples, int sampleFreq = DEFAULT_SAMPLE_FREQ);
+
+    // Analyze many captures at once, e.g. to reprocess recordings after a
+    // change of settings. The captures are spread over a work-stealing pool
+    // of `threads` workers (one per core for 0) and analyzed concurrently
+    // like separate processSamples() calls. Results are in capture order; a
+    // capture that fails to process gives a measurement with detected false.
+    std::vector<RadarMeasurement> processBatch(const std::vector<std::vector<int>>& captures,
+                                               int sampleFreq = DEFAULT_SAMPLE_FREQ, size_t threads = 0);
+
+    // The same for every recording in a directory (see listCaptureFiles()),
+    // in file name order. Each worker loads its own file, so memory doesn't
+    // grow with the directory. `files`, if given, receives the paths.
+    std::vector<RadarMeasurement> processCaptureDirectory(const std::string& directory,
+                                                          std::vector<std::string>* files = nullptr,
+                                                          size_t threads = 0);
+
+    // Process a window of the acquisition history (see captureWindow()). A
+    // window that wraps around the end of the history is copied once to make
+    // it contiguous. As with any window, check it is still intact afterwards
+    // to know the result wasn't computed from overwritten samples.
+    RadarMeasurement processSamples(const SampleWindow& window, int sampleFreq = DEFAULT_SAMPLE_FREQ);
+    
+    // RMS jitter, as a fraction of the sample period, above which captures are resampled
+    void setJitterThreshold(double fraction);
+    
+    // Window applied to captures before the FFT (Hamming by default).
+    // `kaiserBeta` is only used by the Kaiser window.
+    void setWindow(WindowType type, double kaiserBeta = DEFAULT_KAISER_BETA);
+    WindowType getWindow() const;
+    
+    // What computes the FFTs: FFTW, or the built-in kernels specialized on
+    // size (the default when the build has no FFTW). Must be called while
+    // acquisition is stopped; drops every plan and the speed track. Returns
+    // false if the build doesn't have the backend.
+    bool setFftBackend(FftBackend backend);
+    FftBackend getFftBackend() const;
+
+    // Precision of the windowing, FFT and magnitude pass. Single precision
+    // halves the memory traffic and doubles the SIMD width; the 10-bit ADC
+    // data doesn't need more.
+    void setFftPrecision(FftPrecision precision);
+    FftPrecision getFftPrecision() const;
+    
+    // How the dominant peak is located between FFT bins (parabolic by default).
+    // `zeroPadFactor` is only used by PeakEstimator::ZeroPadded.
+    void setPeakEstimator(PeakEstimator estimator, int zeroPadFactor = DEFAULT_ZERO_PAD_FACTOR);
+    PeakEstimator getPeakEstimator() const;
+
+    // Detection applied to the spectrum before a peak is accepted (cell
+    // averaging CFAR by default); captures without a detection are dropped
+    void setCfar(const CfarConfig& config);
+    CfarConfig getCfar() const;
+
+    // Measurements with a lower SNR or confidence are marked not detected and
+    // dropped like those without a CFAR detection. Both accept everything by
+    // default.
+    void setMinimumQuality(double minSnrDB, double minConfidence = 0.0);
+
+    // RMS noise of the idle acquisition stream in ADC counts, 0 until
+    // measured and once acquisition stops
+    double getNoiseFloor() const;
+
+    // Zoom: a dominant peak inside the configured speed band is located on a
+    // chirp-z spectrum of just that band instead of by the peak estimator.
+    // Off by default.
+    void setZoom(const ZoomConfig& config);
+    ZoomConfig getZoom() const;
+    
 protected:
     RadarManager() = default;
-    virtual ~RadarManager() = default;
+    virtual ~RadarManager();
     
     RadarManager(const RadarManager&) = delete;
     RadarManager& operator=(const RadarManager&) = delete;
     
     float frequencyToSpeed(float frequency);
+
+    // Read samples from the sample source into dst, and their timestamps
+    // into timestamps unless it is null
+    virtual void readAdc(int* dst, int numSamples, int sampleFreq, SteadyTime* timestamps);
+
+    // Samples of a capture, as int or int16_t, wherever they are held.
+    // Centered captures have had their DC offset removed upstream.
+    template <typename Sample>
+    struct Capture {
+        const Sample* samples;
+        size_t count;
+        bool centered = false;
+        const Sample* data() const { return samples; }
+        size_t size() const { return count; }
+    };
+
+    // Spectral analysis of a capture taken at sampleRate. `impactSample` is
+    // the (fractional) index of the impact in the capture, negative if unknown.
+    template <typename Sample>
+    RadarMeasurement processCapture(Capture<Sample> samples, double sampleRate, double impactSample = -1.0);
+
+    // The part of processCapture() done in the precision of the plan (float or double)
+    template <typename Real, typename Sample>
+    RadarMeasurement analyzeCapture(Capture<Sample> samples, double sampleRate, FftPlan& plan);
+
+    // Current window coefficients for a capture length, in float or double.
+    // Call with fftw_mutex held.
+    template <typename Real>
+    const Real* windowTable(size_t size);
+
+    // Offset in bins of the true peak from bin `peak`, using the current
+    // estimator. `windowed` is the FFT input, `powers` its power spectrum.
+    // Call with fftw_mutex held.
+    template <typename Real, typename Sample>
+    double refinePeak(Capture<Sample> samples, double mean, const Real* windowed, const Real* powers, int peak);
+
+    // Offset in bins of the true peak from bin `peak`, taken from the zoomed
+    // spectrum of the capture, whose point spacing in bins goes to `spacing`.
+    // Returns false if zoom is off or the peak is outside its band. Call with
+    // fftw_mutex held.
+    template <typename Real>
+    bool zoomPeak(const Real* windowed, size_t size, double sampleRate, int peak, double& offset,
+                  double& spacing);
+
+    // Club speed, ball speed and smash factor from STFT frames of a capture,
+    // and the launch speed at `impactSample` if the Kalman filter is on.
+    // Call with fftw_mutex held.
+    template <typename Sample>
+    ShotSpeeds trackCaptureShot(Capture<Sample> samples, double sampleRate, double impactSample,
+                                LaunchSpeed& launch);
+
+    // Set up the bcm2835 SPI bus for the MCP3008
+    bool initSpi();
+
+    // Acquisition thread body
+    void acquisitionLoop();
+
+    // Processing thread body: consumes the sample stream and measures shots
+    void processingLoop();
+
+    // Noise variance per sample of a stretch of the stream. False if it has
+    // a return in it (a CFAR detection) or can't be measured.
+    bool measureStreamNoise(const std::vector<int>& samples, double& variance);
+
+    // Fold the noise of an idle stretch of the stream into the running floor.
+    // Processing thread only.
+    void updateNoiseFloor(double variance);
+
+    // Noise variance per sample of a capture, from the median of its
+    // spectrum. False if a bin passes CFAR detection.
+    template <typename Real>
+    bool captureNoiseVariance(const std::vector<int>& samples, FftPlan& plan, double& variance);
+
+    // processSamples() with timestamps, for a capture that may be centered
+    RadarMeasurement processTimedSamples(const std::vector<int>& samples, int sampleFreq,
+                                         const std::vector<SteadyTime>& timestamps, SteadyTime impactTime,
+                                         bool centered);
+
+    // Run measure(i) for i in [0, count) on a pool of `threads` workers
+    std::vector<RadarMeasurement> runBatch(size_t count, size_t threads,
+                                           const std::function<RadarMeasurement(size_t)>& measure);
+
+    // Deliver a finished capture from the processing thread
+    void measureCapture(const std::vector<int>& samples, const std::vector<SteadyTime>& timestamps,
+                        SteadyTime triggerTime);
+
+    // Wait for and get a window of preSamples + postSamples around the trigger
+    bool captureSamples(SteadyTime triggerTime, int preSamples, int postSamples,
+                        SampleWindow& window, std::chrono::milliseconds timeout);
     
     int adcChannel = RADAR_ADC_CHANNEL;
     std::function<void(const RadarMeasurement&)> measurementCallback;
     
     // Constants for Doppler radar calculations
-    const float RADAR_FREQ = 10.525e9;  // HB100 frequency in Hz
-    const float SPEED_OF_LIGHT = 299792458.0;  // in m/s
-    
-    // FFTW resources
-    static bool fftw_initialized;
-    static double* fftw_in;
-    static fftw_complex* fftw_out;
-    static fftw_plan fftw_plan_r2c;
-    std::mutex fftw_mutex;
+    const float RADAR_FREQ = HB100_FREQ_HZ;  // HB100 frequency in Hz
+    const float SPEED_OF_LIGHT = SPEED_OF_LIGHT_MPS;  // in m/s
+    
+    // FFT resources: one plan and set of buffers per capture length
+    bool fftw_initialized = false;
+    FftPlanCache fftPlans;
+    unsigned fftPlanFlags = 0;  // FFT_PLAN_* flags for new plans, set by init()
+    std::string wisdomFile = DEFAULT_WISDOM_FILE;
+    FftPrecision fftPrecision = FftPrecision::Double;
+    PeakEstimator peakEstimator = PeakEstimator::Parabolic;
+    int zeroPadFactor = DEFAULT_ZERO_PAD_FACTOR;
+    CfarConfig cfarConfig;
+    ZoomConfig zoomConfig;
+    double minSnrDB = -std::numeric_limits<double>::infinity();
+    double minConfidence = 0.0;
+    ChirpZCache zoomTransforms;
+    StftEnginePool captureStftEngines;  // For shot tracking on captures
+    // Guards the FFT settings and plans: held shared while analyzing a
+    // capture, exclusively to change settings or free the plans
+    mutable std::shared_mutex fftw_mutex;
+    
+    // Window tables, computed once per capture size
+    WindowCache windowCache;
+    WindowType windowType = WindowType::Hamming;
+    double kaiserBeta = DEFAULT_KAISER_BETA;
     std::atomic<bool> measurement_in_progress{false};
+
+    // Sample source resources
+    std::unique_ptr<SampleSource> sampleSource;
+    bool spiInitialized = false;
+    mutable std::mutex sourceMutex;
+
+    // Continuous acquisition resources
+    std::unique_ptr<SampleHistory> history;
+    std::thread acquisitionThread;
+    std::atomic<bool> acquiring{false};
+    int acquisitionFreq = DEFAULT_SAMPLE_FREQ;
+    int preTriggerSamples = DEFAULT_PRE_TRIGGER_SAMPLES;
+    double jitterThreshold = DEFAULT_JITTER_THRESHOLD;
+    RealtimeConfig realtimeConfig;
+    RealtimeReport realtimeReport;
+    std::unique_ptr<RealtimeController> realtimeController = std::make_unique<RealtimeController>();
+    mutable std::mutex realtimeMutex;
+    std::mutex historyMutex;
+    std::condition_variable historyUpdated;
+
+    // Acquisition -> processing pipeline
+    std::unique_ptr<SpscRing<TimedSample>> sampleStream;
+    std::thread processingThread;
+    std::atomic<uint64_t> streamOverruns{0};
+    // Trigger time (ns since the steady_clock epoch) waiting to be picked up
+    // by the processing thread, or NO_PENDING_TRIGGER
+    static constexpr int64_t NO_PENDING_TRIGGER = INT64_MIN;
+    std::atomic<int64_t> pendingTrigger{NO_PENDING_TRIGGER};
+    // Running noise variance per sample of the idle stream, 0 until measured
+    std::atomic<double> idleNoiseVariance{0.0};
+
+    // Stream filter, owned by the processing thread while acquiring
+    StreamFilterConfig streamFilterConfig;
+    std::unique_ptr<FirDecimator<STREAM_FILTER_TAPS>> streamFilter;
+    int streamFreq = DEFAULT_SAMPLE_FREQ;  // Rate of the samples coming out of the filter
+
+    // DC blocker, owned by the acquisition thread while acquiring
+    DcBlockerConfig dcBlockerConfig;
+    std::unique_ptr<DcFilter> dcFilter;
+    bool streamCentered = false;  // Stream captures have no DC offset to remove
+
+    // Radar trigger, owned by the processing thread while acquiring
+    std::function<void(SteadyTime)> energyTriggerCallback;
+    EnergyTriggerConfig energyTriggerConfig;
+    std::unique_ptr<RadarEnergyTrigger> energyTrigger;
+    
+    // Speed tracking, fed by the processing thread
+    bool speedTracking = false;
+    StftConfig stftConfig;
+    ShotTrackerConfig shotTrackerConfig;
+    SpeedKalmanConfig speedKalmanConfig;
+    std::unique_ptr<StftEngine> stftEngine;
+    mutable std::mutex stftMutex;
 };
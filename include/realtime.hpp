@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Real-time execution settings for a latency critical thread
+struct RealtimeConfig {
+    bool enabled = false;
+    int priority = 80;                      // SCHED_FIFO priority (1-99)
+    int cpu = -1;                           // Core to pin the thread to, -1 leaves affinity alone
+    bool lockMemory = true;                 // mlockall() current and future pages
+    size_t prefaultStackBytes = 256 * 1024; // Stack to touch up front so it never page faults
+};
+
+// What could actually be applied. Anything that failed is described in
+// `problems`; the thread keeps running with default settings for that part.
+struct RealtimeReport {
+    bool scheduling = false;
+    bool affinity = false;
+    bool memoryLocked = false;
+    std::vector<std::string> problems;
+
+    bool fullyApplied() const { return problems.empty(); }
+    std::string summary() const;
+};
+
+// Applies real-time settings to the calling thread. The system calls are
+// virtual so tests can simulate a process without the required privileges.
+class RealtimeController {
+public:
+    virtual ~RealtimeController() = default;
+
+    RealtimeReport apply(const RealtimeConfig& config);
+
+protected:
+    // Each returns 0 on success or an errno value
+    virtual int setFifoScheduling(int priority);
+    virtual int setCpuAffinity(int cpu);
+    virtual int lockAllMemory();
+
+    // Contents of /sys/devices/system/cpu/isolated, e.g. "2-3"
+    virtual std::string isolatedCpus();
+
+    void prefaultStack(size_t bytes);
+};
+
+// Check whether a cpu is in a kernel cpu list such as "1,3-5"
+bool cpuListContains(const std::string& list, int cpu);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "timing.hpp"
+
+// A contiguous run of samples inside the history buffer
+struct SampleSpan {
+    const int16_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Non-owning view of a window of samples held by a SampleHistory.
+// A window that wraps around the end of the ring is split into two spans;
+// `second` is empty otherwise.
+struct SampleWindow {
+    SampleSpan first;
+    SampleSpan second;
+    uint64_t startIndex = 0;  // Absolute index of the first sample in the stream
+    SteadyTime startTime;     // Timestamp of the first sample
+
+    size_t size() const { return first.size + second.size; }
+
+    int16_t operator[](size_t i) const {
+        return i < first.size ? first.data[i] : second.data[i - first.size];
+    }
+};
+
+// Fixed-size, lock-free history of the continuous ADC stream.
+// There is exactly one writer (the acquisition thread). Any number of readers
+// may take windows of the history without copying; since the writer never
+// waits, a reader has to check isIntact() after using a window to make sure
+// the samples were not overwritten in the meantime.
+class SampleHistory {
+public:
+    // Capacity is rounded up to the next power of two
+    explicit SampleHistory(size_t capacity);
+
+    // Append samples with one timestamp each. Writer thread only.
+    void write(const int16_t* samples, const SteadyTime* sampleTimes, size_t count);
+
+    // Total number of samples written since construction
+    uint64_t totalWritten() const;
+
+    // Absolute index of the oldest sample still held in the buffer
+    uint64_t oldestIndex() const;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Timestamp of the sample at the given absolute index
+    SteadyTime timeOfIndex(uint64_t index) const;
+
+    // Find the index of the first sample taken at or after `time`.
+    // Returns false if that sample is not (or no longer) in the buffer.
+    bool indexForTime(SteadyTime time, uint64_t& index) const;
+
+    // Get a view of `count` samples starting at absolute index `start`.
+    // Returns false if the range is not fully held in the buffer.
+    bool window(uint64_t start, size_t count, SampleWindow& out) const;
+
+    // Check that none of the window's samples have been overwritten yet
+    bool isIntact(const SampleWindow& window) const;
+
+private:
+    // Reserve slots for `count` samples and return the index of the first one
+    uint64_t beginWrite(size_t count);
+
+    size_t mask;
+    std::unique_ptr<int16_t[]> samples;
+    // Nanoseconds since the steady_clock epoch, one per sample
+    std::unique_ptr<std::atomic<int64_t>[]> timestamps;
+    std::atomic<uint64_t> writeIndex{0};
+    // End of the block currently being written, published before the samples
+    std::atomic<uint64_t> reserveIndex{0};
+};
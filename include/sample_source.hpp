@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "spi_transport.hpp"
+#include "timing.hpp"
+
+// Number of ADC conversions queued per SPI transfer
+constexpr int DEFAULT_SPI_BATCH_SIZE = 32;
+
+// A stream of 10-bit radar samples (0-1023, idle level around 512)
+class SampleSource {
+public:
+    virtual ~SampleSource() = default;
+
+    // Read up to `count` samples into dst and, unless timestamps is null, the
+    // time each sample was taken. Returns the number of samples read; fewer
+    // than `count` means the source is exhausted.
+    virtual size_t read(int* dst, size_t count, SteadyTime* timestamps) = 0;
+
+    size_t read(int* dst, size_t count) { return read(dst, count, nullptr); }
+
+    virtual int sampleRate() const = 0;
+
+    // Change the sample rate. Returns false for sources with a fixed rate,
+    // such as recordings.
+    virtual bool setSampleRate(int hz) { return hz == sampleRate(); }
+
+    // Human readable description for logging
+    virtual std::string describe() const = 0;
+};
+
+// Live samples from an MCP3008 ADC. Conversions are sent to the SPI transport
+// in batches that are paced against a fixed deadline schedule, so delays
+// don't accumulate into sample rate drift. A sample's timestamp is when the
+// transport started its conversion if the transport records that (bcm2835);
+// otherwise it is the measured start of the batch plus whole sample periods
+// (spidev), which can't show jitter inside a batch.
+class Mcp3008SampleSource : public SampleSource {
+public:
+    Mcp3008SampleSource(std::unique_ptr<SpiTransport> transport, int channel,
+                        int sampleRate, int batchSize = DEFAULT_SPI_BATCH_SIZE);
+
+    using SampleSource::read;
+    size_t read(int* dst, size_t count, SteadyTime* timestamps) override;
+    int sampleRate() const override { return rate; }
+    bool setSampleRate(int hz) override;
+    std::string describe() const override;
+
+    // Number of conversions queued per SPI transfer; 1 transfers every sample on its own
+    void setBatchSize(int size);
+
+private:
+    std::unique_ptr<SpiTransport> transport;
+    int channel;
+    int rate;
+    int batchSize;
+    std::vector<uint8_t> frames;
+    SteadyTime nextDeadline;  // When the next batch is due, across reads
+    bool scheduled = false;
+};
+
+// Replay of a recorded capture. Supports 16-bit or 8-bit PCM WAV files (the
+// first channel is used) and raw files of little-endian int16 ADC counts.
+// Replay is paced at `speed` times real time; a speed of 0 replays as fast
+// as the consumer reads. Timestamps follow the recording's nominal rate from
+// the start of replay, whatever the replay speed.
+class FileSampleSource : public SampleSource {
+public:
+    // rawSampleRate is only used for raw files; WAV files carry their own rate
+    FileSampleSource(const std::string& path, double speed = 1.0, bool loop = false,
+                     int rawSampleRate = 10000);
+
+    bool isOpen() const { return !samples.empty(); }
+    using SampleSource::read;
+    size_t read(int* dst, size_t count, SteadyTime* timestamps) override;
+    int sampleRate() const override { return rate; }
+    std::string describe() const override;
+
+    size_t totalSamples() const { return samples.size(); }
+
+private:
+    bool loadWav(const std::vector<uint8_t>& data);
+    void loadRaw(const std::vector<uint8_t>& data);
+
+    std::string path;
+    double speed;
+    bool loop;
+    int rate;
+    std::vector<int> samples;
+    size_t position = 0;
+    uint64_t delivered = 0;
+    std::chrono::steady_clock::time_point replayStart;
+};
+
+// Parameters of the synthetic radar signal
+struct SyntheticSignal {
+    float ballSpeedMPH = 85.0f;
+    float ballAmplitude = 400.0f;   // ADC counts
+    float clubSpeedMPH = 0.0f;
+    float clubAmplitude = 0.0f;     // ADC counts, 0 disables the club return
+    float noiseAmplitude = 10.0f;   // Standard deviation in ADC counts
+    // Time between simulated shots. 0 gives a steady ball tone without shots.
+    float shotIntervalMs = 0.0f;
+    float clubApproachMs = 40.0f;   // Club return ramps up before impact
+    float clubDecayMs = 10.0f;      // and decays after it
+    float ballDurationMs = 150.0f;  // Ball return lasts this long after impact
+    float ballDecelerationMPHPerS = 0.0f;  // Drag slowing the ball from ballSpeedMPH at impact
+    unsigned seed = 42;
+};
+
+// Parametric generator of club, ball and noise returns, timestamped at the
+// nominal rate like a replay
+class SyntheticSampleSource : public SampleSource {
+public:
+    // Paced at `speed` times real time; 0 generates as fast as the consumer reads
+    explicit SyntheticSampleSource(const SyntheticSignal& signal = SyntheticSignal(),
+                                   int sampleRate = 10000, double speed = 0.0);
+
+    using SampleSource::read;
+    size_t read(int* dst, size_t count, SteadyTime* timestamps) override;
+    int sampleRate() const override { return rate; }
+    bool setSampleRate(int hz) override;
+    std::string describe() const override;
+
+private:
+    SyntheticSignal signal;
+    int rate;
+    double speed;
+    uint64_t sampleIndex = 0;
+    std::mt19937 rng;
+    std::normal_distribution<float> noise{0.0f, 1.0f};
+    std::chrono::steady_clock::time_point start;
+};
+
+// Create a sample source from a spec string:
+//   mcp3008                             MCP3008 through the bcm2835 library
+//   spidev[:/dev/spidev0.0]             MCP3008 through the Linux spidev driver
+//   file:<path>[,speed=1][,loop=1][,rate=10000]
+//   synthetic[:ball=85,club=0,club_amplitude=150,noise=10,interval=0,decel=0,speed=1,seed=42]
+// Returns nullptr and logs an error for an invalid spec.
+std::unique_ptr<SampleSource> makeSampleSource(const std::string& spec, int adcChannel,
+                                               int sampleRate);
+
+// Write samples (ADC counts) to a 16-bit mono WAV file that FileSampleSource can replay
+bool writeWavFile(const std::string& path, const std::vector<int>& samples, int sampleRate);
+
+// Paths of the recordings FileSampleSource can load (.wav and .raw files)
+// in a directory, sorted by name. Empty, with an error logged, if the
+// directory can't be read.
+std::vector<std::string> listCaptureFiles(const std::string& directory);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "stft.hpp"
+
+// How club and ball returns are told apart in a speed track
+struct ShotTrackerConfig {
+    float speedTolerance = 0.03f;  // Frame-to-frame spread of the ball speed, as a fraction
+    size_t minBallFrames = 3;      // Frames the ball return has to persist for
+    size_t clubFrames = 4;         // Frames up to impact the club speed is taken from
+    float maxSmashFactor = 1.6f;   // Slower returns than ball / maxSmashFactor aren't the club
+};
+
+// Club and ball speed of one shot. Speeds are 0 when that return wasn't found.
+struct ShotSpeeds {
+    float clubSpeedMPH = 0.0f;
+    float ballSpeedMPH = 0.0f;
+    float smashFactor = 0.0f;   // Ball speed over club speed, 0 unless both were found
+    uint64_t impactSample = 0;  // First sample of the first frame containing the ball
+    size_t ballFrames = 0;      // Frames the ball was seen in
+};
+
+// Find the ball and the club in the peaks of consecutive STFT frames.
+//
+// The ball is the fastest return that holds a near constant speed for at
+// least minBallFrames frames; the first of those frames marks impact. The
+// club is slower and only matters up to impact, where it is at its fastest,
+// so its speed is the fastest club-like return in the clubFrames frames
+// ending at impact.
+ShotSpeeds trackShot(const std::vector<StftFrame>& frames, const ShotTrackerConfig& config = ShotTrackerConfig());
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Magnitude of each of `bins` complex values stored as interleaved
+// (real, imaginary) pairs, as FFTW outputs them
+void computeMagnitudes(const float* spectrum, size_t bins, float* magnitudes);
+void computeMagnitudes(const double* spectrum, size_t bins, double* magnitudes);
+
+// Squared magnitude (power) of each bin. No square root, so use this when
+// only the order of the bins matters and take roots of the few that are kept.
+void computePowers(const float* spectrum, size_t bins, float* powers);
+void computePowers(const double* spectrum, size_t bins, double* powers);
+
+// A spectrum bin and its power (or magnitude)
+template <typename Real>
+struct SpectralBin {
+    int index;
+    Real value;
+};
+
+// The K largest bins offered, in a fixed-size min-heap: a bin that doesn't
+// make the top K costs one comparison, one that does O(log K). Never allocates.
+template <typename Real, size_t K>
+class TopBins {
+public:
+    void offer(int index, Real value) {
+        if (count < K) {
+            heap[count++] = {index, value};
+            std::push_heap(heap.begin(), heap.begin() + count, larger);
+        } else if (value > heap[0].value) {
+            // Replace the smallest of the K
+            std::pop_heap(heap.begin(), heap.end(), larger);
+            heap[K - 1] = {index, value};
+            std::push_heap(heap.begin(), heap.end(), larger);
+        }
+    }
+
+    // Offer bins [first, last) of `values`
+    void scan(const Real* values, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            // Most bins fail this test, so check it before the call
+            if (count < K || values[i] > heap[0].value) {
+                offer(static_cast<int>(i), values[i]);
+            }
+        }
+    }
+
+    // Copy the bins to `out`, largest first (lowest index first among equal
+    // values). Returns how many there are, at most K.
+    size_t sorted(SpectralBin<Real>* out) const {
+        std::copy(heap.begin(), heap.begin() + count, out);
+        std::sort(out, out + count, [](const SpectralBin<Real>& a, const SpectralBin<Real>& b) {
+            return a.value > b.value || (a.value == b.value && a.index < b.index);
+        });
+        return count;
+    }
+
+    size_t size() const { return count; }
+    void clear() { count = 0; }
+
+private:
+    // Heap order: the smallest value, then the highest index, on top
+    static bool larger(const SpectralBin<Real>& a, const SpectralBin<Real>& b) {
+        return a.value > b.value || (a.value == b.value && a.index < b.index);
+    }
+
+    std::array<SpectralBin<Real>, K> heap;
+    size_t count = 0;
+};
+
+// How CFAR estimates the noise around a cell
+enum class CfarMethod {
+    CellAveraging,     // Mean of the training cells; O(bins) with running sums
+    OrderedStatistic   // A high-ranked training cell; ignores a few strong neighbours (club next to ball)
+};
+
+// Constant false alarm rate detection settings
+struct CfarConfig {
+    bool enabled = true;
+    CfarMethod method = CfarMethod::CellAveraging;
+    int guardCells = 2;             // Cells either side of the cell under test left out (its main lobe)
+    int trainingCells = 16;         // Cells either side the noise is estimated from
+    double falseAlarmRate = 1e-6;   // Chance of a noise-only bin being detected
+    double orderFraction = 0.75;    // Ordered statistic: rank of the training cell used, as a fraction
+};
+
+// Multiple of the noise estimate that gives config.falseAlarmRate when the
+// noise power in each bin is exponentially distributed
+double cfarScale(const CfarConfig& config);
+
+// Detection threshold for every bin of a power spectrum: a bin is a target
+// when its power exceeds its threshold. DC is never used for training. Near
+// the ends of the spectrum the training cells that exist are used.
+void cfarThresholds(const float* powers, size_t bins, const CfarConfig& config, float* thresholds);
+void cfarThresholds(const double* powers, size_t bins, const CfarConfig& config, double* thresholds);
+
+// How the position of a spectral peak is refined beyond whole FFT bins
+enum class PeakEstimator {
+    None,        // Center of the strongest bin
+    Parabolic,   // Parabola through the log magnitudes of the three bins around the peak
+    Jacobsen,    // Complex ratio of the three unwindowed DFT bins around the peak
+    Quinn,       // Quinn's second estimator, on the same three unwindowed bins
+    ZeroPadded   // Zero-padded FFT around the peak, then parabolic
+};
+
+// Name used on the command line, e.g. "quinn"
+std::string peakEstimatorName(PeakEstimator estimator);
+bool parsePeakEstimator(const std::string& name, PeakEstimator& estimator);
+
+// Offset of the true peak from the center bin, in bins (-0.5 to 0.5), from
+// the magnitudes of the bins below, at and above the peak
+double parabolicPeakOffset(double below, double peak, double above);
+
+// Offsets from the unwindowed DFT bins k - 1, k and k + 1 around the peak
+double jacobsenPeakOffset(const std::complex<double> bins[3]);
+double quinnPeakOffset(const std::complex<double> bins[3]);
+
+// DFT of `count` samples with `offset` subtracted, at bin `bin` (bin / count
+// cycles per sample), computed with the Goertzel recurrence
+std::complex<double> goertzel(const int* samples, size_t count, double offset, double bin);
+std::complex<double> goertzel(const int16_t* samples, size_t count, double offset, double bin);
+
+// Power of a peak of magnitude `peak` over the average noise power per bin,
+// with the noise taken from the median of the `bins` magnitudes (DC and the
+// last bin excluded)
+double peakToNoise(const float* magnitudes, size_t bins, double peak);
+double peakToNoise(const double* magnitudes, size_t bins, double peak);
+
+// The same from bin powers and the power of the peak
+double peakPowerToNoise(const float* powers, size_t bins, double peakPower);
+double peakPowerToNoise(const double* powers, size_t bins, double peakPower);
+
+// Average noise power per bin behind those ratios: the median bin power
+// (DC and the last bin excluded) over ln 2
+double noisePower(const float* powers, size_t bins);
+double noisePower(const double* powers, size_t bins);
+
+// Chance that no bin out of `bins` of noise alone reaches `peakToNoise`
+// times the average noise power, i.e. that a peak that strong is real
+double peakConfidence(double peakToNoise, size_t bins);
+
+// Approximate one-sigma error, in bins, of a peak position found with
+// `estimator`. `peakToNoise` is the power of the peak bin over the average
+// noise power per bin; noise and the estimator's own bias both count.
+double peakUncertaintyBins(PeakEstimator estimator, double peakToNoise, int zeroPadFactor = 1);
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "timing.hpp"
+
+// From <linux/spi/spidev.h>
+struct spi_ioc_transfer;
+
+// Bytes exchanged per MCP3008 conversion
+constexpr size_t MCP3008_FRAME_SIZE = 3;
+
+// Fill a frame with the MCP3008 single-ended read command for a channel
+void mcp3008EncodeRead(uint8_t* frame, int channel);
+
+// Extract the 10-bit conversion result from a received frame
+int mcp3008Decode(const uint8_t* frame);
+
+// Idle time in whole microseconds to leave after frame `index` of a transfer
+// so frames start framePeriod apart. A microsecond delay can't hold the exact
+// gap at most sample rates, so the rounding is carried from frame to frame
+// instead of repeated on every one.
+uint32_t spiFrameGapMicros(std::chrono::nanoseconds framePeriod, size_t frameSize, uint32_t clockHz,
+                           size_t index);
+
+// Abstraction over the SPI bus the ADC is attached to, so the sampling code
+// can run against a mock in tests
+class SpiTransport {
+public:
+    virtual ~SpiTransport() = default;
+
+    // Full-duplex transfer of `count` frames of `frameSize` bytes each, back to
+    // back. Received bytes replace the sent ones in `buffer`. Chip select is
+    // released between frames so every frame is a separate ADC conversion.
+    virtual bool transferFrames(uint8_t* buffer, size_t frameSize, size_t count) = 0;
+
+    // Set the time from the start of one frame to the start of the next
+    // within a transfer, used to pace conversions inside a batch
+    virtual void setFramePeriod(std::chrono::nanoseconds period) { (void)period; }
+
+    // When each of the first `count` frames of the last transfer started, for
+    // transports that time them. False when frames are only paced, not timed.
+    virtual bool frameTimes(SteadyTime* times, size_t count) const {
+        (void)times;
+        (void)count;
+        return false;
+    }
+};
+
+// Transport using the bcm2835 library. It has no way to queue several
+// chip-select cycles, so frames are sent with one call each. Every call starts
+// on a deadline a frame period after the last one, so the call's own overhead
+// doesn't stretch the period, and its start time is recorded. The library is
+// opened for the lifetime of the transport.
+class Bcm2835SpiTransport : public SpiTransport {
+public:
+    Bcm2835SpiTransport();
+    ~Bcm2835SpiTransport() override;
+
+    bool isOpen() const { return open; }
+    bool transferFrames(uint8_t* buffer, size_t frameSize, size_t count) override;
+    void setFramePeriod(std::chrono::nanoseconds period) override { framePeriod = period; }
+    bool frameTimes(SteadyTime* times, size_t count) const override;
+
+private:
+    bool open = false;
+    std::chrono::nanoseconds framePeriod{0};
+    // Start of each frame of the last transfer, sized for the largest one
+    std::vector<SteadyTime> startTimes;
+    size_t timedFrames = 0;
+};
+
+// Transport using the Linux spidev driver. A whole batch of frames is queued
+// in a single SPI_IOC_MESSAGE ioctl with chip select toggled between frames.
+class SpidevSpiTransport : public SpiTransport {
+public:
+    explicit SpidevSpiTransport(const std::string& device = "/dev/spidev0.0",
+                                uint32_t speedHz = 3600000);
+    ~SpidevSpiTransport() override;
+
+    bool isOpen() const { return fd >= 0; }
+    bool transferFrames(uint8_t* buffer, size_t frameSize, size_t count) override;
+    void setFramePeriod(std::chrono::nanoseconds period) override { framePeriod = period; }
+
+private:
+    int fd = -1;
+    uint32_t speedHz;
+    std::chrono::nanoseconds framePeriod{0};
+    // Reused ioctl descriptors, sized for the largest batch seen so far
+    std::vector<spi_ioc_transfer> transfers;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Assumed cache line size. The producer and consumer indices live on separate
+// lines so the two threads don't keep stealing the line from each other.
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Neither side ever blocks: push() stores as many items as fit and
+// pop() takes as many as are available. size() and empty() are wait-free and
+// may be called from any thread.
+template <typename T>
+class SpscRing {
+public:
+    // Capacity is rounded up to the next power of two
+    explicit SpscRing(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        mask = rounded - 1;
+        slots = std::make_unique<T[]>(rounded);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Append up to `count` items and return how many fit. Producer thread only.
+    size_t push(const T* items, size_t count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t space = capacity() - (h - cachedTail);
+        if (space < count) {
+            // Only look at the consumer's index when the cached one says we're short
+            cachedTail = tail.load(std::memory_order_acquire);
+            space = capacity() - (h - cachedTail);
+        }
+        count = std::min(count, space);
+        for (size_t i = 0; i < count; i++) {
+            slots[(h + i) & mask] = items[i];
+        }
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    bool push(const T& item) { return push(&item, 1) == 1; }
+
+    // Remove up to `count` items into `items` and return how many were taken.
+    // Consumer thread only.
+    size_t pop(T* items, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t available = cachedHead - t;
+        if (available < count) {
+            cachedHead = head.load(std::memory_order_acquire);
+            available = cachedHead - t;
+        }
+        count = std::min(count, available);
+        for (size_t i = 0; i < count; i++) {
+            items[i] = slots[(t + i) & mask];
+        }
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    bool pop(T& item) { return pop(&item, 1) == 1; }
+
+    // Number of items queued. Exact from the producer or consumer thread, a
+    // snapshot from anywhere else.
+    size_t size() const {
+        // Reading tail first guarantees head >= tail
+        size_t t = tail.load(std::memory_order_acquire);
+        size_t h = head.load(std::memory_order_acquire);
+        return std::min(h - t, capacity());
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    // Written by the producer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+
+    // Written by the consumer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+
+    // Read-only after construction
+    alignas(CACHE_LINE_SIZE) size_t mask;
+    std::unique_ptr<T[]> slots;
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// FFTs specialized at compile time on their size, for when FFTW isn't there
+// or isn't faster. The twiddle factors and the bit-reversal permutation are
+// constant tables built by the compiler, and every loop bound is a constant,
+// so each size compiles to its own straight-line radix-4 stages (plus one
+// radix-2 stage for odd powers of two). Complex values are interleaved
+// (re, im) pairs, the same layout as fftw_complex, and transforms are
+// unnormalized like FFTW's.
+namespace static_fft {
+
+constexpr double PI = 3.14159265358979323846;
+
+constexpr bool isPowerOfTwo(size_t n) {
+    return n >= 2 && (n & (n - 1)) == 0;
+}
+
+constexpr size_t log2(size_t n) {
+    size_t bits = 0;
+    while (n > 1) {
+        n >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+struct UnitRoot {
+    double cos;
+    double sin;
+};
+
+// cos and sin of 2 pi j / n in a constant expression. The angle is reduced
+// to within pi / 4 of the nearest quarter turn exactly, in integers, so the
+// series is good to an ulp or so for every j.
+constexpr UnitRoot unitRoot(size_t j, size_t n) {
+    j %= n;
+    size_t quarter = (4 * j + n / 2) / n;
+    double x = 2.0 * PI * (static_cast<double>(static_cast<long long>(4 * j) - static_cast<long long>(quarter * n)) /
+                           (4.0 * n));
+    double square = x * x;
+    double sine = x;
+    double cosine = 1.0;
+    double sineTerm = x;
+    double cosineTerm = 1.0;
+    for (int k = 1; k <= 9; k++) {
+        sineTerm *= -square / ((2.0 * k) * (2.0 * k + 1.0));
+        cosineTerm *= -square / ((2.0 * k - 1.0) * (2.0 * k));
+        sine += sineTerm;
+        cosine += cosineTerm;
+    }
+    switch (quarter % 4) {
+        case 0: return {cosine, sine};
+        case 1: return {-sine, cosine};
+        case 2: return {-cosine, -sine};
+        default: return {sine, -cosine};
+    }
+}
+
+// e^(-2 pi i j / N) for j < N, interleaved
+template <size_t N, typename Real>
+constexpr std::array<Real, 2 * N> makeTwiddles() {
+    std::array<Real, 2 * N> table{};
+    for (size_t j = 0; j < N; j++) {
+        UnitRoot root = unitRoot(j, N);
+        table[2 * j] = static_cast<Real>(root.cos);
+        table[2 * j + 1] = static_cast<Real>(-root.sin);
+    }
+    return table;
+}
+
+template <size_t N>
+constexpr std::array<uint32_t, N> makeBitReversal() {
+    std::array<uint32_t, N> table{};
+    constexpr size_t bits = log2(N);
+    for (size_t i = 0; i < N; i++) {
+        size_t reversed = 0;
+        for (size_t bit = 0; bit < bits; bit++) {
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        table[i] = static_cast<uint32_t>(reversed);
+    }
+    return table;
+}
+
+template <size_t N, typename Real>
+inline constexpr std::array<Real, 2 * N> TWIDDLES = makeTwiddles<N, Real>();
+
+template <size_t N>
+inline constexpr std::array<uint32_t, N> BIT_REVERSAL = makeBitReversal<N>();
+
+}  // namespace static_fft
+
+// Complex FFT of N points, N a power of two
+template <size_t N, typename Real>
+class StaticFft {
+    static_assert(static_fft::isPowerOfTwo(N), "StaticFft needs a power of two size");
+
+public:
+    static constexpr size_t SIZE = N;
+
+    // Transform N complex values from `in` to `out`, which must not overlap.
+    // Inverse transforms use e^(+2 pi i jk / N).
+    template <bool Inverse = false>
+    static void transform(const Real* __restrict in, Real* __restrict out) {
+        for (size_t i = 0; i < N; i++) {
+            size_t j = static_fft::BIT_REVERSAL<N>[i];
+            out[2 * j] = in[2 * i];
+            out[2 * j + 1] = in[2 * i + 1];
+        }
+        stages<Inverse>(out);
+    }
+
+    // The same in place
+    template <bool Inverse = false>
+    static void transformInPlace(Real* data) {
+        for (size_t i = 0; i < N; i++) {
+            size_t j = static_fft::BIT_REVERSAL<N>[i];
+            if (i < j) {
+                std::swap(data[2 * i], data[2 * j]);
+                std::swap(data[2 * i + 1], data[2 * j + 1]);
+            }
+        }
+        stages<Inverse>(data);
+    }
+
+private:
+    // Odd powers of two start with one radix-2 stage; the rest is radix-4
+    template <bool Inverse>
+    static void stages(Real* data) {
+        if constexpr (static_fft::log2(N) % 2 == 1) {
+            for (size_t i = 0; i < 2 * N; i += 4) {
+                Real re = data[i + 2];
+                Real im = data[i + 3];
+                data[i + 2] = data[i] - re;
+                data[i + 3] = data[i + 1] - im;
+                data[i] += re;
+                data[i + 1] += im;
+            }
+            radix4Stages<Inverse, 2>(data);
+        } else {
+            radix4Stages<Inverse, 1>(data);
+        }
+    }
+
+    template <bool Inverse, size_t L>
+    static void radix4Stages(Real* data) {
+        if constexpr (L < N) {
+            radix4<Inverse, L>(data);
+            radix4Stages<Inverse, 4 * L>(data);
+        }
+    }
+
+    // Combine four DFTs of L points into one of 4L. In bit-reversed order the
+    // quarters of each block hold the subsequences 0, 2, 1 and 3 mod 4.
+    template <bool Inverse, size_t L>
+    static void radix4(Real* __restrict data) {
+        constexpr size_t STRIDE = N / (4 * L);
+        constexpr Real SIGN = Inverse ? Real(-1) : Real(1);
+        const Real* twiddles = static_fft::TWIDDLES<N, Real>.data();
+        for (size_t block = 0; block < N; block += 4 * L) {
+            for (size_t k = 0; k < L; k++) {
+                Real* p0 = data + 2 * (block + k);
+                Real* p1 = p0 + 2 * L;
+                Real* p2 = p0 + 4 * L;
+                Real* p3 = p0 + 6 * L;
+                const Real* w1 = twiddles + 2 * (k * STRIDE);
+                const Real* w2 = twiddles + 2 * (2 * k * STRIDE);
+                const Real* w3 = twiddles + 2 * (3 * k * STRIDE);
+
+                // a_r = W^(rk) * x_r, with the twiddles conjugated for the inverse
+                Real a0re = p0[0], a0im = p0[1];
+                Real a1re = p2[0] * w1[0] - SIGN * p2[1] * w1[1];
+                Real a1im = p2[1] * w1[0] + SIGN * p2[0] * w1[1];
+                Real a2re = p1[0] * w2[0] - SIGN * p1[1] * w2[1];
+                Real a2im = p1[1] * w2[0] + SIGN * p1[0] * w2[1];
+                Real a3re = p3[0] * w3[0] - SIGN * p3[1] * w3[1];
+                Real a3im = p3[1] * w3[0] + SIGN * p3[0] * w3[1];
+
+                Real t0re = a0re + a2re, t0im = a0im + a2im;
+                Real t1re = a0re - a2re, t1im = a0im - a2im;
+                Real t2re = a1re + a3re, t2im = a1im + a3im;
+                // (a1 - a3) times -i, or +i for the inverse
+                Real t3re = SIGN * (a1im - a3im);
+                Real t3im = -SIGN * (a1re - a3re);
+
+                p0[0] = t0re + t2re;
+                p0[1] = t0im + t2im;
+                p1[0] = t1re + t3re;
+                p1[1] = t1im + t3im;
+                p2[0] = t0re - t2re;
+                p2[1] = t0im - t2im;
+                p3[0] = t1re - t3re;
+                p3[1] = t1im - t3im;
+            }
+        }
+    }
+};
+
+// Real FFT of N points through a complex FFT of N / 2: the even and odd
+// samples are packed as the real and imaginary parts, and the two half-size
+// spectra are separated again with the twiddles of N.
+template <size_t N, typename Real>
+class StaticRealFft {
+    static_assert(static_fft::isPowerOfTwo(N) && N >= 4, "StaticRealFft needs a power of two size of at least 4");
+    static constexpr size_t HALF = N / 2;
+
+public:
+    static constexpr size_t SIZE = N;
+
+    // N real samples to N / 2 + 1 complex bins
+    static void forward(const Real* __restrict in, Real* __restrict out) {
+        StaticFft<HALF, Real>::transform(in, out);
+
+        const Real* twiddles = static_fft::TWIDDLES<N, Real>.data();
+        Real re = out[0];
+        Real im = out[1];
+        out[0] = re + im;
+        out[1] = 0;
+        out[N] = re - im;
+        out[N + 1] = 0;
+        // Bins k and N / 2 - k come from the same pair of packed bins
+        for (size_t k = 1; k <= HALF / 2; k++) {
+            size_t m = HALF - k;
+            Real zkre = out[2 * k], zkim = out[2 * k + 1];
+            Real zmre = out[2 * m], zmim = out[2 * m + 1];
+            // Even part (Z[k] + conj Z[m]) / 2, odd part (Z[k] - conj Z[m]) / 2i
+            Real ere = (zkre + zmre) / 2, eim = (zkim - zmim) / 2;
+            Real ore = (zkim + zmim) / 2, oim = -(zkre - zmre) / 2;
+            Real wre = twiddles[2 * k], wim = twiddles[2 * k + 1];
+            Real wore = wre * ore - wim * oim;
+            Real woim = wre * oim + wim * ore;
+            // X[k] = E + W O, X[m] = conj(E - W O)
+            out[2 * k] = ere + wore;
+            out[2 * k + 1] = eim + woim;
+            out[2 * m] = ere - wore;
+            out[2 * m + 1] = -(eim - woim);
+        }
+    }
+
+    // N / 2 + 1 complex bins to N real samples, unnormalized (N times the
+    // samples the bins came from)
+    static void inverse(const Real* __restrict in, Real* __restrict out) {
+        const Real* twiddles = static_fft::TWIDDLES<N, Real>.data();
+        for (size_t k = 0; k < HALF; k++) {
+            size_t m = HALF - k;
+            Real xkre = in[2 * k], xkim = in[2 * k + 1];
+            Real xmre = in[2 * m], xmim = -in[2 * m + 1];  // conj X[m]
+            // Z[k] = (X[k] + conj X[m]) + i conj(W^k) (X[k] - conj X[m])
+            Real are = xkre + xmre, aim = xkim + xmim;
+            Real bre = xkre - xmre, bim = xkim - xmim;
+            Real wre = twiddles[2 * k], wim = -twiddles[2 * k + 1];
+            Real cre = wre * bre - wim * bim;
+            Real cim = wre * bim + wim * bre;
+            out[2 * k] = are - cim;
+            out[2 * k + 1] = aim + cre;
+        }
+        StaticFft<HALF, Real>::template transformInPlace<true>(out);
+    }
+};
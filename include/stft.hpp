@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "aligned_allocator.hpp"
+#include "fft_plan_cache.hpp"
+#include "timing.hpp"
+#include "window.hpp"
+
+// Short-time FFT settings. Consecutive frames overlap by frameSize - hopSize
+// samples; the default gives a new frame every 6.4 ms at 10 kHz.
+struct StftConfig {
+    int frameSize = 256;                    // Samples per FFT frame
+    int hopSize = 64;                       // Samples between the starts of consecutive frames
+    WindowType window = WindowType::Hann;
+    double kaiserBeta = DEFAULT_KAISER_BETA;
+    double minFrequency = 0.0;              // Peaks below this (Hz) are ignored, e.g. to skip slow movement
+    double minPeakToNoise = 20.0;           // Weakest local maximum listed in StftFrame::peaks (power ratio)
+    double minPeakRatio = 0.05;             // ...and its magnitude relative to the strongest, which
+                                            // keeps Hann sidelobes (-31 dB) out of the list
+    size_t maxTrackFrames = 512;            // Oldest frames are dropped beyond this
+};
+
+// Most local maxima kept per frame
+constexpr size_t MAX_STFT_PEAKS = 4;
+
+// A local maximum of a frame's spectrum
+struct StftPeak {
+    float frequency;  // Hz, interpolated between bins
+    float speedMPH;
+    float magnitude;
+};
+
+// The strongest spectral peak in one frame, and the other returns in it
+struct StftFrame {
+    uint64_t firstSample;  // Index of the frame's first sample in the stream
+    SteadyTime time;       // Time of the frame's middle sample, if samples were pushed with timestamps
+    float frequency;       // Peak frequency in Hz, interpolated between bins
+    float speedMPH;        // The same as a target speed
+    float magnitude;       // Magnitude of the peak bin
+    float peakToNoise;     // Peak power over the average noise power per bin
+
+    // Local maxima that pass the config's thresholds, strongest first (so
+    // peaks[0] is the peak above unless it was too weak). Separate targets,
+    // such as the club and the ball, show up as separate entries.
+    std::array<StftPeak, MAX_STFT_PEAKS> peaks;
+    size_t peakCount;
+};
+
+// Streaming spectrogram. Samples are pushed as they arrive and a windowed
+// FFT of the most recent frameSize samples is computed every hopSize
+// samples, so each sample is only copied once and each frame costs one
+// transform. The plan and window come from the shared caches; the engine
+// owns its sample history and FFT arrays, so several engines (or an engine
+// and the capture analysis) can run on different threads.
+class StftEngine {
+public:
+    // Throws std::invalid_argument for a bad config and std::runtime_error if
+    // the FFT can't be planned. `planFlags` are FFT_PLAN_* planner flags.
+    StftEngine(FftPlanCache& plans, WindowCache& windows, double sampleRate,
+               const StftConfig& config, unsigned planFlags);
+
+    StftEngine(const StftEngine&) = delete;
+    StftEngine& operator=(const StftEngine&) = delete;
+
+    // Append samples, with their timestamps unless `times` is null. Returns
+    // the number of frames computed.
+    size_t push(const int* samples, size_t count, const SteadyTime* times = nullptr);
+    size_t push(const int16_t* samples, size_t count, const SteadyTime* times = nullptr);
+
+    // Peak of each frame, oldest first
+    const std::deque<StftFrame>& track() const { return frames; }
+
+    // Magnitude spectrum of the latest frame (frameSize / 2 + 1 bins)
+    const AlignedVector<double>& spectrum() const { return magnitudes; }
+
+    // Forget all samples and frames
+    void reset();
+
+    const StftConfig& config() const { return settings; }
+    uint64_t samplesPushed() const { return pushed; }
+    double frameRate() const { return sampleRate / settings.hopSize; }
+    double binWidth() const { return sampleRate / settings.frameSize; }
+
+private:
+    template <typename Sample>
+    size_t pushAs(const Sample* samples, size_t count, const SteadyTime* times);
+    void computeFrame();
+
+    StftConfig settings;
+    double sampleRate;
+    FftPlan* plan;
+    FftWorkspace workspace;
+    const double* window;
+
+    // Each sample is stored twice, frameSize apart, so the latest frame is
+    // always contiguous
+    std::vector<int> history;
+    std::vector<SteadyTime> times;
+    uint64_t pushed = 0;
+    size_t untilFrame;  // Samples still needed before the next frame
+    size_t firstBin;
+
+    AlignedVector<double> magnitudes;
+    std::deque<StftFrame> frames;
+};
+
+// Engines kept for reuse, so analyzing a capture doesn't build one and
+// allocate its buffers every time. An engine is taken for one capture and
+// given back; engines for other settings are built when first needed. Like
+// ChirpZCache, clear() must be called before the plan cache they came from
+// is cleared.
+class StftEnginePool {
+public:
+    // An engine for these settings with nothing pushed. Throws like the
+    // StftEngine constructor.
+    std::unique_ptr<StftEngine> take(FftPlanCache& plans, WindowCache& windows, double sampleRate,
+                                     const StftConfig& config, unsigned planFlags);
+
+    // Hand back an engine from take(); it is reset for the next capture
+    void give(std::unique_ptr<StftEngine> engine, double sampleRate, unsigned planFlags);
+
+    // Number of engines waiting to be taken
+    size_t size() const;
+    void clear();
+
+private:
+    struct Idle {
+        double sampleRate;
+        unsigned planFlags;
+        std::unique_ptr<StftEngine> engine;
+    };
+    std::vector<Idle> idle;
+    mutable std::mutex mutex;
+};
+
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task queue. Tasks are
+// spread over the queues round-robin; a worker takes the newest task from
+// its own queue and, when that is empty, steals the oldest from another.
+// Workers that drew short tasks end up taking work from those that drew
+// long ones, so a batch of uneven jobs finishes together.
+class ThreadPool {
+public:
+    // `threads` workers, or one per core for 0
+    explicit ThreadPool(size_t threads = 0);
+
+    // Runs every task already submitted, then stops the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task. From inside a task it goes on that worker's own queue.
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished, then rethrow the first
+    // exception a task threw, if any. Must not be called from a task.
+    void wait();
+
+    // Run body(i) for i in [0, count) on the pool and wait for all of them
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    size_t size() const { return workers.size(); }
+
+    // Tasks a worker took from another's queue, since the pool started
+    uint64_t stolenTasks() const { return steals.load(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void run(size_t index);
+    bool take(size_t index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    // Counts of tasks queued but not taken, and submitted but not finished
+    std::mutex stateMutex;
+    std::condition_variable taskQueued;
+    std::condition_variable allFinished;
+    size_t queued = 0;
+    size_t unfinished = 0;
+    bool stopping = false;
+    std::exception_ptr firstError;
+
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<uint64_t> steals{0};
+};
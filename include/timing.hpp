@@ -0,0 +1,23 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+using SteadyTime = std::chrono::time_point<std::chrono::steady_clock>;
+
+// Measured timing of a capture, from its per-sample timestamps
+struct SampleTiming {
+    double effectiveRate = 0.0;     // Hz, 0 when no timestamps were available
+    double jitterRmsMicros = 0.0;   // RMS deviation of the sample interval from its mean
+    double jitterMaxMicros = 0.0;   // Largest deviation of the sample interval from its mean
+    bool resampled = false;         // Capture was resampled to a uniform grid
+};
+
+// Compute effective sample rate and interval jitter from sample timestamps
+SampleTiming analyzeSampleTiming(const std::vector<SteadyTime>& timestamps);
+
+// Resample a non-uniformly sampled capture onto a uniform grid with the same
+// number of samples spanning the same time range, using cubic Lagrange
+// interpolation over the four nearest samples
+void resampleUniform(const std::vector<int>& samples, const std::vector<SteadyTime>& timestamps,
+                     std::vector<int>& resampled);
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <string>
 #include <memory>
+#include <mutex>
 
 // Forward declarations for gpiod types. Allows us to use gpiod 
 // without including the full header.
@@ -12,6 +13,18 @@ struct gpiod_line;
 // Default pin for TCRT5000 sensor
 constexpr int IR_DIGITAL_PIN = 17;
 
+// Which detectors fire the trigger callback
+enum class TriggerMode {
+    Ir,      // TCRT5000 only
+    Radar,   // Radar energy detector only
+    Either,  // Whichever sees the shot first
+    Both     // Both within the coincidence window, timed by the radar
+};
+
+// Name used on the command line, e.g. "either"
+std::string triggerModeName(TriggerMode mode);
+bool parseTriggerMode(const std::string& name, TriggerMode& mode);
+
 // Follows the Singleton pattern to manage the trigger system
 class TriggerManager {
 public:
@@ -38,6 +51,15 @@ public:
     // For testing - manually trigger
     void simulateTrigger();
     
+    // Select the detectors that fire the callback (IR only by default)
+    void setTriggerMode(TriggerMode mode);
+    TriggerMode getTriggerMode() const;
+    
+    // Report a detection from the radar energy detector, timed at the sample
+    // that crossed its threshold. May be called from the radar processing
+    // thread; the callback then runs on that thread.
+    void radarTriggered(std::chrono::time_point<std::chrono::steady_clock> time);
+    
 protected:
     TriggerManager() = default;
     virtual ~TriggerManager() = default;
@@ -57,6 +79,20 @@ protected:
     TriggerState state = TriggerState::IDLE;
     std::function<void(std::chrono::time_point<std::chrono::steady_clock>)> triggerCallback;
     
+    // Detector fusion. The IR and radar paths run on different threads.
+    TriggerMode mode = TriggerMode::Ir;
+    std::chrono::milliseconds coincidenceWindow{100};
+    bool irPending = false;     // Both mode: a detection waiting for the other detector
+    bool radarPending = false;
+    std::chrono::time_point<std::chrono::steady_clock> irPendingTime;
+    std::chrono::time_point<std::chrono::steady_clock> radarPendingTime;
+    mutable std::mutex triggerMutex;
+    
+    // Enter TRIGGERED at `time` and return the callback to run once
+    // triggerMutex is released. Call with triggerMutex held.
+    std::function<void(std::chrono::time_point<std::chrono::steady_clock>)> fire(
+        std::chrono::time_point<std::chrono::steady_clock> time);
+    
     // Helper to read the digital pin
     virtual bool readDigitalPin();
 };
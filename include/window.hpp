@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "aligned_allocator.hpp"
+
+// Window functions applied to a capture before the FFT
+enum class WindowType {
+    Hamming,
+    Hann,
+    BlackmanHarris,  // 4-term, -92 dB sidelobes; keeps a weak return next to a strong one visible
+    Kaiser,          // Sidelobe level set by beta
+    FlatTop          // Accurate peak amplitude at the cost of a wide main lobe
+};
+
+// Kaiser beta giving sidelobes around -70 dB
+constexpr double DEFAULT_KAISER_BETA = 9.0;
+// Fraction bits of fixed-point window coefficients (Q15)
+constexpr int WINDOW_FRACTION_BITS = 15;
+
+// Symmetric window coefficients for a capture of `size` samples.
+// `kaiserBeta` is only used by the Kaiser window.
+std::vector<double> makeWindow(WindowType type, size_t size, double kaiserBeta = DEFAULT_KAISER_BETA);
+
+// Name used on the command line, e.g. "blackman-harris"
+std::string windowTypeName(WindowType type);
+bool parseWindowType(const std::string& name, WindowType& type);
+
+// Window tables computed once per (type, size, beta) and shared afterwards,
+// in double and single precision and in fixed point. Returned tables are never freed or changed
+// while the cache exists.
+class WindowCache {
+public:
+    const AlignedVector<double>& get(WindowType type, size_t size, double kaiserBeta = DEFAULT_KAISER_BETA);
+    const AlignedVector<float>& getSingle(WindowType type, size_t size, double kaiserBeta = DEFAULT_KAISER_BETA);
+    // Q15 coefficients; a coefficient of 1 is stored as 32767
+    const AlignedVector<int16_t>& getFixed(WindowType type, size_t size, double kaiserBeta = DEFAULT_KAISER_BETA);
+
+    size_t size() const;
+
+private:
+    struct Table {
+        AlignedVector<double> coefficients;
+        AlignedVector<float> singleCoefficients;
+        AlignedVector<int16_t> fixedCoefficients;
+    };
+    const Table& table(WindowType type, size_t size, double kaiserBeta);
+
+    using Key = std::tuple<WindowType, size_t, double>;
+    std::map<Key, std::unique_ptr<const Table>> tables;
+    mutable std::mutex mutex;
+};
+
+// Convert a capture to floating point, remove its DC offset and apply the
+// window in a single pass. Returns the DC offset that was removed.
+double windowSamples(const int* samples, size_t count, const double* window, double* out);
+float windowSamples(const int* samples, size_t count, const float* window, float* out);
+
+// Window a capture that is already centered, e.g. by the stream's DC
+// blocker, skipping the pass over it for the mean
+void applyWindow(const int* samples, size_t count, const double* window, double* out);
+void applyWindow(const int* samples, size_t count, const float* window, float* out);
+
+// The same from 16-bit samples with a Q15 window (WindowCache::getFixed()).
+// Centering and windowing are done in 32-bit integers, with 3 fraction bits
+// kept of the mean, and each sample is converted to floating point once on
+// the way out. Captures spanning 4096 counts or more (beyond a 12-bit ADC)
+// would overflow that and are windowed in floating point instead.
+double windowSamples(const int16_t* samples, size_t count, const int16_t* window, double* out);
+float windowSamples(const int16_t* samples, size_t count, const int16_t* window, float* out);
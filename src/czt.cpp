@@ -0,0 +1,133 @@
+#include "czt.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+size_t nextPowerOfTwo(size_t value) {
+    size_t power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+// e^(-j pi step n^2 / size): the n^2 / 2 chirp, with n^2 reduced so large
+// captures keep their phase accuracy
+std::complex<double> quadraticPhase(double step, size_t n, size_t size) {
+    double square = std::fmod(static_cast<double>(n) * n * step, 2.0 * size);
+    return std::polar(1.0, -M_PI * square / size);
+}
+}
+
+ChirpZ::ChirpZ(FftPlanCache& plans, size_t size, double firstBin, double lastBin, size_t points, unsigned planFlags)
+    : inputSize(size), outputPoints(points), startBin(firstBin) {
+    if (size < 2 || points < 2 || !(lastBin > firstBin)) {
+        throw std::invalid_argument("Invalid chirp-z transform of " + std::to_string(size) + " samples to " +
+                                    std::to_string(points) + " points from bin " + std::to_string(firstBin) +
+                                    " to " + std::to_string(lastBin));
+    }
+    step = (lastBin - firstBin) / (points - 1);
+
+    size_t length = nextPowerOfTwo(size + points - 1);
+    forward = plans.get({static_cast<int>(length), FftDirection::Forward, FftPrecision::Double, planFlags});
+    backward = plans.get({static_cast<int>(length), FftDirection::Backward, FftPrecision::Double, planFlags});
+    if (!forward || !backward) {
+        throw std::runtime_error("Could not plan " + std::to_string(length) + " point FFTs for the chirp-z transform");
+    }
+
+    // X[k] = sum x[n] e^(-j2pi n (first + k step) / size); with nk = (n^2 + k^2 - (k - n)^2) / 2
+    // this is a chirp times the convolution of the chirped input with the
+    // conjugate chirp. The output chirp has unit magnitude, so powers don't need it.
+    chirp.resize(size);
+    for (size_t n = 0; n < size; n++) {
+        chirp[n] = std::polar(1.0, -2.0 * M_PI * firstBin * n / size) * quadraticPhase(step, n, size);
+    }
+
+    std::vector<std::complex<double>> response(length);
+    for (size_t m = 0; m < std::max(size, points); m++) {
+        std::complex<double> value = std::conj(quadraticPhase(step, m, size));
+        if (m < points) {
+            response[m] = value;
+        }
+        if (m > 0 && m < size) {
+            response[length - m] = value;
+        }
+    }
+    filter.resize(length);
+    FftWorkspace workspace;
+    FftComplex* in = workspace.input<FftComplex>(*forward);
+    FftComplex* out = workspace.output<FftComplex>(*forward);
+    for (size_t i = 0; i < length; i++) {
+        in[i][0] = response[i].real();
+        in[i][1] = response[i].imag();
+    }
+    forward->execute(in, out);
+    for (size_t i = 0; i < length; i++) {
+        filter[i] = std::complex<double>(out[i][0], out[i][1]) / static_cast<double>(length);
+    }
+}
+
+template <typename Real>
+void ChirpZ::powersOf(const Real* samples, double* out) const {
+    // The plans are shared; the arrays belong to this thread
+    static thread_local FftWorkspace workspace;
+    FftComplex* in = workspace.input<FftComplex>(*forward);
+    FftComplex* spectrum = workspace.output<FftComplex>(*forward);
+    FftComplex* convolved = workspace.output<FftComplex>(*backward);
+    size_t length = filter.size();
+
+    for (size_t n = 0; n < inputSize; n++) {
+        in[n][0] = samples[n] * chirp[n].real();
+        in[n][1] = samples[n] * chirp[n].imag();
+    }
+    for (size_t n = inputSize; n < length; n++) {
+        in[n][0] = 0.0;
+        in[n][1] = 0.0;
+    }
+    forward->execute(in, spectrum);
+
+    // Multiply by the filter in place, then back to the time domain
+    for (size_t i = 0; i < length; i++) {
+        std::complex<double> product = std::complex<double>(spectrum[i][0], spectrum[i][1]) * filter[i];
+        spectrum[i][0] = product.real();
+        spectrum[i][1] = product.imag();
+    }
+    backward->execute(spectrum, convolved);
+    for (size_t k = 0; k < outputPoints; k++) {
+        out[k] = convolved[k][0] * convolved[k][0] + convolved[k][1] * convolved[k][1];
+    }
+}
+
+void ChirpZ::powers(const double* samples, double* out) const {
+    powersOf(samples, out);
+}
+
+void ChirpZ::powers(const float* samples, double* out) const {
+    powersOf(samples, out);
+}
+
+const ChirpZ& ChirpZCache::get(FftPlanCache& plans, size_t size, int firstBin, int lastBin, size_t points,
+                               unsigned planFlags) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = transforms[Key(size, firstBin, lastBin, points)];
+    if (!entry) {
+        try {
+            entry = std::make_unique<ChirpZ>(plans, size, firstBin, lastBin, points, planFlags);
+        } catch (...) {
+            transforms.erase(Key(size, firstBin, lastBin, points));
+            throw;
+        }
+    }
+    return *entry;
+}
+
+size_t ChirpZCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return transforms.size();
+}
+
+void ChirpZCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    transforms.clear();
+}
@@ -0,0 +1,114 @@
+#include "energy_trigger.hpp"
+#include "doppler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+// Pole radius of the sliding DFT, just inside the unit circle so rounding
+// errors die away instead of accumulating
+constexpr double DAMPING = 0.99999;
+}
+
+RadarEnergyTrigger::RadarEnergyTrigger(double sampleRate, const EnergyTriggerConfig& config)
+    : settings(config) {
+    int size = settings.windowSize;
+    if (size < 8 || sampleRate <= 0.0) {
+        throw std::invalid_argument("Invalid energy trigger window of " + std::to_string(size) + " samples");
+    }
+
+    double binWidth = sampleRate / size;
+    lowBin = std::max(1, static_cast<int>(std::ceil(dopplerFrequencyForSpeed(settings.minSpeedMPH / MPS_TO_MPH) / binWidth)));
+    highBin = std::min(size / 2 - 1,
+                       static_cast<int>(std::floor(dopplerFrequencyForSpeed(settings.maxSpeedMPH / MPS_TO_MPH) / binWidth)));
+    if (lowBin > highBin) {
+        throw std::invalid_argument("Energy trigger band " + std::to_string(settings.minSpeedMPH) + "-" +
+                                    std::to_string(settings.maxSpeedMPH) + " mph has no bins at " +
+                                    std::to_string(sampleRate) + " Hz");
+    }
+
+    // One bin either side of the band for the Hann window
+    for (int k = lowBin - 1; k <= highBin + 1; k++) {
+        rotations.push_back(std::polar(DAMPING, 2.0 * M_PI * k / size));
+    }
+    oldestWeight = std::pow(DAMPING, size);
+    dcAlpha = 1.0 / (16 * size);
+    noiseAlpha = 1.0 / std::max(1.0, settings.noiseTimeMs * sampleRate / 1000.0);
+    cooldownSamples = static_cast<uint64_t>(settings.cooldownMs * sampleRate / 1000.0);
+    warmupSamples = 4 * static_cast<uint64_t>(size);
+    // White noise puts N sigma^2 in each DFT bin, and the Hann weights
+    // (0.5, -0.25, -0.25) keep 0.375 of it
+    minFloor = 0.375 * size * settings.minNoiseRms * settings.minNoiseRms * (rotations.size() - 2);
+    bins.resize(rotations.size());
+    window.resize(size);
+    reset();
+}
+
+void RadarEnergyTrigger::setCallback(std::function<void(const EnergyTriggerEvent&)> newCallback) {
+    callback = std::move(newCallback);
+}
+
+void RadarEnergyTrigger::reset() {
+    std::fill(bins.begin(), bins.end(), std::complex<double>());
+    std::fill(window.begin(), window.end(), 0.0);
+    pushed = 0;
+    quietUntil = 0;
+    dc = 0.0;
+    energy = 0.0;
+    floor = 0.0;
+}
+
+size_t RadarEnergyTrigger::push(const int* samples, size_t count, const SteadyTime* times) {
+    size_t size = window.size();
+    size_t detections = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t index = pushed++;
+        if (index == 0) {
+            dc = samples[i];
+        }
+        dc += dcAlpha * (samples[i] - dc);
+        double value = samples[i] - dc;
+
+        // S_k(n) = x(n) + r e^(j2pik/N) S_k(n-1) - r^N x(n-N)
+        double& slot = window[index % size];
+        double leaving = oldestWeight * slot;
+        slot = value;
+        for (size_t k = 0; k < bins.size(); k++) {
+            bins[k] = rotations[k] * bins[k] + (value - leaving);
+        }
+
+        // Hann window applied in the frequency domain. Its sidelobes fall off
+        // fast enough that slow movement outside the band can't leak into it,
+        // which with the plain rectangular window it does at -13 dB.
+        energy = 0.0;
+        for (size_t k = 1; k + 1 < bins.size(); k++) {
+            energy += std::norm(0.5 * bins[k] - 0.25 * (bins[k - 1] + bins[k + 1]));
+        }
+
+        if (index < size) {
+            continue;
+        }
+        if (index < warmupSamples) {
+            // Average of every full window so far
+            floor += (energy - floor) / (index - size + 1);
+            continue;
+        }
+
+        double noise = std::max(floor, minFloor);
+        bool loud = energy > settings.thresholdRatio * noise;
+        if (loud && index >= quietUntil) {
+            EnergyTriggerEvent event{index, times ? times[i] : SteadyTime(), noise > 0.0 ? energy / noise : 0.0};
+            quietUntil = index + cooldownSamples;
+            detections++;
+            if (callback) {
+                callback(event);
+            }
+        }
+        // Only track the floor while the band is quiet
+        if (!loud) {
+            floor += noiseAlpha * (energy - floor);
+        }
+    }
+    return detections;
+}
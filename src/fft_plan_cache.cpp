@@ -0,0 +1,382 @@
+#include "fft_plan_cache.hpp"
+#include "aligned_allocator.hpp"
+#include "logger.hpp"
+#include "static_fft.hpp"
+#include <new>
+#include <string>
+
+#ifdef HAVE_FFTW
+#include <fftw3.h>
+
+static_assert(FFT_PLAN_MEASURE == FFTW_MEASURE && FFT_PLAN_PATIENT == FFTW_PATIENT &&
+                  FFT_PLAN_ESTIMATE == FFTW_ESTIMATE && FFT_PLAN_WISDOM_ONLY == FFTW_WISDOM_ONLY,
+              "FFT_PLAN_* flags must match FFTW's");
+static_assert(sizeof(FftComplex) == sizeof(fftw_complex) && sizeof(FftComplexF) == sizeof(fftwf_complex),
+              "FftComplex must be laid out like fftw_complex");
+#endif
+
+namespace {
+// Number of elements in the input and output arrays of a plan
+size_t inputCount(const FftPlanKey& key) {
+    return key.direction == FftDirection::ComplexToReal ? key.size / 2 + 1 : key.size;
+}
+
+size_t outputCount(const FftPlanKey& key) {
+    return key.direction == FftDirection::RealToComplex ? key.size / 2 + 1 : key.size;
+}
+
+bool realInput(const FftPlanKey& key) {
+    return key.direction == FftDirection::RealToComplex;
+}
+
+bool realOutput(const FftPlanKey& key) {
+    return key.direction == FftDirection::ComplexToReal;
+}
+
+template <typename Real>
+size_t bytes(size_t count, bool real) {
+    return count * sizeof(Real) * (real ? 1 : 2);
+}
+
+#ifdef HAVE_FFTW
+std::string singlePrecisionWisdomPath(const std::string& path) {
+    return path + ".float";
+}
+
+void* allocate(const FftPlanKey& key, size_t count, bool real) {
+    if (key.precision == FftPrecision::Double) {
+        return fftw_malloc(bytes<double>(count, real));
+    }
+    return fftwf_malloc(bytes<float>(count, real));
+}
+
+void release(FftPrecision precision, void* data) {
+    if (precision == FftPrecision::Double) {
+        fftw_free(data);
+    } else {
+        fftwf_free(data);
+    }
+}
+#else
+void* allocate(const FftPlanKey& key, size_t count, bool real) {
+    size_t size = key.precision == FftPrecision::Double ? bytes<double>(count, real) : bytes<float>(count, real);
+    return ::operator new(size, std::align_val_t(SIMD_ALIGNMENT), std::nothrow);
+}
+
+void release(FftPrecision, void* data) {
+    ::operator delete(data, std::align_val_t(SIMD_ALIGNMENT));
+}
+#endif
+
+using StaticKernel = void (*)(const void*, void*);
+
+template <size_t N, typename Real>
+StaticKernel staticKernel(FftDirection direction) {
+    switch (direction) {
+        case FftDirection::RealToComplex:
+            return [](const void* in, void* out) {
+                StaticRealFft<N, Real>::forward(static_cast<const Real*>(in), static_cast<Real*>(out));
+            };
+        case FftDirection::ComplexToReal:
+            return [](const void* in, void* out) {
+                StaticRealFft<N, Real>::inverse(static_cast<const Real*>(in), static_cast<Real*>(out));
+            };
+        case FftDirection::Forward:
+            return [](const void* in, void* out) {
+                StaticFft<N, Real>::transform(static_cast<const Real*>(in), static_cast<Real*>(out));
+            };
+        case FftDirection::Backward:
+            return [](const void* in, void* out) {
+                StaticFft<N, Real>::template transform<true>(static_cast<const Real*>(in), static_cast<Real*>(out));
+            };
+    }
+    return nullptr;
+}
+
+// The kernel compiled for `size`, or null if there isn't one
+template <typename Real, size_t N = STATIC_FFT_MIN_SIZE>
+StaticKernel findStaticKernel(int size, FftDirection direction) {
+    if constexpr (N <= STATIC_FFT_MAX_SIZE) {
+        if (static_cast<size_t>(size) == N) {
+            return staticKernel<N, Real>(direction);
+        }
+        return findStaticKernel<Real, 2 * N>(size, direction);
+    } else {
+        return nullptr;
+    }
+}
+}
+
+bool fftBackendAvailable(FftBackend backend) {
+#ifdef HAVE_FFTW
+    constexpr bool haveFftw = true;
+#else
+    constexpr bool haveFftw = false;
+#endif
+    return backend == FftBackend::Static || haveFftw;
+}
+
+const char* fftBackendName(FftBackend backend) {
+    return backend == FftBackend::Fftw ? "fftw" : "static";
+}
+
+bool parseFftBackend(const std::string& name, FftBackend& backend) {
+    if (name == "fftw") {
+        backend = FftBackend::Fftw;
+    } else if (name == "static") {
+        backend = FftBackend::Static;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+FftPlan::FftPlan(const FftPlanKey& key, FftBackend backend) : planKey(key), planBackend(backend) {
+    in = allocate(key, inputCount(key), realInput(key));
+    out = allocate(key, outputCount(key), realOutput(key));
+    if (!in || !out) {
+        return;
+    }
+
+    if (backend == FftBackend::Static) {
+        kernel = key.precision == FftPrecision::Double ? findStaticKernel<double>(key.size, key.direction)
+                                                       : findStaticKernel<float>(key.size, key.direction);
+        return;
+    }
+
+#ifdef HAVE_FFTW
+    int n = key.size;
+    if (key.precision == FftPrecision::Double) {
+        switch (key.direction) {
+            case FftDirection::RealToComplex:
+                plan = fftw_plan_dft_r2c_1d(n, input<double>(), output<fftw_complex>(), key.flags);
+                break;
+            case FftDirection::ComplexToReal:
+                plan = fftw_plan_dft_c2r_1d(n, input<fftw_complex>(), output<double>(), key.flags);
+                break;
+            case FftDirection::Forward:
+            case FftDirection::Backward:
+                plan = fftw_plan_dft_1d(n, input<fftw_complex>(), output<fftw_complex>(),
+                                        key.direction == FftDirection::Forward ? FFTW_FORWARD : FFTW_BACKWARD,
+                                        key.flags);
+                break;
+        }
+    } else {
+        switch (key.direction) {
+            case FftDirection::RealToComplex:
+                plan = fftwf_plan_dft_r2c_1d(n, input<float>(), output<fftwf_complex>(), key.flags);
+                break;
+            case FftDirection::ComplexToReal:
+                plan = fftwf_plan_dft_c2r_1d(n, input<fftwf_complex>(), output<float>(), key.flags);
+                break;
+            case FftDirection::Forward:
+            case FftDirection::Backward:
+                plan = fftwf_plan_dft_1d(n, input<fftwf_complex>(), output<fftwf_complex>(),
+                                         key.direction == FftDirection::Forward ? FFTW_FORWARD : FFTW_BACKWARD,
+                                         key.flags);
+                break;
+        }
+    }
+#endif
+}
+
+FftPlan::~FftPlan() {
+#ifdef HAVE_FFTW
+    if (plan) {
+        if (planKey.precision == FftPrecision::Double) {
+            fftw_destroy_plan(static_cast<fftw_plan>(plan));
+        } else {
+            fftwf_destroy_plan(static_cast<fftwf_plan>(plan));
+        }
+    }
+#endif
+    release(planKey.precision, in);
+    release(planKey.precision, out);
+}
+
+void FftPlan::execute() {
+    execute(in, out);
+}
+
+void FftPlan::execute(void* input, void* output) const {
+    if (kernel) {
+        kernel(input, output);
+        return;
+    }
+
+#ifdef HAVE_FFTW
+    // The new-array execute functions are the only thread-safe part of FFTW
+    if (planKey.precision == FftPrecision::Double) {
+        fftw_plan p = static_cast<fftw_plan>(plan);
+        switch (planKey.direction) {
+            case FftDirection::RealToComplex:
+                fftw_execute_dft_r2c(p, static_cast<double*>(input), static_cast<fftw_complex*>(output));
+                break;
+            case FftDirection::ComplexToReal:
+                fftw_execute_dft_c2r(p, static_cast<fftw_complex*>(input), static_cast<double*>(output));
+                break;
+            case FftDirection::Forward:
+            case FftDirection::Backward:
+                fftw_execute_dft(p, static_cast<fftw_complex*>(input), static_cast<fftw_complex*>(output));
+                break;
+        }
+    } else {
+        fftwf_plan p = static_cast<fftwf_plan>(plan);
+        switch (planKey.direction) {
+            case FftDirection::RealToComplex:
+                fftwf_execute_dft_r2c(p, static_cast<float*>(input), static_cast<fftwf_complex*>(output));
+                break;
+            case FftDirection::ComplexToReal:
+                fftwf_execute_dft_c2r(p, static_cast<fftwf_complex*>(input), static_cast<float*>(output));
+                break;
+            case FftDirection::Forward:
+            case FftDirection::Backward:
+                fftwf_execute_dft(p, static_cast<fftwf_complex*>(input), static_cast<fftwf_complex*>(output));
+                break;
+        }
+    }
+#endif
+}
+
+FftWorkspace::~FftWorkspace() {
+    for (auto& entry : arrays) {
+        release(entry.second.precision, entry.second.in);
+        release(entry.second.precision, entry.second.out);
+    }
+}
+
+FftWorkspace::Arrays& FftWorkspace::arraysFor(const FftPlan& plan) {
+    const FftPlanKey& key = plan.key();
+    Arrays& entry = arrays[Key(key.size, key.direction, key.precision)];
+    if (!entry.in) {
+        entry.precision = key.precision;
+        entry.in = allocate(key, inputCount(key), realInput(key));
+        entry.out = allocate(key, outputCount(key), realOutput(key));
+    }
+    return entry;
+}
+
+FftPlanCache::FftPlanCache(FftBackend backend) : planBackend(backend) {
+}
+
+FftPlanCache::~FftPlanCache() {
+    clear();
+}
+
+FftPlan* FftPlanCache::get(const FftPlanKey& key) {
+    if (key.size < 1) {
+        return nullptr;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = plans.find(key);
+    if (found != plans.end()) {
+        return found->second.get();
+    }
+    
+    if (planBackend == FftBackend::Static) {
+        std::unique_ptr<FftPlan> plan(new FftPlan(key, FftBackend::Static));
+        if (plan->kernel) {
+            Logger::debug("Using built-in FFT for " + std::to_string(key.size) + " points");
+            return (plans[key] = std::move(plan)).get();
+        }
+        if (!fftBackendAvailable(FftBackend::Fftw)) {
+            Logger::error("No built-in FFT for " + std::to_string(key.size) +
+                          " points (powers of two from " + std::to_string(STATIC_FFT_MIN_SIZE) + " to " +
+                          std::to_string(STATIC_FFT_MAX_SIZE) + " only) and no FFTW in this build");
+            return nullptr;
+        }
+        Logger::debug("No built-in FFT for " + std::to_string(key.size) + " points, using FFTW");
+    }
+
+    std::unique_ptr<FftPlan> plan(new FftPlan(key, FftBackend::Fftw));
+    if (!plan->plan && (key.flags & FFT_PLAN_WISDOM_ONLY)) {
+        Logger::debug("No FFTW wisdom for " + std::to_string(key.size) + " points, using FFTW_ESTIMATE");
+        FftPlanKey fallback = key;
+        fallback.flags = FFT_PLAN_ESTIMATE;
+        plan.reset(new FftPlan(fallback, FftBackend::Fftw));
+    }
+    if (!plan->plan) {
+        Logger::error("Failed to create FFTW plan for " + std::to_string(key.size) + " points");
+        return nullptr;
+    }
+    Logger::debug("Created FFTW plan for " + std::to_string(key.size) + " points");
+    return (plans[key] = std::move(plan)).get();
+}
+
+size_t FftPlanCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return plans.size();
+}
+
+void FftPlanCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    plans.clear();
+}
+
+bool FftPlanCache::setBackend(FftBackend backend) {
+    if (!fftBackendAvailable(backend)) {
+        Logger::error(std::string("FFT backend ") + fftBackendName(backend) + " is not in this build");
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (backend != planBackend) {
+        plans.clear();
+        planBackend = backend;
+    }
+    return true;
+}
+
+FftBackend FftPlanCache::backend() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return planBackend;
+}
+
+#ifdef HAVE_FFTW
+bool importFftWisdom(const std::string& path) {
+    if (!fftw_import_wisdom_from_filename(path.c_str())) {
+        return false;
+    }
+    // Single precision wisdom is optional
+    fftwf_import_wisdom_from_filename(singlePrecisionWisdomPath(path).c_str());
+    return true;
+}
+
+bool exportFftWisdom(const std::string& path) {
+    bool exported = fftw_export_wisdom_to_filename(path.c_str()) != 0;
+    exported = fftwf_export_wisdom_to_filename(singlePrecisionWisdomPath(path).c_str()) != 0 && exported;
+    if (!exported) {
+        Logger::error("Failed to write FFTW wisdom to " + path);
+    }
+    return exported;
+}
+
+bool planFftWisdom(const std::vector<int>& sizes) {
+    // Plans are thrown away afterwards; only the wisdom is kept
+    FftPlanCache cache;
+    bool planned = true;
+    for (int size : sizes) {
+        for (FftPrecision precision : {FftPrecision::Double, FftPrecision::Single}) {
+            Logger::info("Planning " + std::to_string(size) + " point " +
+                         (precision == FftPrecision::Double ? "double" : "single") +
+                         " precision FFT with FFTW_PATIENT");
+            planned = cache.get({size, FftDirection::RealToComplex, precision, FFT_PLAN_PATIENT}) && planned;
+        }
+    }
+    return planned;
+}
+#else
+bool importFftWisdom(const std::string&) {
+    return false;
+}
+
+bool exportFftWisdom(const std::string& path) {
+    Logger::error("Can't write FFTW wisdom to " + path + " without FFTW in this build");
+    return false;
+}
+
+bool planFftWisdom(const std::vector<int>&) {
+    Logger::error("Can't plan FFTW wisdom without FFTW in this build");
+    return false;
+}
+#endif
@@ -0,0 +1,42 @@
+#include "fir.hpp"
+#include <cmath>
+#include <complex>
+
+namespace {
+// sin(pi x) / (pi x)
+double sinc(double x) {
+    return x == 0.0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+}
+}
+
+std::vector<float> designBandPass(size_t taps, double lowHz, double highHz, double sampleRate, double kaiserBeta) {
+    double nyquist = sampleRate / 2.0;
+    if (taps < 3 || lowHz < 0.0 || highHz <= lowHz || highHz > nyquist) {
+        throw std::invalid_argument("Invalid " + std::to_string(taps) + " tap band-pass filter from " +
+                                    std::to_string(lowHz) + " to " + std::to_string(highHz) + " Hz at " +
+                                    std::to_string(sampleRate) + " Hz");
+    }
+    
+    // Ideal response (a low-pass at highHz minus one at lowHz), windowed
+    double low = lowHz / sampleRate;
+    double high = highHz / sampleRate;
+    double middle = (taps - 1) / 2.0;
+    std::vector<double> window = makeWindow(WindowType::Kaiser, taps, kaiserBeta);
+    std::vector<double> ideal(taps);
+    for (size_t i = 0; i < taps; i++) {
+        double t = i - middle;
+        ideal[i] = window[i] * (2.0 * high * sinc(2.0 * high * t) - 2.0 * low * sinc(2.0 * low * t));
+    }
+    
+    // Unit gain at the center of the band
+    double center = (low + high) / 2.0;
+    std::complex<double> gain;
+    for (size_t i = 0; i < taps; i++) {
+        gain += ideal[i] * std::polar(1.0, -2.0 * M_PI * center * i);
+    }
+    std::vector<float> coefficients(taps);
+    for (size_t i = 0; i < taps; i++) {
+        coefficients[i] = static_cast<float>(ideal[i] / std::abs(gain));
+    }
+    return coefficients;
+}
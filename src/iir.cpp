@@ -0,0 +1,81 @@
+#include "iir.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+void checkCorner(double cutoffHz, double sampleRate) {
+    if (!(cutoffHz > 0.0) || !(cutoffHz < sampleRate / 2.0)) {
+        throw std::invalid_argument("Invalid filter corner of " + std::to_string(cutoffHz) + " Hz at " +
+                                    std::to_string(sampleRate) + " Hz");
+    }
+}
+}
+
+DcBlocker::DcBlocker(double cutoffHz, double sampleRate) {
+    checkCorner(cutoffHz, sampleRate);
+    pole = std::exp(-2.0 * M_PI * cutoffHz / sampleRate);
+}
+
+void DcBlocker::reset() {
+    previousIn = 0.0;
+    previousOut = 0.0;
+    primed = false;
+}
+
+BiquadCoefficients designHighPass(double cutoffHz, double sampleRate, double q) {
+    checkCorner(cutoffHz, sampleRate);
+    if (!(q > 0.0)) {
+        throw std::invalid_argument("Invalid biquad Q of " + std::to_string(q));
+    }
+    double w0 = 2.0 * M_PI * cutoffHz / sampleRate;
+    double cosine = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+    return {(1.0 + cosine) / 2.0 / a0, -(1.0 + cosine) / a0, (1.0 + cosine) / 2.0 / a0,
+            -2.0 * cosine / a0, (1.0 - alpha) / a0};
+}
+
+std::vector<BiquadCoefficients> designButterworthHighPass(int sections, double cutoffHz, double sampleRate) {
+    // The poles of an order 2N Butterworth filter pair up into sections with
+    // Q = 1 / (2 cos((2k - 1) pi / 4N))
+    std::vector<BiquadCoefficients> result;
+    for (int k = 1; k <= sections; k++) {
+        double q = 1.0 / (2.0 * std::cos((2 * k - 1) * M_PI / (4.0 * sections)));
+        result.push_back(designHighPass(cutoffHz, sampleRate, q));
+    }
+    return result;
+}
+
+BiquadCascade::BiquadCascade(std::vector<BiquadCoefficients> sections)
+    : coefficients(std::move(sections)), state(coefficients.size()) {
+    reset();
+}
+
+void BiquadCascade::reset() {
+    for (auto& section : state) {
+        section.fill(0.0);
+    }
+}
+
+DcFilter::DcFilter(const DcBlockerConfig& config, double sampleRate)
+    : blocker(config.cutoffHz, sampleRate),
+      highPass(designButterworthHighPass(std::max(0, config.highPassSections), config.highPassHz, sampleRate)) {
+}
+
+void DcFilter::process(const int* samples, size_t count, int16_t* out) {
+    constexpr float low = std::numeric_limits<int16_t>::min();
+    constexpr float high = std::numeric_limits<int16_t>::max();
+    for (size_t i = 0; i < count; i++) {
+        float value = push(static_cast<float>(samples[i]));
+        out[i] = static_cast<int16_t>(std::lround(std::min(high, std::max(low, value))));
+    }
+}
+
+void DcFilter::reset() {
+    blocker.reset();
+    highPass.reset();
+}
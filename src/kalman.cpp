@@ -0,0 +1,124 @@
+#include "kalman.hpp"
+#include <algorithm>
+#include <cmath>
+
+SpeedKalmanFilter::SpeedKalmanFilter(const SpeedKalmanConfig& config) : settings(config) {
+}
+
+void SpeedKalmanFilter::start(double time, double speedMPH) {
+    running = true;
+    now = time;
+    state[0] = speedMPH;
+    state[1] = 0.0;
+    double noise = settings.measurementNoiseMPH;
+    double deceleration = settings.decelerationSigma;
+    covariance[0][0] = noise * noise;
+    covariance[0][1] = covariance[1][0] = 0.0;
+    covariance[1][1] = deceleration * deceleration;
+}
+
+void SpeedKalmanFilter::predict(double time) {
+    double dt = time - now;
+    now = time;
+    if (dt == 0.0) {
+        return;
+    }
+    state[0] += dt * state[1];
+
+    // P = F P F' + Q with F = [1 dt; 0 1] and the deceleration's random walk
+    // integrated over |dt| (Q's cross term takes the sign of dt)
+    double q = static_cast<double>(settings.decelerationNoise) * settings.decelerationNoise;
+    double span = std::abs(dt);
+    double p00 = covariance[0][0] + 2.0 * dt * covariance[0][1] + dt * dt * covariance[1][1] +
+                 q * span * span * span / 3.0;
+    double p01 = covariance[0][1] + dt * covariance[1][1] + q * dt * span / 2.0;
+    double p11 = covariance[1][1] + q * span;
+    covariance[0][0] = p00;
+    covariance[0][1] = covariance[1][0] = p01;
+    covariance[1][1] = p11;
+}
+
+double SpeedKalmanFilter::innovationSigma() const {
+    double noise = settings.measurementNoiseMPH;
+    return std::sqrt(covariance[0][0] + noise * noise);
+}
+
+bool SpeedKalmanFilter::update(double speedMPH) {
+    double innovation = speedMPH - state[0];
+    double sigma = innovationSigma();
+    if (std::abs(innovation) > settings.gateSigmas * sigma) {
+        return false;
+    }
+    double s = sigma * sigma;
+    double gainSpeed = covariance[0][0] / s;
+    double gainRate = covariance[0][1] / s;
+    state[0] += gainSpeed * innovation;
+    state[1] += gainRate * innovation;
+
+    // P = (I - K H) P with H = [1 0]
+    double p00 = covariance[0][0] - gainSpeed * covariance[0][0];
+    double p01 = covariance[0][1] - gainSpeed * covariance[0][1];
+    double p11 = covariance[1][1] - gainRate * covariance[0][1];
+    covariance[0][0] = p00;
+    covariance[0][1] = covariance[1][0] = p01;
+    covariance[1][1] = p11;
+    return true;
+}
+
+double SpeedKalmanFilter::speedSigma() const {
+    return std::sqrt(std::max(0.0, covariance[0][0]));
+}
+
+LaunchSpeed estimateLaunchSpeed(const std::vector<StftFrame>& frames, double sampleRate, int frameSize,
+                                float ballSpeedMPH, double impactSample, const SpeedKalmanConfig& config) {
+    LaunchSpeed result;
+    if (sampleRate <= 0.0 || ballSpeedMPH <= 0.0f) {
+        return result;
+    }
+
+    SpeedKalmanFilter filter(config);
+    for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame) {
+        double middle = frame->firstSample + frameSize / 2.0;
+        if (middle < impactSample) {
+            break;
+        }
+        double time = middle / sampleRate;
+
+        // Before the filter starts, the ball is the peak near its known
+        // speed; after, the peak closest to the prediction
+        double expected = ballSpeedMPH;
+        if (filter.started()) {
+            filter.predict(time);
+            expected = filter.speed();
+        }
+        float closest = 0.0f;
+        for (size_t i = 0; i < frame->peakCount; i++) {
+            float speed = frame->peaks[i].speedMPH;
+            if (speed > 0.0f && (closest == 0.0f || std::abs(speed - expected) < std::abs(closest - expected))) {
+                closest = speed;
+            }
+        }
+        if (closest == 0.0f) {
+            continue;
+        }
+
+        if (!filter.started()) {
+            if (std::abs(closest - ballSpeedMPH) <= config.seedTolerance * ballSpeedMPH) {
+                filter.start(time, closest);
+                result.frames++;
+            }
+        } else if (filter.update(closest)) {
+            result.frames++;
+        }
+    }
+    if (result.frames < config.minFrames) {
+        result.frames = 0;
+        return result;
+    }
+
+    filter.predict(impactSample / sampleRate);
+    result.speedMPH = static_cast<float>(filter.speed());
+    result.uncertaintyMPH = static_cast<float>(filter.speedSigma());
+    result.decelerationMPHPerS = static_cast<float>(filter.deceleration());
+    return result;
+}
@@ -1,6 +1,12 @@
 #include "logger.hpp"
 #include <chrono>
 #include <ctime>
+#include <mutex>
+
+namespace {
+// Log lines come from the acquisition, processing and main threads
+std::mutex logMutex;
+}
 
 LogLevel Logger::currentLogLevel = LogLevel::DEBUG;
 std::ostream* Logger::outputStream = &std::cout;
@@ -26,6 +32,8 @@ void Logger::log(const std::string& msg, LogLevel level) {
         return;
     }
 
+    std::lock_guard<std::mutex> lock(logMutex);
+    
     // Make sure we have a valid output stream
     if (!outputStream) {
         outputStream = &std::cout;
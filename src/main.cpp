@@ -19,6 +19,9 @@ std::atomic<int> shotCount(0);
 struct ShotData {
     std::chrono::time_point<std::chrono::steady_clock> timestamp;
     float ballSpeedMPH;
+    float clubSpeedMPH;  // 0 if the club wasn't picked up
+    float smashFactor;
+    float snrDB;
     std::string timeString;
 };
 
@@ -35,6 +38,28 @@ std::string timestampToString(const std::chrono::time_point<std::chrono::steady_
     return ss.str();
 }
 
+// Parse a whole option value as a number. False for anything else, such as
+// "x" or "4x", instead of the exceptions std::stoi and std::stod throw.
+bool parseNumber(const std::string& text, int& value) {
+    try {
+        size_t used = 0;
+        value = std::stoi(text, &used);
+        return used == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool parseNumber(const std::string& text, double& value) {
+    try {
+        size_t used = 0;
+        value = std::stod(text, &used);
+        return used == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
 // Display shot data in a formatted way
 void displayShotData(const ShotData& shot, int shotNumber) {
     std::string divider = "----------------------------------------";
@@ -43,12 +68,37 @@ void displayShotData(const ShotData& shot, int shotNumber) {
     std::cout << "SHOT #" << shotNumber << std::endl;
     std::cout << divider << std::endl;
     std::cout << "Ball Speed: " << std::fixed << std::setprecision(1) << shot.ballSpeedMPH << " mph" << std::endl;
+    if (shot.clubSpeedMPH > 0.0f) {
+        std::cout << "Club Speed: " << std::fixed << std::setprecision(1) << shot.clubSpeedMPH << " mph" << std::endl;
+        std::cout << "Smash:      " << std::fixed << std::setprecision(2) << shot.smashFactor << std::endl;
+    }
+    std::cout << "SNR:        " << std::fixed << std::setprecision(1) << shot.snrDB << " dB" << std::endl;
     std::cout << "Time:       " << shot.timeString << std::endl;
     std::cout << divider << std::endl << std::endl;
     Logger::info("Shot #" + std::to_string(shotNumber) + " - Ball speed: " + 
                 std::to_string(shot.ballSpeedMPH) + " mph");
 }
 
+// Reanalyze every recording in a directory and print one CSV line per file
+int analyzeCaptureDirectory(const std::string& directory, size_t threads) {
+    std::vector<std::string> files;
+    std::vector<RadarMeasurement> results =
+        RadarManager::getInstance().processCaptureDirectory(directory, &files, threads);
+    if (files.empty()) {
+        Logger::error("No captures found in " + directory);
+        return 1;
+    }
+    
+    std::cout << "file,detected,speed_mph,ball_mph,club_mph,launch_mph,snr_db" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t i = 0; i < files.size(); i++) {
+        const RadarMeasurement& result = results[i];
+        std::cout << files[i] << "," << result.detected << "," << result.speedMPH << "," << result.ballSpeedMPH
+                  << "," << result.clubSpeedMPH << "," << result.launchSpeedMPH << "," << result.snrDB << std::endl;
+    }
+    return 0;
+}
+
 // Signal handler for graceful shutdown
 void signalHandler(int signal) {
     Logger::info("Received signal " + std::to_string(signal) + ", shutting down gracefully...");
@@ -65,27 +115,181 @@ int main(int argc, char* argv[]) {
     Logger::setLogLevel(LogLevel::DEBUG);
     Logger::info("Starting DIY Launch Monitor...");
     
-    // Check if debug mode is requested
+    // Parse command line options
     bool debugMode = false;
-    if (argc > 1 && std::string(argv[1]) == "--debug") {
-        debugMode = true;
-        Logger::info("Running in DEBUG mode without hardware");
+    std::string sourceSpec;
+    RealtimeConfig realtimeConfig;
+    WindowType windowType = WindowType::Hamming;
+    std::string wisdomFile = DEFAULT_WISDOM_FILE;
+    bool planWisdom = false;
+    std::string batchDirectory;
+    size_t batchThreads = 0;
+    FftPrecision fftPrecision = FftPrecision::Double;
+    FftBackend fftBackend = DEFAULT_FFT_BACKEND;
+    PeakEstimator peakEstimator = PeakEstimator::Parabolic;
+    TriggerMode triggerMode = TriggerMode::Ir;
+    CfarConfig cfar;
+    StreamFilterConfig streamFilter;
+    DcBlockerConfig dcBlocker;
+    ZoomConfig zoom;
+    SpeedKalmanConfig launchSpeed;
+    double minSnrDB = -std::numeric_limits<double>::infinity();
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--debug") {
+            debugMode = true;
+            Logger::info("Running in DEBUG mode without hardware");
+        } else if (arg == "--source" && i + 1 < argc) {
+            // e.g. --source file:captures/shot.wav,speed=4 or --source synthetic:ball=140
+            sourceSpec = argv[++i];
+        } else if (arg.rfind("--source=", 0) == 0) {
+            sourceSpec = arg.substr(9);
+        } else if (arg == "--realtime") {
+            // SCHED_FIFO, locked memory, and optionally a dedicated core for acquisition
+            realtimeConfig.enabled = true;
+        } else if (arg == "--rt-cpu" && i + 1 < argc) {
+            realtimeConfig.enabled = true;
+            if (!parseNumber(argv[++i], realtimeConfig.cpu)) {
+                Logger::error("Invalid CPU number: " + std::string(argv[i]));
+                return 1;
+            }
+        } else if (arg == "--window" && i + 1 < argc) {
+            // hamming, hann, blackman-harris, kaiser or flat-top
+            if (!parseWindowType(argv[++i], windowType)) {
+                Logger::error("Unknown FFT window: " + std::string(argv[i]));
+                return 1;
+            }
+        } else if (arg == "--wisdom" && i + 1 < argc) {
+            wisdomFile = argv[++i];
+        } else if (arg == "--fft" && i + 1 < argc) {
+            // fftw, or static for the built-in kernels
+            if (!parseFftBackend(argv[++i], fftBackend) || !fftBackendAvailable(fftBackend)) {
+                Logger::error("Unknown or unavailable FFT backend: " + std::string(argv[i]));
+                return 1;
+            }
+        } else if (arg == "--single-precision") {
+            // Run the radar DSP in float instead of double
+            fftPrecision = FftPrecision::Single;
+        } else if (arg == "--peak-estimator" && i + 1 < argc) {
+            // none, parabolic, jacobsen, quinn or zero-padded
+            if (!parsePeakEstimator(argv[++i], peakEstimator)) {
+                Logger::error("Unknown peak estimator: " + std::string(argv[i]));
+                return 1;
+            }
+        } else if (arg == "--cfar" && i + 1 < argc) {
+            // ca (cell averaging), os (ordered statistic) or off
+            std::string method = argv[++i];
+            if (method == "ca" || method == "os") {
+                cfar.method = method == "ca" ? CfarMethod::CellAveraging : CfarMethod::OrderedStatistic;
+            } else if (method == "off") {
+                cfar.enabled = false;
+            } else {
+                Logger::error("Unknown CFAR method: " + method);
+                return 1;
+            }
+        } else if (arg == "--trigger" && i + 1 < argc) {
+            // ir, radar, either or both
+            if (!parseTriggerMode(argv[++i], triggerMode)) {
+                Logger::error("Unknown trigger mode: " + std::string(argv[i]));
+                return 1;
+            }
+        } else if (arg == "--min-snr" && i + 1 < argc) {
+            // Drop reads whose return is weaker than this many dB over the noise
+            if (!parseNumber(argv[++i], minSnrDB)) {
+                Logger::error("Invalid minimum SNR: " + std::string(argv[i]));
+                return 1;
+            }
+        } else if (arg == "--zoom") {
+            // Fine chirp-z spectrum over the ball speed band
+            zoom.enabled = true;
+        } else if (arg == "--launch-speed") {
+            // Report the ball speed at impact rather than over the capture
+            launchSpeed.enabled = true;
+        } else if (arg == "--stream-filter" && i + 1 < argc) {
+            // Band-pass the stream and sample the ADC this many times faster, then decimate
+            streamFilter.enabled = true;
+            if (!parseNumber(argv[++i], streamFilter.decimation) || streamFilter.decimation < 1) {
+                Logger::error("Invalid stream filter decimation: " + std::string(argv[i]));
+                return 1;
+            }
+        } else if (arg == "--dc-blocker") {
+            // Center the samples as they are acquired
+            dcBlocker.enabled = true;
+        } else if (arg == "--high-pass" && i + 1 < argc) {
+            // Biquad sections of a high-pass after the DC blocker
+            dcBlocker.enabled = true;
+            if (!parseNumber(argv[++i], dcBlocker.highPassSections) || dcBlocker.highPassSections < 0) {
+                Logger::error("Invalid high-pass section count: " + std::string(argv[i]));
+                return 1;
+            }
+        } else if (arg == "--batch" && i + 1 < argc) {
+            // Offline: analyze the recordings in a directory and exit
+            batchDirectory = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            // Workers for --batch, one per core by default
+            int threads = 0;
+            if (!parseNumber(argv[++i], threads) || threads < 0) {
+                Logger::error("Invalid thread count: " + std::string(argv[i]));
+                return 1;
+            }
+            batchThreads = static_cast<size_t>(threads);
+        } else if (arg == "--plan-wisdom") {
+            // Offline: measure the best FFT plans once so startup doesn't have to
+            planWisdom = true;
+        } else {
+            Logger::error("Unknown option: " + arg);
+            return 1;
+        }
+    }
+    
+    RadarManager::getInstance().setWisdomFile(wisdomFile);
+    if (planWisdom) {
+        return RadarManager::getInstance().planWisdom() ? 0 : 1;
     }
     
     // Initialize components
     Logger::info("Initializing components...");
-    initCamera();
+    if (batchDirectory.empty()) {
+        initCamera();
+    }
+    if (!sourceSpec.empty()) {
+        auto source = makeSampleSource(sourceSpec, RADAR_ADC_CHANNEL, DEFAULT_SAMPLE_FREQ);
+        if (!source) {
+            return 1;
+        }
+        RadarManager::getInstance().setSampleSource(std::move(source));
+    }
+    RadarManager::getInstance().setWindow(windowType);
+    RadarManager::getInstance().setFftBackend(fftBackend);
+    RadarManager::getInstance().setFftPrecision(fftPrecision);
+    RadarManager::getInstance().setPeakEstimator(peakEstimator);
+    RadarManager::getInstance().setCfar(cfar);
+    RadarManager::getInstance().setZoom(zoom);
+    RadarManager::getInstance().setSpeedKalman(launchSpeed);
+    RadarManager::getInstance().setMinimumQuality(minSnrDB);
     RadarManager::getInstance().init();
     
-    if (!debugMode) {
-        TriggerManager::getInstance().init();
+    if (!batchDirectory.empty()) {
+        // Debug lines from every worker would serialize them on the log
+        Logger::setLogLevel(LogLevel::INFO);
+        int status = analyzeCaptureDirectory(batchDirectory, batchThreads);
+        RadarManager::getInstance().cleanup();
+        return status;
     }
     
-    // Register radar callback to store and display measurements
+    // Register radar callback to store and display measurements. The processing
+    // thread calls it, so it has to be in place before acquisition starts.
     RadarManager::getInstance().setMeasurementCallback([](const RadarMeasurement& measurement) {
         ShotData shot;
         shot.timestamp = measurement.timestamp;
-        shot.ballSpeedMPH = measurement.speedMPH;
+        // The strongest return over the whole capture may be the club
+        shot.ballSpeedMPH = measurement.ballSpeedMPH > 0.0f ? measurement.ballSpeedMPH : measurement.speedMPH;
+        if (measurement.launchSpeedMPH > 0.0f) {
+            shot.ballSpeedMPH = measurement.launchSpeedMPH;
+        }
+        shot.clubSpeedMPH = measurement.clubSpeedMPH;
+        shot.smashFactor = measurement.smashFactor;
+        shot.snrDB = measurement.snrDB;
         shot.timeString = timestampToString(measurement.timestamp);
         shotHistory.push_back(shot);
         
@@ -93,6 +297,23 @@ int main(int argc, char* argv[]) {
         displayShotData(shot, currentShot);
     });
     
+    if (!debugMode) {
+        TriggerManager::getInstance().init();
+        TriggerManager::getInstance().setTriggerMode(triggerMode);
+        if (triggerMode != TriggerMode::Ir) {
+            // Detect shots in the radar stream as well as (or instead of) the IR sensor
+            RadarManager::getInstance().setEnergyTrigger([](SteadyTime time) {
+                TriggerManager::getInstance().radarTriggered(time);
+            });
+        }
+        // Keep the radar streaming into its history so shots include pre-trigger samples
+        RadarManager::getInstance().setRealtimeConfig(realtimeConfig);
+        RadarManager::getInstance().setStreamFilter(streamFilter);
+        RadarManager::getInstance().setDcBlocker(dcBlocker);
+        RadarManager::getInstance().startAcquisition(DEFAULT_HISTORY_SAMPLES,
+                                                     DEFAULT_SAMPLE_FREQ * streamFilter.decimation);
+    }
+    
     if (!debugMode) {
         // Register trigger callback to start radar measurement
         TriggerManager::getInstance().setTriggerCallback([](std::chrono::time_point<std::chrono::steady_clock> timestamp) {
@@ -101,7 +322,7 @@ int main(int argc, char* argv[]) {
                 timestamp - programStart).count();
             
             Logger::info("Ball detected at " + std::to_string(millisSinceStart) + " ms");
-            RadarManager::getInstance().startMeasurement();
+            RadarManager::getInstance().startMeasurement(timestamp);
             
             // TODO: Start camera capture
             // captureFrames();
@@ -1,96 +1,97 @@
 #include "radar.hpp"
 #include "logger.hpp"
+#include "spectrum.hpp"
+#include "thread_pool.hpp"
 #include <cmath>
 #include <algorithm>
-#include <numeric>
+#include <iterator>
 #include <thread>
-#include <bcm2835.h>
-#include <fftw3.h>
+#include <stdexcept>
+#include <type_traits>
 
 void RadarManager::init(int channel) {
     adcChannel = channel;
     
     Logger::debug("Initializing Radar on ADC channel " + std::to_string(adcChannel));
     
-    // Initialize BCM2835 library for SPI communication
-    if (!bcm2835_init()) {
-        Logger::error("Failed to initialize BCM2835 library");
-        return;
-    }
-    
-    // Initialize SPI
-    if (!bcm2835_spi_begin()) {
-        Logger::error("Failed to initialize SPI");
-        bcm2835_close();
-        return;
+    {
+        std::lock_guard<std::mutex> lock(sourceMutex);
+        if (!sampleSource) {
+            // Default to the MCP3008 on the bcm2835 SPI bus
+            auto transport = std::make_unique<Bcm2835SpiTransport>();
+            if (transport->isOpen()) {
+                sampleSource = std::make_unique<Mcp3008SampleSource>(
+                    std::move(transport), adcChannel, DEFAULT_SAMPLE_FREQ);
+            }
+        }
+        if (sampleSource) {
+            Logger::info("Radar sample source: " + sampleSource->describe());
+        }
     }
     
-    // Configure SPI
-    bcm2835_spi_setBitOrder(BCM2835_SPI_BIT_ORDER_MSBFIRST);
-    bcm2835_spi_setDataMode(BCM2835_SPI_MODE0);
-    bcm2835_spi_setClockDivider(BCM2835_SPI_CLOCK_DIVIDER_64); // ~4MHz
-    bcm2835_spi_chipSelect(BCM2835_SPI_CS0);
-    
-    // Initialize FFTW plans if not already created
-    if (!fftw_initialized) {
-        // Allocate input and output arrays
-        fftw_in = (double*)fftw_malloc(sizeof(double) * DEFAULT_SAMPLE_COUNT);
-        fftw_out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (DEFAULT_SAMPLE_COUNT/2 + 1));
-        
-        // Create FFTW plan
-        fftw_plan_r2c = fftw_plan_dft_r2c_1d(DEFAULT_SAMPLE_COUNT, fftw_in, fftw_out, FFTW_MEASURE);
-        
-        if (!fftw_plan_r2c) {
-            Logger::error("Failed to create FFTW plan");
-            fftw_free(fftw_in);
-            fftw_free(fftw_out);
+    // Create the plan for the default capture length up front; plans for
+    // other lengths are created when first needed. Plans only come from
+    // wisdom, measuring them here would delay startup by seconds.
+    {
+        std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+        if (!fftw_initialized && fftPlans.backend() == FftBackend::Fftw) {
+            if (!wisdomFile.empty() && importFftWisdom(wisdomFile)) {
+                Logger::info("Loaded FFTW wisdom from " + wisdomFile);
+            } else {
+                Logger::info("No FFTW wisdom in " + wisdomFile + 
+                            ", using FFTW_ESTIMATE plans (run with --plan-wisdom to create it)");
+            }
+        }
+        fftPlanFlags = FFT_PLAN_MEASURE | FFT_PLAN_WISDOM_ONLY;
+        if (!fftPlans.get({DEFAULT_SAMPLE_COUNT, FftDirection::RealToComplex, FftPrecision::Double, fftPlanFlags})) {
             return;
         }
-        
         fftw_initialized = true;
     }
     
     Logger::info("Radar initialized on ADC channel " + std::to_string(adcChannel));
 }
 
+RadarManager::~RadarManager() {
+    stopAcquisition();
+}
+
 void RadarManager::cleanup() {
+    stopAcquisition();
+
     // Wait for any ongoing measurements to complete
     while (measurement_in_progress.load()) {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
     
     // Use mutex to ensure thread safety during cleanup
-    std::lock_guard<std::mutex> lock(fftw_mutex);
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
     
-    // Free FFTW resources if they were initialized
-    if (fftw_initialized) {
-        if (fftw_plan_r2c) {
-            fftw_destroy_plan(fftw_plan_r2c);
-            fftw_plan_r2c = nullptr;
-        }
-        
-        if (fftw_in) {
-            fftw_free(fftw_in);
-            fftw_in = nullptr;
-        }
-        
-        if (fftw_out) {
-            fftw_free(fftw_out);
-            fftw_out = nullptr;
-        }
-        
-        fftw_initialized = false;
+    // Free FFTW plans and buffers, and the speed tracker using them
+    {
+        std::lock_guard<std::mutex> stftLock(stftMutex);
+        stftEngine.reset();
     }
+    zoomTransforms.clear();
+    captureStftEngines.clear();
+    fftPlans.clear();
+    fftw_initialized = false;
     
-    // End SPI communication
-    bcm2835_spi_end();
-    // Close BCM2835 library
-    bcm2835_close();
+    // Release the sample source (this closes the SPI bus)
+    {
+        std::lock_guard<std::mutex> sourceLock(sourceMutex);
+        sampleSource.reset();
+    }
     
     Logger::info("Radar resources cleaned up");
 }
 
 void RadarManager::setMeasurementCallback(std::function<void(const RadarMeasurement&)> callback) {
+    // The processing thread calls it without a lock
+    if (isAcquiring()) {
+        Logger::error("Cannot change the measurement callback while acquisition is running");
+        return;
+    }
     measurementCallback = callback;
 }
 
@@ -102,11 +103,15 @@ void RadarManager::startMeasurement() {
     std::thread([this] {
         try {
             // Read samples from ADC
-            std::vector<int> samples = readSamples();
+            int sampleFreq = getSampleRate();
+            std::vector<SteadyTime> timestamps;
+            std::vector<int> samples = readSamples(DEFAULT_SAMPLE_COUNT, sampleFreq, timestamps);
             
             // Process samples to get velocity
-            RadarMeasurement measurement = processSamples(samples);
-            if (measurementCallback) {
+            RadarMeasurement measurement = processSamples(samples, sampleFreq, timestamps);
+            if (!measurement.detected) {
+                Logger::info("No target in the radar capture, measurement dropped");
+            } else if (measurementCallback) {
                 measurementCallback(measurement);
             }
         } catch (const std::exception& e) {
@@ -116,72 +121,624 @@ void RadarManager::startMeasurement() {
     }).detach();
 }
 
+void RadarManager::startMeasurement(SteadyTime triggerTime) {
+    if (!isAcquiring()) {
+        startMeasurement();
+        return;
+    }
+    
+    // Hand the trigger to the processing thread. A trigger it hasn't picked
+    // up yet is replaced by the newer one.
+    Logger::debug("Starting radar measurement from the acquisition stream");
+    pendingTrigger.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        triggerTime.time_since_epoch()).count());
+    historyUpdated.notify_all();
+}
+
 std::vector<int> RadarManager::readSamples(int numSamples, int sampleFreq) {
     Logger::debug("Reading " + std::to_string(numSamples) + " samples at " + 
                  std::to_string(sampleFreq) + " Hz");
     
     std::vector<int> samples(numSamples);
+    readAdc(samples.data(), numSamples, sampleFreq, nullptr);
+    return samples;
+}
+
+std::vector<int> RadarManager::readSamples(int numSamples, int sampleFreq,
+                                           std::vector<SteadyTime>& timestamps) {
+    Logger::debug("Reading " + std::to_string(numSamples) + " timestamped samples at " + 
+                 std::to_string(sampleFreq) + " Hz");
+    
+    std::vector<int> samples(numSamples);
+    timestamps.resize(numSamples);
+    readAdc(samples.data(), numSamples, sampleFreq, timestamps.data());
+    return samples;
+}
+
+void RadarManager::readAdc(int* dst, int numSamples, int sampleFreq, SteadyTime* timestamps) {
+    std::lock_guard<std::mutex> lock(sourceMutex);
+    if (!sampleSource) {
+        throw std::runtime_error("No radar sample source available");
+    }
+    
+    if (sampleSource->sampleRate() != sampleFreq && !sampleSource->setSampleRate(sampleFreq)) {
+        throw std::runtime_error("Sample source runs at " + std::to_string(sampleSource->sampleRate()) +
+                                 " Hz, not " + std::to_string(sampleFreq) + " Hz");
+    }
+    
+    size_t count = sampleSource->read(dst, numSamples, timestamps);
+    if (count < static_cast<size_t>(numSamples)) {
+        throw std::runtime_error("Sample source exhausted");
+    }
+}
+
+void RadarManager::setSampleSource(std::unique_ptr<SampleSource> source) {
+    if (isAcquiring()) {
+        Logger::error("Cannot change the sample source while acquisition is running");
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(sourceMutex);
+    sampleSource = std::move(source);
+    if (sampleSource) {
+        Logger::info("Radar sample source: " + sampleSource->describe());
+    }
+}
+
+int RadarManager::getSampleRate() const {
+    std::lock_guard<std::mutex> lock(sourceMutex);
+    return sampleSource ? sampleSource->sampleRate() : DEFAULT_SAMPLE_FREQ;
+}
+
+void RadarManager::setWisdomFile(const std::string& path) {
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+    wisdomFile = path;
+}
+
+bool RadarManager::planWisdom() {
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+    if (wisdomFile.empty()) {
+        Logger::error("No FFTW wisdom file configured");
+        return false;
+    }
+    
+    // Start from the existing wisdom so planning the same sizes again is quick
+    importFftWisdom(wisdomFile);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> sizes(std::begin(WISDOM_FFT_SIZES), std::end(WISDOM_FFT_SIZES));
+    if (!planFftWisdom(sizes) || !exportFftWisdom(wisdomFile)) {
+        return false;
+    }
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    Logger::info("Saved FFTW wisdom to " + wisdomFile + " after " + std::to_string(elapsed) + " ms of planning");
+    return true;
+}
+
+void RadarManager::startAcquisition(size_t historySamples, int sampleFreq) {
+    if (acquiring.load()) {
+        Logger::debug("Radar acquisition already running");
+        return;
+    }
+    
+    if (acquisitionThread.joinable()) {
+        acquisitionThread.join();
+    }
+    if (processingThread.joinable()) {
+        processingThread.join();
+    }
+    
+    {
+        // Recordings have a fixed rate; acquire at whatever rate they were made at
+        std::lock_guard<std::mutex> lock(sourceMutex);
+        if (sampleSource && !sampleSource->setSampleRate(sampleFreq)) {
+            sampleFreq = sampleSource->sampleRate();
+        }
+    }
+    
+    dcFilter.reset();
+    if (dcBlockerConfig.enabled) {
+        try {
+            dcFilter = std::make_unique<DcFilter>(dcBlockerConfig, sampleFreq);
+            Logger::info("DC blocker at " + std::to_string(dcBlockerConfig.cutoffHz) + " Hz with " +
+                        std::to_string(dcBlockerConfig.highPassSections) + " high-pass sections");
+        } catch (const std::exception& e) {
+            Logger::error("DC blocker disabled: " + std::string(e.what()));
+        }
+    }
+    
+    // Everything downstream of the stream filter runs at its output rate
+    streamFilter.reset();
+    streamFreq = sampleFreq;
+    if (streamFilterConfig.enabled) {
+        try {
+            int factor = streamFilterConfig.decimation;
+            if (factor < 1 || sampleFreq % factor != 0) {
+                throw std::invalid_argument("can't decimate " + std::to_string(sampleFreq) + " Hz by " +
+                                            std::to_string(factor));
+            }
+            int outputFreq = sampleFreq / factor;
+            double low = dopplerFrequencyForSpeed(streamFilterConfig.minSpeedMPH / MPS_TO_MPH);
+            double high = std::min<double>(dopplerFrequencyForSpeed(streamFilterConfig.maxSpeedMPH / MPS_TO_MPH),
+                                   0.45 * outputFreq);
+            streamFilter = std::make_unique<FirDecimator<STREAM_FILTER_TAPS>>(
+                designBandPass(STREAM_FILTER_TAPS, low, high, sampleFreq), factor);
+            streamFreq = outputFreq;
+            Logger::info("Stream filter passing " + std::to_string(low) + "-" + std::to_string(high) +
+                        " Hz, decimated to " + std::to_string(outputFreq) + " Hz");
+        } catch (const std::exception& e) {
+            Logger::error("Stream filter disabled: " + std::string(e.what()));
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(stftMutex);
+        stftEngine.reset();
+        if (speedTracking) {
+            try {
+                std::shared_lock<std::shared_mutex> fftLock(fftw_mutex);
+                stftEngine = std::make_unique<StftEngine>(fftPlans, windowCache, streamFreq,
+                                                          stftConfig, fftPlanFlags);
+            } catch (const std::exception& e) {
+                Logger::error("Speed tracking disabled: " + std::string(e.what()));
+            }
+        }
+    }
+    
+    energyTrigger.reset();
+    if (energyTriggerCallback) {
+        try {
+            energyTrigger = std::make_unique<RadarEnergyTrigger>(streamFreq, energyTriggerConfig);
+            energyTrigger->setCallback([this](const EnergyTriggerEvent& event) {
+                Logger::debug("Radar energy trigger at sample " + std::to_string(event.sample) + 
+                             ", " + std::to_string(event.energyRatio) + "x the noise floor");
+                energyTriggerCallback(event.time);
+            });
+        } catch (const std::exception& e) {
+            Logger::error("Radar trigger disabled: " + std::string(e.what()));
+        }
+    }
+    
+    // Both filters leave no DC offset in what they pass
+    streamCentered = dcFilter || streamFilter;
+    idleNoiseVariance.store(0.0);
+    history = std::make_unique<SampleHistory>(historySamples);
+    sampleStream = std::make_unique<SpscRing<TimedSample>>(DEFAULT_STREAM_QUEUE_SAMPLES);
+    streamOverruns.store(0);
+    pendingTrigger.store(NO_PENDING_TRIGGER);
+    acquisitionFreq = sampleFreq;
+    acquiring.store(true);
+    acquisitionThread = std::thread(&RadarManager::acquisitionLoop, this);
+    processingThread = std::thread(&RadarManager::processingLoop, this);
+    
+    Logger::info("Radar acquisition started: " + std::to_string(history->capacity()) + 
+                " sample history at " + std::to_string(sampleFreq) + " Hz");
+}
+
+void RadarManager::stopAcquisition() {
+    bool wasAcquiring = acquiring.exchange(false);
     
-    // Calculate delay between samples based on sample frequency
-    auto delayMicros = static_cast<unsigned int>(1000000 / sampleFreq);
+    // Wake the processing thread and anyone waiting for samples
+    { std::lock_guard<std::mutex> lock(historyMutex); }
+    historyUpdated.notify_all();
     
-    // Read samples from MCP3008
-    for (int i = 0; i < numSamples; i++) {
-        // MCP3008 communication protocol
-        unsigned char buffer[3];
-        buffer[0] = 0x01;                         // Start bit
-        buffer[1] = 0x80 | (adcChannel << 4);     // Single-ended, channel select
-        buffer[2] = 0x00;                         // Don't care
+    // The threads may also have stopped on their own after an error
+    if (acquisitionThread.joinable()) {
+        acquisitionThread.join();
+    }
+    if (processingThread.joinable()) {
+        processingThread.join();
+    }
+    
+    // The floor belongs to that stream; captures analyzed from now on are
+    // judged on their own noise
+    idleNoiseVariance.store(0.0);
+    
+    if (wasAcquiring) {
+        Logger::info("Radar acquisition stopped");
+    }
+}
+
+void RadarManager::setSpeedTracking(bool enabled, const StftConfig& config) {
+    std::lock_guard<std::mutex> lock(stftMutex);
+    speedTracking = enabled;
+    stftConfig = config;
+}
+
+std::vector<StftFrame> RadarManager::getSpeedTrack(SteadyTime since) const {
+    std::lock_guard<std::mutex> lock(stftMutex);
+    std::vector<StftFrame> frames;
+    if (stftEngine) {
+        for (const StftFrame& frame : stftEngine->track()) {
+            if (frame.time >= since) {
+                frames.push_back(frame);
+            }
+        }
+    }
+    return frames;
+}
+
+void RadarManager::setEnergyTrigger(std::function<void(SteadyTime)> callback,
+                                    const EnergyTriggerConfig& config) {
+    if (isAcquiring()) {
+        Logger::error("Cannot change the radar trigger while acquisition is running");
+        return;
+    }
+    energyTriggerCallback = std::move(callback);
+    energyTriggerConfig = config;
+}
+
+void RadarManager::setStreamFilter(const StreamFilterConfig& config) {
+    if (isAcquiring()) {
+        Logger::error("Cannot change the stream filter while acquisition is running");
+        return;
+    }
+    streamFilterConfig = config;
+}
+
+void RadarManager::setDcBlocker(const DcBlockerConfig& config) {
+    if (isAcquiring()) {
+        Logger::error("Cannot change the DC blocker while acquisition is running");
+        return;
+    }
+    dcBlockerConfig = config;
+}
+
+void RadarManager::setShotTrackerConfig(const ShotTrackerConfig& config) {
+    std::lock_guard<std::mutex> lock(stftMutex);
+    shotTrackerConfig = config;
+}
+
+void RadarManager::setSpeedKalman(const SpeedKalmanConfig& config) {
+    std::lock_guard<std::mutex> lock(stftMutex);
+    speedKalmanConfig = config;
+}
+
+bool RadarManager::isAcquiring() const {
+    return acquiring.load();
+}
+
+uint64_t RadarManager::getStreamOverruns() const {
+    return streamOverruns.load();
+}
+
+void RadarManager::setPreTriggerSamples(int samples) {
+    // The capture always includes the trigger sample itself
+    preTriggerSamples = std::max(0, std::min(samples, DEFAULT_SAMPLE_COUNT - 1));
+}
+
+void RadarManager::setRealtimeConfig(const RealtimeConfig& config) {
+    std::lock_guard<std::mutex> lock(realtimeMutex);
+    realtimeConfig = config;
+}
+
+RealtimeReport RadarManager::getRealtimeReport() const {
+    std::lock_guard<std::mutex> lock(realtimeMutex);
+    return realtimeReport;
+}
+
+void RadarManager::setRealtimeController(std::unique_ptr<RealtimeController> controller) {
+    std::lock_guard<std::mutex> lock(realtimeMutex);
+    realtimeController = std::move(controller);
+}
+
+void RadarManager::acquisitionLoop() {
+    {
+        std::lock_guard<std::mutex> lock(realtimeMutex);
+        if (realtimeConfig.enabled && realtimeController) {
+            realtimeReport = realtimeController->apply(realtimeConfig);
+            if (realtimeReport.fullyApplied()) {
+                Logger::info("Radar acquisition running in real-time mode: " + realtimeReport.summary());
+            } else {
+                Logger::error("Radar acquisition real-time mode only partially applied: " + 
+                             realtimeReport.summary());
+            }
+        }
+    }
+    
+    std::vector<int> raw(ACQUISITION_BLOCK_SIZE);
+    std::vector<int16_t> block(ACQUISITION_BLOCK_SIZE);
+    std::vector<SteadyTime> timestamps(ACQUISITION_BLOCK_SIZE);
+    std::vector<TimedSample> streamBlock(ACQUISITION_BLOCK_SIZE);
+    
+    while (acquiring.load()) {
+        try {
+            readAdc(raw.data(), ACQUISITION_BLOCK_SIZE, acquisitionFreq, timestamps.data());
+            
+            if (dcFilter) {
+                dcFilter->process(raw.data(), ACQUISITION_BLOCK_SIZE, block.data());
+            } else {
+                for (int i = 0; i < ACQUISITION_BLOCK_SIZE; i++) {
+                    block[i] = static_cast<int16_t>(raw[i]);
+                }
+            }
+            for (int i = 0; i < ACQUISITION_BLOCK_SIZE; i++) {
+                streamBlock[i] = {timestamps[i], block[i]};
+            }
+            history->write(block.data(), timestamps.data(), block.size());
+            
+            // Never wait for the processing thread; count what doesn't fit instead
+            size_t pushed = sampleStream->push(streamBlock.data(), streamBlock.size());
+            if (pushed < streamBlock.size()) {
+                streamOverruns.fetch_add(streamBlock.size() - pushed, std::memory_order_relaxed);
+            }
+        } catch (const std::exception& e) {
+            Logger::error("Error in radar acquisition, stopping: " + std::string(e.what()));
+            acquiring.store(false);
+        }
         
-        bcm2835_spi_transfern((char*)buffer, 3);
+        // Taking the lock (briefly) makes sure waiters can't miss the notification
+        { std::lock_guard<std::mutex> lock(historyMutex); }
+        historyUpdated.notify_all();
+    }
+}
+
+void RadarManager::processingLoop() {
+    // Everything is allocated up front and reused for every shot
+    const size_t captureSize = DEFAULT_SAMPLE_COUNT;
+    std::vector<TimedSample> recent(captureSize);  // Last captureSize samples received
+    std::vector<TimedSample> batch(ACQUISITION_BLOCK_SIZE);
+    std::vector<int> samples(captureSize);
+    std::vector<SteadyTime> timestamps(captureSize);
+    
+    uint64_t received = 0;          // Samples received so far
+    bool capturing = false;         // A trigger has been picked up
+    bool triggerFound = false;      // The first sample at or after the trigger has arrived
+    SteadyTime triggerTime;
+    uint64_t captureEnd = 0;        // Value of `received` once the capture is complete
+    uint64_t overrunsAtTrigger = 0;
+    
+    // The noise floor only takes blocks with no shot in them. A shot's tail
+    // runs on after its capture or detection, so the block after either is
+    // held off too. A block is only folded in once the next one has passed
+    // as well, since what comes just before an IR trigger (the club's
+    // approach) isn't known to be a shot until the trigger arrives.
+    uint64_t quietFrom = 0;         // No block starting before this sample measures noise
+    double pendingNoise = 0.0;      // Noise of the last idle block, 0 for none
+    
+    // Captures are taken from the filtered stream. The filter delays it by
+    // half its length; the timestamps are moved back to match.
+    int factor = streamFilter ? streamFilter->factor() : 1;
+    uint64_t preSamples = preTriggerSamples / factor;
+    auto filterDelay = std::chrono::duration_cast<SteadyTime::duration>(std::chrono::duration<double>(
+        streamFilter ? FirDecimator<STREAM_FILTER_TAPS>::groupDelay() / acquisitionFreq : 0.0));
+    
+    // The engine is set up by startAcquisition() and left alone until the next one
+    bool tracking;
+    {
+        std::lock_guard<std::mutex> lock(stftMutex);
+        tracking = stftEngine != nullptr;
+    }
+    
+    auto finishCapture = [&] {
+        capturing = false;
+        quietFrom = received + captureSize;
+        measurement_in_progress.store(false);
+    };
+    
+    // The capture is held in `recent`; unroll it oldest first and measure it
+    auto deliverCapture = [&] {
+        uint64_t first = captureEnd - captureSize;
+        for (size_t j = 0; j < captureSize; j++) {
+            const TimedSample& sample = recent[(first + j) % captureSize];
+            samples[j] = sample.value;
+            timestamps[j] = sample.time;
+        }
+        if (streamOverruns.load() != overrunsAtTrigger) {
+            Logger::error("Samples were dropped during the capture, processing fell behind");
+        } else {
+            measureCapture(samples, timestamps, triggerTime);
+        }
+        finishCapture();
+    };
+    
+    // The trigger sample has been found at this index; work out where the capture ends
+    auto startCapture = [&](uint64_t triggerIndex) {
+        uint64_t oldestHeld = received > captureSize ? received - captureSize : 0;
+        if (triggerIndex < oldestHeld + preSamples) {
+            Logger::error(triggerIndex < preSamples
+                          ? "Not enough acquisition history before the trigger"
+                          : "Pre-trigger samples are no longer available, processing fell behind");
+            finishCapture();
+            return;
+        }
+        triggerFound = true;
+        captureEnd = triggerIndex - preSamples + captureSize;
+    };
+    
+    while (true) {
+        if (!capturing) {
+            int64_t request = pendingTrigger.exchange(NO_PENDING_TRIGGER);
+            if (request != NO_PENDING_TRIGGER) {
+                capturing = true;
+                pendingNoise = 0.0;
+                triggerFound = false;
+                triggerTime = SteadyTime(std::chrono::nanoseconds(request));
+                overrunsAtTrigger = streamOverruns.load();
+                measurement_in_progress.store(true);
+                
+                // The trigger sample may already have been received
+                uint64_t oldestHeld = received > captureSize ? received - captureSize : 0;
+                for (uint64_t i = oldestHeld; capturing && !triggerFound && i < received; i++) {
+                    if (recent[i % captureSize].time >= triggerTime) {
+                        startCapture(i);
+                    }
+                }
+                if (capturing && triggerFound && received >= captureEnd) {
+                    deliverCapture();
+                }
+            }
+        }
+        
+        size_t count = sampleStream->pop(batch.data(), batch.size());
+        if (count == 0) {
+            if (!acquiring.load()) {
+                break;
+            }
+            std::unique_lock<std::mutex> lock(historyMutex);
+            historyUpdated.wait_for(lock, std::chrono::milliseconds(10), [this] {
+                return !sampleStream->empty() || !acquiring.load() ||
+                       pendingTrigger.load() != NO_PENDING_TRIGGER;
+            });
+            continue;
+        }
         
-        // Extract 10-bit result
-        int value = ((buffer[1] & 0x03) << 8) | buffer[2];
-        samples[i] = value;
+        // Filter and decimate in place; the kept samples replace the batch
+        if (streamFilter) {
+            size_t kept = 0;
+            for (size_t i = 0; i < count; i++) {
+                float value;
+                if (streamFilter->push(batch[i].value, value)) {
+                    batch[kept++] = {batch[i].time - filterDelay, static_cast<int16_t>(std::lround(value))};
+                }
+            }
+            count = kept;
+        }
         
-        // Delay for next sample
-        bcm2835_delayMicroseconds(delayMicros);
+        if (tracking) {
+            std::lock_guard<std::mutex> lock(stftMutex);
+            for (size_t i = 0; i < count; i++) {
+                int value = batch[i].value;
+                stftEngine->push(&value, 1, &batch[i].time);
+            }
+        }
+        
+        for (size_t i = 0; i < count; i++) {
+            recent[received % captureSize] = batch[i];
+            received++;
+            
+            // Every capture length of stream with no shot in it measures the noise
+            if (received % captureSize == 0) {
+                double variance = 0.0;
+                bool idle = !capturing && received >= quietFrom + captureSize;
+                if (idle) {
+                    for (size_t j = 0; j < captureSize; j++) {
+                        samples[j] = recent[j].value;
+                    }
+                    idle = measureStreamNoise(samples, variance);
+                }
+                if (idle && pendingNoise > 0.0) {
+                    updateNoiseFloor(pendingNoise);
+                }
+                pendingNoise = idle ? variance : 0.0;
+            }
+            
+            // A detection hands a trigger back to this loop through pendingTrigger
+            if (energyTrigger) {
+                int value = batch[i].value;
+                if (energyTrigger->push(&value, 1, &batch[i].time) > 0) {
+                    pendingNoise = 0.0;
+                    quietFrom = received + captureSize;
+                }
+            }
+            
+            if (!capturing) {
+                continue;
+            }
+            if (!triggerFound && batch[i].time >= triggerTime) {
+                startCapture(received - 1);
+            }
+            if (capturing && triggerFound && received >= captureEnd) {
+                deliverCapture();
+            }
+        }
     }
     
-    return samples;
+    if (capturing) {
+        Logger::error("Radar acquisition stopped while waiting for samples");
+        finishCapture();
+    }
+}
+
+void RadarManager::measureCapture(const std::vector<int>& samples,
+                                  const std::vector<SteadyTime>& timestamps, SteadyTime triggerTime) {
+    try {
+        RadarMeasurement measurement = processTimedSamples(samples, streamFreq, timestamps, triggerTime,
+                                                           streamCentered);
+        if (!measurement.detected) {
+            Logger::info("No target in the radar capture, measurement dropped");
+        } else if (measurementCallback) {
+            measurementCallback(measurement);
+        }
+    } catch (const std::exception& e) {
+        Logger::error("Error in radar measurement: " + std::string(e.what()));
+    }
+}
+
+bool RadarManager::captureWindow(SteadyTime triggerTime, std::chrono::milliseconds before,
+                                 std::chrono::milliseconds after, SampleWindow& window,
+                                 std::chrono::milliseconds timeout) {
+    int preSamples = static_cast<int>(before.count() * acquisitionFreq / 1000);
+    int postSamples = static_cast<int>(after.count() * acquisitionFreq / 1000);
+    return captureSamples(triggerTime, preSamples, postSamples, window, timeout);
 }
 
+bool RadarManager::captureSamples(SteadyTime triggerTime, int preSamples, int postSamples,
+                                  SampleWindow& window, std::chrono::milliseconds timeout) {
+    if (!acquiring.load() || !history) {
+        Logger::error("Cannot capture window: radar acquisition not running");
+        return false;
+    }
+    
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock<std::mutex> lock(historyMutex);
+    
+    while (acquiring.load()) {
+        uint64_t written = history->totalWritten();
+        uint64_t triggerIndex = 0;
+        
+        if (history->indexForTime(triggerTime, triggerIndex)) {
+            if (triggerIndex < static_cast<uint64_t>(preSamples)) {
+                Logger::error("Not enough acquisition history before the trigger");
+                return false;
+            }
+            uint64_t start = triggerIndex - preSamples;
+            if (history->window(start, preSamples + postSamples, window)) {
+                return true;
+            }
+            if (start < history->oldestIndex()) {
+                Logger::error("Pre-trigger samples are no longer in the acquisition history");
+                return false;
+            }
+        } else if (written > 0 && history->timeOfIndex(history->oldestIndex()) > triggerTime) {
+            Logger::error("Trigger time is older than the acquisition history");
+            return false;
+        }
+        
+        // Wait for more samples
+        if (historyUpdated.wait_until(lock, deadline) == std::cv_status::timeout) {
+            break;
+        }
+    }
+    
+    Logger::error(acquiring.load() ? "Timed out waiting for post-trigger samples"
+                                   : "Radar acquisition stopped while waiting for samples");
+    return false;
+}
 
 void RadarManager::startDebugMeasurement() {
     Logger::debug("Starting DEBUG radar measurement with synthetic data");
     
     try {
-        // Generate synthetic samples - a sine wave
-        std::vector<int> samples(DEFAULT_SAMPLE_COUNT);
-        
         // Use a realistic Doppler frequency for a golf ball (85-100 mph)
         // For an HB100 radar (10.525 GHz), a 100 mph golf ball should produce
         // a Doppler shift of approximately 3130 Hz
-        float speedMPH = 85.0f;
-        float speedMPS = speedMPH / 2.23694f; // Convert mph to m/s
-        
-        // Calculate Doppler frequency using radar equation
-        // f_doppler = 2 * v * f_radar / c
-        float dopplerFreq = (2.0f * speedMPS * RADAR_FREQ) / SPEED_OF_LIGHT;
+        SyntheticSignal signal;
+        signal.ballSpeedMPH = 85.0f;
+        signal.ballAmplitude = 400.0f;
+        signal.noiseAmplitude = 12.0f;
+        signal.seed = static_cast<unsigned>(rand());
+        float speedMPH = signal.ballSpeedMPH;
         
         Logger::debug("Debug setup: Speed=" + std::to_string(speedMPH) + 
-                     " mph, Expected Doppler frequency=" + std::to_string(dopplerFreq) + " Hz");
+                     " mph, Expected Doppler frequency=" + 
+                     std::to_string(dopplerFrequencyForSpeed(speedMPH / MPS_TO_MPH)) + " Hz");
         
-        // Generate a sine wave at the Doppler frequency, scaled to ADC range (0-1023)
-        for (int i = 0; i < DEFAULT_SAMPLE_COUNT; i++) {
-            float t = static_cast<float>(i) / DEFAULT_SAMPLE_FREQ;
-            // Base signal (DC offset + sine wave)
-            float value = 512 + 400 * sin(2 * M_PI * dopplerFreq * t);
-            
-            // Add some noise
-            value += (rand() % 40) - 20;
-            
-            // Clamp to ADC range
-            if (value < 0) value = 0;
-            if (value > 1023) value = 1023;
-            
-            samples[i] = static_cast<int>(value);
-        }
+        // Generate a sine wave at the Doppler frequency with some noise
+        SyntheticSampleSource source(signal, DEFAULT_SAMPLE_FREQ);
+        std::vector<int> samples(DEFAULT_SAMPLE_COUNT);
+        source.read(samples.data(), samples.size());
         
         Logger::debug("Created synthetic samples with " + std::to_string(samples.size()) + 
                      " points at " + std::to_string(DEFAULT_SAMPLE_FREQ) + " Hz");
@@ -215,115 +772,608 @@ float RadarManager::frequencyToSpeed(float frequency) {
     return (SPEED_OF_LIGHT * frequency) / (2.0 * RADAR_FREQ);
 }
 
+void RadarManager::setJitterThreshold(double fraction) {
+    jitterThreshold = fraction;
+}
+
+void RadarManager::setWindow(WindowType type, double beta) {
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+    windowType = type;
+    kaiserBeta = beta;
+}
+
+WindowType RadarManager::getWindow() const {
+    std::shared_lock<std::shared_mutex> lock(fftw_mutex);
+    return windowType;
+}
+
+bool RadarManager::setFftBackend(FftBackend backend) {
+    if (isAcquiring()) {
+        Logger::error("Cannot change the FFT backend while acquisition is running");
+        return false;
+    }
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+    if (!fftBackendAvailable(backend)) {
+        Logger::error(std::string("No ") + fftBackendName(backend) + " FFT in this build");
+        return false;
+    }
+    // Everything holding a plan goes with the old backend's plans
+    {
+        std::lock_guard<std::mutex> stftLock(stftMutex);
+        stftEngine.reset();
+    }
+    zoomTransforms.clear();
+    captureStftEngines.clear();
+    fftPlans.setBackend(backend);
+    Logger::info(std::string("Using the ") + fftBackendName(backend) + " FFT");
+    return true;
+}
+
+FftBackend RadarManager::getFftBackend() const {
+    std::shared_lock<std::shared_mutex> lock(fftw_mutex);
+    return fftPlans.backend();
+}
+
+void RadarManager::setFftPrecision(FftPrecision precision) {
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+    fftPrecision = precision;
+}
+
+FftPrecision RadarManager::getFftPrecision() const {
+    std::shared_lock<std::shared_mutex> lock(fftw_mutex);
+    return fftPrecision;
+}
+
+void RadarManager::setPeakEstimator(PeakEstimator estimator, int padFactor) {
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+    peakEstimator = estimator;
+    zeroPadFactor = std::max(2, padFactor);
+}
+
+PeakEstimator RadarManager::getPeakEstimator() const {
+    std::shared_lock<std::shared_mutex> lock(fftw_mutex);
+    return peakEstimator;
+}
+
+void RadarManager::setCfar(const CfarConfig& config) {
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+    cfarConfig = config;
+}
+
+CfarConfig RadarManager::getCfar() const {
+    std::shared_lock<std::shared_mutex> lock(fftw_mutex);
+    return cfarConfig;
+}
+
+void RadarManager::setMinimumQuality(double snrDB, double confidence) {
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+    minSnrDB = snrDB;
+    minConfidence = confidence;
+}
+
+double RadarManager::getNoiseFloor() const {
+    return std::sqrt(idleNoiseVariance.load());
+}
+
+bool RadarManager::measureStreamNoise(const std::vector<int>& samples, double& variance) {
+    std::shared_lock<std::shared_mutex> lock(fftw_mutex);
+    FftPlan* plan = nullptr;
+    if (fftw_initialized) {
+        plan = fftPlans.get({static_cast<int>(samples.size()), FftDirection::RealToComplex,
+                             fftPrecision, fftPlanFlags});
+    }
+    if (!plan) {
+        return false;
+    }
+    return plan->key().precision == FftPrecision::Single ? captureNoiseVariance<float>(samples, *plan, variance)
+                                                         : captureNoiseVariance<double>(samples, *plan, variance);
+}
+
+void RadarManager::updateNoiseFloor(double variance) {
+    // Only the processing thread writes, so load and store don't race
+    double floor = idleNoiseVariance.load();
+    idleNoiseVariance.store(floor > 0.0 ? floor + NOISE_FLOOR_DECAY * (variance - floor) : variance);
+}
+
+template <typename Real>
+bool RadarManager::captureNoiseVariance(const std::vector<int>& samples, FftPlan& plan, double& variance) {
+    static thread_local FftWorkspace workspace;
+    Real* fftIn = workspace.input<Real>(plan);
+    Real* fftOut = workspace.output<Real>(plan);
+    const Real* window = windowTable<Real>(samples.size());
+    windowSamples(samples.data(), samples.size(), window, fftIn);
+    plan.execute(fftIn, fftOut);
+    
+    static thread_local AlignedVector<Real> powers;
+    size_t bins = samples.size() / 2 + 1;
+    powers.resize(std::max(powers.size(), bins));
+    computePowers(fftOut, bins, powers.data());
+    
+    // A return the trigger missed would pass for noise, the same test as a capture
+    if (cfarConfig.enabled) {
+        static thread_local AlignedVector<Real> thresholds;
+        thresholds.resize(std::max(thresholds.size(), bins));
+        cfarThresholds(powers.data(), bins, cfarConfig, thresholds.data());
+        for (size_t i = 1; i < samples.size() / 2; i++) {
+            if (powers[i] > thresholds[i]) {
+                return false;
+            }
+        }
+    }
+    
+    // Noise power per bin is the variance times the window's power
+    double windowPower = 0.0;
+    for (size_t i = 0; i < samples.size(); i++) {
+        windowPower += static_cast<double>(window[i]) * window[i];
+    }
+    variance = windowPower > 0.0 ? noisePower(powers.data(), bins) / windowPower : 0.0;
+    return variance > 0.0;
+}
+
+void RadarManager::setZoom(const ZoomConfig& config) {
+    std::lock_guard<std::shared_mutex> lock(fftw_mutex);
+    zoomConfig = config;
+}
+
+ZoomConfig RadarManager::getZoom() const {
+    std::shared_lock<std::shared_mutex> lock(fftw_mutex);
+    return zoomConfig;
+}
+
+template <typename Real>
+bool RadarManager::zoomPeak(const Real* windowed, size_t size, double sampleFreq, int peak, double& offset,
+                            double& spacing) {
+    if (!zoomConfig.enabled) {
+        return false;
+    }
+    
+    // The band in whole bins, so one transform serves every capture of this
+    // length whatever its measured sample rate
+    double binWidth = sampleFreq / size;
+    int firstBin = std::max(1, static_cast<int>(std::floor(
+        dopplerFrequencyForSpeed(zoomConfig.minSpeedMPH / MPS_TO_MPH) / binWidth)));
+    int lastBin = std::min(static_cast<int>(size / 2), static_cast<int>(std::ceil(
+        dopplerFrequencyForSpeed(zoomConfig.maxSpeedMPH / MPS_TO_MPH) / binWidth)));
+    if (peak <= firstBin || peak >= lastBin) {
+        return false;
+    }
+    
+    const ChirpZ* zoom = nullptr;
+    try {
+        zoom = &zoomTransforms.get(fftPlans, size, firstBin, lastBin, std::max(2, zoomConfig.points), fftPlanFlags);
+    } catch (const std::exception& e) {
+        Logger::error("Zoom spectrum unavailable: " + std::string(e.what()));
+        return false;
+    }
+    static thread_local std::vector<double> zoomPowers;
+    zoomPowers.resize(zoom->points());
+    zoom->powers(windowed, zoomPowers.data());
+    
+    // Strongest point within a bin of the coarse peak, then between points
+    int first = std::max(0, static_cast<int>(std::ceil((peak - 1 - firstBin) / zoom->spacing())));
+    int last = std::min(static_cast<int>(zoom->points()) - 1,
+                        static_cast<int>(std::floor((peak + 1 - firstBin) / zoom->spacing())));
+    int best = first;
+    for (int k = first; k <= last; k++) {
+        if (zoomPowers[k] > zoomPowers[best]) {
+            best = k;
+        }
+    }
+    double fine = 0.0;
+    if (best > 0 && best + 1 < static_cast<int>(zoom->points())) {
+        fine = parabolicPeakOffset(zoomPowers[best - 1], zoomPowers[best], zoomPowers[best + 1]);
+    }
+    offset = zoom->bin(best + fine) - peak;
+    spacing = zoom->spacing();
+    return true;
+}
+
+template <typename Real, typename Sample>
+double RadarManager::refinePeak(Capture<Sample> samples, double mean, const Real* windowed, const Real* powers,
+                                int peak) {
+    size_t size = samples.size();
+    if (peak < 1 || static_cast<size_t>(peak + 1) > size / 2) {
+        return 0.0;
+    }
+    
+    switch (peakEstimator) {
+        case PeakEstimator::None:
+            return 0.0;
+            
+        case PeakEstimator::Parabolic:
+            // The log-parabola fit comes out the same on powers as on magnitudes
+            return parabolicPeakOffset(powers[peak - 1], powers[peak], powers[peak + 1]);
+            
+        case PeakEstimator::Jacobsen:
+        case PeakEstimator::Quinn: {
+            // These assume a rectangular window, so evaluate the three bins on
+            // the raw capture; three Goertzel passes cost less than another FFT
+            std::complex<double> bins[3];
+            for (int i = 0; i < 3; i++) {
+                bins[i] = goertzel(samples.data(), size, mean, peak - 1 + i);
+            }
+            return peakEstimator == PeakEstimator::Jacobsen ? jacobsenPeakOffset(bins) : quinnPeakOffset(bins);
+        }
+            
+        case PeakEstimator::ZeroPadded: {
+            FftPlan* plan = fftPlans.get({static_cast<int>(size) * zeroPadFactor, FftDirection::RealToComplex,
+                                          std::is_same<Real, float>::value ? FftPrecision::Single : FftPrecision::Double,
+                                          fftPlanFlags});
+            if (!plan) {
+                return parabolicPeakOffset(powers[peak - 1], powers[peak], powers[peak + 1]);
+            }
+            static thread_local FftWorkspace workspace;
+            Real* in = workspace.input<Real>(*plan);
+            Real* out = workspace.output<Real>(*plan);
+            std::copy(windowed, windowed + size, in);
+            std::fill(in + size, in + plan->size(), Real(0));
+            plan->execute(in, out);
+            
+            // Search the fine bins within one coarse bin of the peak
+            auto fineMagnitude = [out](int bin) {
+                return std::hypot(static_cast<double>(out[2 * bin]), static_cast<double>(out[2 * bin + 1]));
+            };
+            int center = peak * zeroPadFactor;
+            int best = center;
+            for (int bin = center - zeroPadFactor + 1; bin < center + zeroPadFactor; bin++) {
+                if (fineMagnitude(bin) > fineMagnitude(best)) {
+                    best = bin;
+                }
+            }
+            double fineOffset = parabolicPeakOffset(fineMagnitude(best - 1), fineMagnitude(best),
+                                                    fineMagnitude(best + 1));
+            return (best + fineOffset) / zeroPadFactor - peak;
+        }
+    }
+    return 0.0;
+}
+
+template <>
+const double* RadarManager::windowTable<double>(size_t size) {
+    return windowCache.get(windowType, size, kaiserBeta).data();
+}
+
+template <>
+const float* RadarManager::windowTable<float>(size_t size) {
+    return windowCache.getSingle(windowType, size, kaiserBeta).data();
+}
+
 RadarMeasurement RadarManager::processSamples(const std::vector<int>& samples, int sampleFreq) {
+    return processCapture(Capture<int>{samples.data(), samples.size()}, sampleFreq);
+}
+
+RadarMeasurement RadarManager::processSamples(SampleSpan samples, int sampleFreq) {
+    return processCapture(Capture<int16_t>{samples.data, samples.size}, sampleFreq);
+}
+
+RadarMeasurement RadarManager::processSamples(const SampleWindow& window, int sampleFreq) {
+    if (window.second.size == 0) {
+        return processSamples(window.first, sampleFreq);
+    }
+    static thread_local std::vector<int16_t> joined;
+    joined.assign(window.first.data, window.first.data + window.first.size);
+    joined.insert(joined.end(), window.second.data, window.second.data + window.second.size);
+    return processCapture(Capture<int16_t>{joined.data(), joined.size()}, sampleFreq);
+}
+
+std::vector<RadarMeasurement> RadarManager::processBatch(const std::vector<std::vector<int>>& captures,
+                                                       int sampleFreq, size_t threads) {
+    return runBatch(captures.size(), threads, [&](size_t i) {
+        return processSamples(captures[i], sampleFreq);
+    });
+}
+
+std::vector<RadarMeasurement> RadarManager::processCaptureDirectory(const std::string& directory,
+                                                                    std::vector<std::string>* files,
+                                                                    size_t threads) {
+    std::vector<std::string> paths = listCaptureFiles(directory);
+    Logger::info("Analyzing " + std::to_string(paths.size()) + " captures in " + directory);
+    std::vector<RadarMeasurement> results = runBatch(paths.size(), threads, [&](size_t i) {
+        FileSampleSource source(paths[i], 0.0);
+        std::vector<int> samples(source.totalSamples());
+        samples.resize(source.read(samples.data(), samples.size()));
+        if (samples.empty()) {
+            throw std::runtime_error("no samples in " + paths[i]);
+        }
+        return processSamples(samples, source.sampleRate());
+    });
+    if (files) {
+        *files = std::move(paths);
+    }
+    return results;
+}
+
+std::vector<RadarMeasurement> RadarManager::runBatch(size_t count, size_t threads,
+                                                     const std::function<RadarMeasurement(size_t)>& measure) {
+    std::vector<RadarMeasurement> results(count);
+    if (count == 0) {
+        return results;
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    ThreadPool pool(std::min(threads, count));
+    pool.parallelFor(count, [&](size_t i) {
+        try {
+            results[i] = measure(i);
+        } catch (const std::exception& e) {
+            Logger::error("Error in radar measurement " + std::to_string(i) + " of the batch: " + e.what());
+            results[i] = RadarMeasurement{};
+            results[i].detected = false;
+        }
+    });
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    size_t detected = std::count_if(results.begin(), results.end(),
+                                    [](const RadarMeasurement& result) { return result.detected; });
+    Logger::info("Analyzed " + std::to_string(count) + " captures (" + std::to_string(detected) +
+                 " detected) on " + std::to_string(pool.size()) + " threads in " + std::to_string(elapsed) +
+                 " ms, " + std::to_string(pool.stolenTasks()) + " stolen between threads");
+    return results;
+}
+
+RadarMeasurement RadarManager::processSamples(const std::vector<int>& samples, int sampleFreq,
+                                              const std::vector<SteadyTime>& timestamps,
+                                              SteadyTime impactTime) {
+    return processTimedSamples(samples, sampleFreq, timestamps, impactTime, false);
+}
+
+RadarMeasurement RadarManager::processTimedSamples(const std::vector<int>& samples, int sampleFreq,
+                                                   const std::vector<SteadyTime>& timestamps,
+                                                   SteadyTime impactTime, bool centered) {
+    SampleTiming timing = analyzeSampleTiming(timestamps);
+    if (timestamps.size() != samples.size() || timing.effectiveRate <= 0.0) {
+        Logger::debug("No usable sample timestamps, assuming " + std::to_string(sampleFreq) + " Hz");
+        return processCapture(Capture<int>{samples.data(), samples.size(), centered}, sampleFreq);
+    }
+    
+    Logger::debug("Measured sample rate " + std::to_string(timing.effectiveRate) + 
+                 " Hz (nominal " + std::to_string(sampleFreq) + " Hz), jitter " + 
+                 std::to_string(timing.jitterRmsMicros) + " us RMS, " + 
+                 std::to_string(timing.jitterMaxMicros) + " us max");
+    
+    // Where the impact falls in the capture, in samples from the first
+    double impactSample = -1.0;
+    if (impactTime != SteadyTime()) {
+        impactSample = std::chrono::duration<double>(impactTime - timestamps.front()).count() * timing.effectiveRate;
+    }
+    
+    // Put samples back on a uniform grid when the spacing is too irregular
+    // for the FFT to be trusted
+    double periodMicros = 1e6 / timing.effectiveRate;
+    RadarMeasurement result;
+    if (timing.jitterRmsMicros > jitterThreshold * periodMicros) {
+        std::vector<int> resampled;
+        resampleUniform(samples, timestamps, resampled);
+        timing.resampled = true;
+        Logger::debug("Jitter above threshold, resampled capture to a uniform grid");
+        result = processCapture(Capture<int>{resampled.data(), resampled.size(), centered},
+                                timing.effectiveRate, impactSample);
+    } else {
+        result = processCapture(Capture<int>{samples.data(), samples.size(), centered}, timing.effectiveRate,
+                                impactSample);
+    }
+    
+    result.timing = timing;
+    return result;
+}
+
+template <typename Sample>
+RadarMeasurement RadarManager::processCapture(Capture<Sample> samples, double sampleFreq, double impactSample) {
     Logger::debug("Processing " + std::to_string(samples.size()) + " samples with diagnostics");
     
     RadarMeasurement result;
     result.timestamp = std::chrono::steady_clock::now();
     
-    // Check if we have the correct number of samples for our pre-allocated FFTW plan
-    if (samples.size() != DEFAULT_SAMPLE_COUNT) {
-        Logger::debug("Sample count mismatch, expected " + std::to_string(DEFAULT_SAMPLE_COUNT) + 
-                       " but got " + std::to_string(samples.size()));
-        // Use a simple calculation for this case
+    // Too short to say anything about the spectrum
+    if (samples.size() < MIN_SAMPLE_COUNT) {
+        Logger::debug("Too few samples for a measurement: " + std::to_string(samples.size()));
         result.speedMPS = 0.0;
         result.speedMPH = 0.0;
         result.signalStrength = 0.0;
+        result.detected = false;
         return result;
     }
     
-    // Use mutex to ensure thread safety
-    std::lock_guard<std::mutex> lock(fftw_mutex);
+    // Shared: any number of captures can be analyzed at once, each thread
+    // with its own FFT buffers. Only cleanup and setting changes wait.
+    std::shared_lock<std::shared_mutex> lock(fftw_mutex);
     
-    // Check if FFTW is still initialized
-    if (!fftw_initialized || !fftw_in || !fftw_out || !fftw_plan_r2c) {
+    // Get the plan for this capture length
+    FftPlan* plan = nullptr;
+    if (fftw_initialized) {
+        plan = fftPlans.get({static_cast<int>(samples.size()), FftDirection::RealToComplex,
+                             fftPrecision, fftPlanFlags});
+    }
+    if (!plan) {
         Logger::error("FFTW resources not available");
         result.speedMPS = 0.0;
         result.speedMPH = 0.0;
         result.signalStrength = 0.0;
+        result.detected = false;
         return result;
     }
+    // Window, transform and take magnitudes in the plan's precision
+    if (plan->key().precision == FftPrecision::Single) {
+        result = analyzeCapture<float>(samples, sampleFreq, *plan);
+    } else {
+        result = analyzeCapture<double>(samples, sampleFreq, *plan);
+    }
     
-    // Calculate and log the DC offset
-    double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
-    Logger::debug("DC offset (mean): " + std::to_string(mean));
+    LaunchSpeed launch;
+    ShotSpeeds shot = trackCaptureShot(samples, sampleFreq, impactSample, launch);
+    result.clubSpeedMPH = shot.clubSpeedMPH;
+    result.ballSpeedMPH = shot.ballSpeedMPH;
+    result.smashFactor = shot.smashFactor;
+    result.launchSpeedMPH = launch.speedMPH;
+    result.launchSpeedUncertaintyMPH = launch.uncertaintyMPH;
+    result.ballDecelerationMPHPerS = launch.decelerationMPHPerS;
+    return result;
+}
+
+template <typename Sample>
+ShotSpeeds RadarManager::trackCaptureShot(Capture<Sample> samples, double sampleFreq, double impactSample,
+                                          LaunchSpeed& launch) {
+    StftConfig config;
+    ShotTrackerConfig trackerConfig;
+    SpeedKalmanConfig kalmanConfig;
+    {
+        std::lock_guard<std::mutex> lock(stftMutex);
+        config = stftConfig;
+        trackerConfig = shotTrackerConfig;
+        kalmanConfig = speedKalmanConfig;
+    }
+    if (samples.size() < static_cast<size_t>(config.frameSize)) {
+        return ShotSpeeds();
+    }
     
-    // Convert integer samples to double and remove DC offset
-    for (size_t i = 0; i < samples.size(); i++) {
-        fftw_in[i] = static_cast<double>(samples[i]) - mean;
+    // A handful of small transforms over the capture just analyzed, on an
+    // engine (and frame list) left over from earlier captures
+    static thread_local std::vector<StftFrame> frames;
+    try {
+        std::unique_ptr<StftEngine> engine = captureStftEngines.take(fftPlans, windowCache, sampleFreq, config,
+                                                                     fftPlanFlags);
+        engine->push(samples.data(), samples.size());
+        frames.assign(engine->track().begin(), engine->track().end());
+        captureStftEngines.give(std::move(engine), sampleFreq, fftPlanFlags);
+    } catch (const std::exception& e) {
+        Logger::error("Shot tracking failed: " + std::string(e.what()));
+        return ShotSpeeds();
     }
     
-    // Apply a window function (Hamming window) to reduce spectral leakage
-    for (size_t i = 0; i < samples.size(); i++) {
-        double windowCoeff = 0.54 - 0.46 * cos(2.0 * M_PI * i / (samples.size() - 1));
-        fftw_in[i] *= windowCoeff;
+    ShotSpeeds shot = trackShot(frames, trackerConfig);
+    Logger::debug("Shot over " + std::to_string(frames.size()) + " frames: club " + 
+                 std::to_string(shot.clubSpeedMPH) + " mph, ball " + std::to_string(shot.ballSpeedMPH) + 
+                 " mph in " + std::to_string(shot.ballFrames) + " frames, smash factor " + 
+                 std::to_string(shot.smashFactor));
+    
+    if (kalmanConfig.enabled && shot.ballSpeedMPH > 0.0f) {
+        // Without a trigger time, impact is where the tracker first saw the ball
+        double impact = impactSample >= 0.0 ? impactSample : static_cast<double>(shot.impactSample);
+        launch = estimateLaunchSpeed(frames, sampleFreq, config.frameSize, shot.ballSpeedMPH, impact, kalmanConfig);
+        Logger::debug("Launch speed " + std::to_string(launch.speedMPH) + " +/- " +
+                     std::to_string(launch.uncertaintyMPH) + " mph at sample " + std::to_string(impact) +
+                     " from " + std::to_string(launch.frames) + " frames, decelerating " +
+                     std::to_string(launch.decelerationMPHPerS) + " mph/s");
     }
+    return shot;
+}
+
+template <typename Real, typename Sample>
+RadarMeasurement RadarManager::analyzeCapture(Capture<Sample> samples, double sampleFreq, FftPlan& plan) {
+    RadarMeasurement result;
+    result.timestamp = std::chrono::steady_clock::now();
+    
+    // The plan is shared; the arrays it runs on belong to this thread
+    static thread_local FftWorkspace workspace;
+    Real* fftIn = workspace.input<Real>(plan);
+    Real* fftOut = workspace.output<Real>(plan);
+    
+    // Remove the DC offset and apply the window function to reduce spectral leakage
+    // 16-bit samples are windowed in fixed point; centered captures only need the window
+    Real mean = 0;
+    if constexpr (std::is_same<Sample, int16_t>::value) {
+        mean = windowSamples(samples.data(), samples.size(),
+                             windowCache.getFixed(windowType, samples.size(), kaiserBeta).data(), fftIn);
+    } else {
+        if (samples.centered) {
+            applyWindow(samples.data(), samples.size(), windowTable<Real>(samples.size()), fftIn);
+        } else {
+            mean = windowSamples(samples.data(), samples.size(), windowTable<Real>(samples.size()), fftIn);
+        }
+    }
+    Logger::debug(samples.centered ? std::string("Capture centered upstream")
+                                   : "DC offset (mean): " + std::to_string(mean));
     
     // Perform FFT using FFTW
-    fftw_execute(fftw_plan_r2c);
+    plan.execute(fftIn, fftOut);
     
-    // Find dominant frequency and log all significant peaks
-    double maxMagnitude = 0.0;
-    int maxIndex = 0;
-    Logger::debug("Significant frequency components:");
+    // Power of every bin in one vectorizable pass; square roots are only
+    // taken for the few bins that get reported. Each thread keeps its own
+    // buffer, sized for the longest capture it has seen.
+    static thread_local AlignedVector<Real> powers;
+    size_t bins = samples.size() / 2 + 1;
+    if (powers.size() < bins) {
+        powers.resize(bins);
+    }
+    computePowers(fftOut, bins, powers.data());
     
     // Calculate frequency resolution
-    double freqResolution = static_cast<double>(sampleFreq) / samples.size();
+    double freqResolution = sampleFreq / samples.size();
     Logger::debug("Frequency resolution: " + std::to_string(freqResolution) + " Hz per bin");
     
-    // Find the top 5 peaks
-    struct Peak {
-        int index;
-        double frequency;
-        double magnitude;
-        double speed;
-    };
-    std::vector<Peak> peaks;
+    // Find the top 5 bins, starting from index 1 to ignore DC (0 Hz)
+    constexpr size_t TOP_PEAKS = 5;
+    TopBins<Real, TOP_PEAKS> top;
+    top.scan(powers.data(), 1, samples.size() / 2);
+    SpectralBin<Real> peaks[TOP_PEAKS];
+    size_t peakCount = top.sorted(peaks);
     
-    // Start from index 1 to ignore DC component (0 Hz)
-    for (size_t i = 1; i < samples.size() / 2; i++) {
-        double real = fftw_out[i][0];
-        double imag = fftw_out[i][1];
-        double magnitude = sqrt(real*real + imag*imag);
-        
-        // Track highest peak
-        if (magnitude > maxMagnitude) {
-            maxMagnitude = magnitude;
-            maxIndex = i;
+    // Log all significant peaks
+    Logger::debug("Significant frequency components:");
+    for (size_t i = 0; i < peakCount; i++) {
+        double freq = peaks[i].index * freqResolution;
+        Logger::debug("Peak at bin " + std::to_string(peaks[i].index) + 
+                     ": " + std::to_string(freq) + " Hz, magnitude " + 
+                     std::to_string(std::sqrt(static_cast<double>(peaks[i].value))) + ", equals " + 
+                     std::to_string(frequencyToSpeed(freq) * MPS_TO_MPH) + " mph");
+    }
+    
+    // The dominant frequency is the strongest bin
+    int maxIndex = peakCount > 0 ? peaks[0].index : 0;
+    double maxPower = peakCount > 0 ? peaks[0].value : 0.0;
+    
+    // Only accept a bin that stands out of the noise around it, so hum or
+    // broadband noise from the bay isn't reported as a shot. The strongest
+    // detected bin wins.
+    if (cfarConfig.enabled) {
+        static thread_local AlignedVector<Real> thresholds;
+        if (thresholds.size() < bins) {
+            thresholds.resize(bins);
         }
-        
-        // Track all significant peaks (>10% of max)
-        if (peaks.size() < 5 || magnitude > peaks.back().magnitude) {
-            double freq = i * freqResolution;
-            double speed = frequencyToSpeed(freq) * 2.23694; // mph
-            
-            // Insert in sorted order
-            Peak peak = {static_cast<int>(i), freq, magnitude, speed};
-            peaks.push_back(peak);
-            
-            // Sort by magnitude (largest first)
-            std::sort(peaks.begin(), peaks.end(), 
-                [](const Peak& a, const Peak& b) { return a.magnitude > b.magnitude; });
-            
-            // Keep only top 5
-            if (peaks.size() > 5) {
-                peaks.pop_back();
+        cfarThresholds(powers.data(), bins, cfarConfig, thresholds.data());
+        int detectedIndex = 0;
+        Real detectedPower = 0;
+        for (size_t i = 1; i < samples.size() / 2; i++) {
+            if (powers[i] > thresholds[i] && powers[i] > detectedPower) {
+                detectedIndex = static_cast<int>(i);
+                detectedPower = powers[i];
             }
         }
+        if (detectedIndex > 0) {
+            maxIndex = detectedIndex;
+            maxPower = detectedPower;
+        } else {
+            Logger::debug("No CFAR detection, strongest bin " + std::to_string(maxIndex) + " is " +
+                         std::to_string(maxIndex > 0 ? powers[maxIndex] / thresholds[maxIndex] : 0.0) +
+                         " of its threshold");
+            result.detected = false;
+        }
     }
     
-    // Log all significant peaks
-    for (const auto& peak : peaks) {
-        Logger::debug("Peak at bin " + std::to_string(peak.index) + 
-                     ": " + std::to_string(peak.frequency) + " Hz, magnitude " + 
-                     std::to_string(peak.magnitude) + ", equals " + 
-                     std::to_string(peak.speed) + " mph");
+    // Locate the highest peak between bins and estimate how well that worked.
+    // Inside the zoom band the chirp-z spectrum does it, with the accuracy of
+    // zero-padding to its point spacing.
+    double offset = 0.0;
+    double zoomSpacing = 0.0;
+    bool zoomed = maxIndex > 0 && zoomPeak<Real>(fftIn, samples.size(), sampleFreq, maxIndex, offset, zoomSpacing);
+    if (!zoomed && maxIndex > 0) {
+        offset = refinePeak<Real>(samples, mean, fftIn, powers.data(), maxIndex);
     }
-    
-    // Convert highest peak to speed 
-    double dominantFreq = maxIndex * freqResolution;
-    Logger::debug("Dominant frequency: " + std::to_string(dominantFreq) + 
-                 " Hz at bin " + std::to_string(maxIndex));
+    double dominantFreq = (maxIndex + offset) * freqResolution;
+    int padFactor = zoomed ? static_cast<int>(std::lround(1.0 / zoomSpacing)) : zeroPadFactor;
+    double uncertaintyBins = peakUncertaintyBins(zoomed ? PeakEstimator::ZeroPadded : peakEstimator,
+                                                 peakPowerToNoise(powers.data(), bins, maxPower), padFactor);
+    result.dopplerFrequency = dominantFreq;
+    result.frequencyUncertainty = uncertaintyBins * freqResolution;
+    result.speedUncertaintyMPH = frequencyToSpeed(result.frequencyUncertainty) * MPS_TO_MPH;
+    Logger::debug("Dominant frequency: " + std::to_string(dominantFreq) + " Hz +/- " + 
+                 std::to_string(result.frequencyUncertainty) + " Hz at bin " + std::to_string(maxIndex) + 
+                 " (" + (zoomed ? std::string("chirp-z") : peakEstimatorName(peakEstimator)) + " offset " +
+                 std::to_string(offset) + ")");
     
     // Convert frequency to speed using Doppler equation
     result.speedMPS = frequencyToSpeed(dominantFreq);
@@ -334,13 +1384,33 @@ RadarMeasurement RadarManager::processSamples(const std::vector<int>& samples, i
                  " m/s → " + std::to_string(result.speedMPH) + " mph");
     
     // Set signal strength (magnitude of the dominant frequency component)
-    result.signalStrength = maxMagnitude;
+    result.signalStrength = std::sqrt(maxPower);
+    
+    // Compare the peak with the noise per bin: the idle stream's while
+    // acquisition is running and it has been measured, this capture's
+    // otherwise. Scaling by the window's sums
+    // makes the SNR a per-sample ratio, whatever the window and length.
+    const Real* window = windowTable<Real>(samples.size());
+    double windowSum = 0.0;
+    double windowPower = 0.0;
+    for (size_t i = 0; i < samples.size(); i++) {
+        windowSum += window[i];
+        windowPower += static_cast<double>(window[i]) * window[i];
+    }
+    double idleVariance = idleNoiseVariance.load();
+    double noise = idleVariance > 0.0 ? idleVariance * windowPower : noisePower(powers.data(), bins);
+    double ratio = noise > 0.0 ? maxPower / noise : 0.0;
+    result.noiseFloor = windowPower > 0.0 ? std::sqrt(noise / windowPower) : 0.0;
+    result.snrDB = ratio > 0.0 ? 10.0 * std::log10(2.0 * ratio * windowPower / (windowSum * windowSum)) : -INFINITY;
+    result.confidence = peakConfidence(ratio, bins - 2);
+    Logger::debug("Noise floor " + std::to_string(result.noiseFloor) + " counts RMS" +
+                 (idleVariance > 0.0 ? " (idle stream)" : "") + ", SNR " + std::to_string(result.snrDB) +
+                 " dB, confidence " + std::to_string(result.confidence));
+    if (result.detected && (result.snrDB < minSnrDB || result.confidence < minConfidence)) {
+        Logger::debug("Return too weak, rejected");
+        result.detected = false;
+    }
     
     return result;
 }
 
-// Initialize static members
-bool RadarManager::fftw_initialized = false;
-double* RadarManager::fftw_in = nullptr;
-fftw_complex* RadarManager::fftw_out = nullptr;
-fftw_plan RadarManager::fftw_plan_r2c = nullptr;
@@ -0,0 +1,131 @@
+#include "realtime.hpp"
+#include <alloca.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace {
+std::string describeError(int error) {
+    return std::string(std::strerror(error));
+}
+}
+
+std::string RealtimeReport::summary() const {
+    std::string text = std::string("SCHED_FIFO ") + (scheduling ? "on" : "off") +
+                       ", CPU pinning " + (affinity ? "on" : "off") +
+                       ", memory locking " + (memoryLocked ? "on" : "off");
+    for (const auto& problem : problems) {
+        text += "; " + problem;
+    }
+    return text;
+}
+
+RealtimeReport RealtimeController::apply(const RealtimeConfig& config) {
+    RealtimeReport report;
+    if (!config.enabled) {
+        return report;
+    }
+
+    if (config.lockMemory) {
+        int error = lockAllMemory();
+        if (error == 0) {
+            report.memoryLocked = true;
+        } else if (error == EPERM || error == ENOMEM) {
+            report.problems.push_back("mlockall failed (" + describeError(error) +
+                                      "): raise the memlock limit (ulimit -l) or grant CAP_IPC_LOCK");
+        } else {
+            report.problems.push_back("mlockall failed: " + describeError(error));
+        }
+    }
+
+    // Touch the stack now so the first deep call doesn't page fault later
+    prefaultStack(config.prefaultStackBytes);
+
+    if (config.cpu >= 0) {
+        int error = setCpuAffinity(config.cpu);
+        if (error == 0) {
+            report.affinity = true;
+            if (!cpuListContains(isolatedCpus(), config.cpu)) {
+                report.problems.push_back("CPU " + std::to_string(config.cpu) +
+                                          " is not isolated (add isolcpus=" +
+                                          std::to_string(config.cpu) + " to the kernel command line)");
+            }
+        } else {
+            report.problems.push_back("Could not pin to CPU " + std::to_string(config.cpu) +
+                                      ": " + describeError(error));
+        }
+    }
+
+    int error = setFifoScheduling(config.priority);
+    if (error == 0) {
+        report.scheduling = true;
+    } else if (error == EPERM) {
+        report.problems.push_back("SCHED_FIFO not permitted: run as root, grant CAP_SYS_NICE "
+                                  "or raise the rtprio limit");
+    } else {
+        report.problems.push_back("SCHED_FIFO priority " + std::to_string(config.priority) +
+                                  " failed: " + describeError(error));
+    }
+
+    return report;
+}
+
+int RealtimeController::setFifoScheduling(int priority) {
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+}
+
+int RealtimeController::setCpuAffinity(int cpu) {
+    if (cpu >= CPU_SETSIZE) {
+        return EINVAL;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+int RealtimeController::lockAllMemory() {
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0 ? 0 : errno;
+}
+
+std::string RealtimeController::isolatedCpus() {
+    std::ifstream in("/sys/devices/system/cpu/isolated");
+    std::string list;
+    std::getline(in, list);
+    return list;
+}
+
+void RealtimeController::prefaultStack(size_t bytes) {
+    // volatile keeps the compiler from optimizing the writes away
+    volatile unsigned char* stack = static_cast<volatile unsigned char*>(alloca(bytes));
+    for (size_t i = 0; i < bytes; i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+bool cpuListContains(const std::string& list, int cpu) {
+    std::stringstream ranges(list);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            if (cpu >= first && cpu <= last) {
+                return true;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,112 @@
+#include "sample_history.hpp"
+#include <algorithm>
+
+namespace {
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+}
+
+SampleHistory::SampleHistory(size_t capacity)
+    : mask(roundUpToPowerOfTwo(std::max<size_t>(capacity, 2)) - 1),
+      samples(new int16_t[mask + 1]()),
+      timestamps(new std::atomic<int64_t>[mask + 1]) {
+    for (size_t i = 0; i <= mask; i++) {
+        timestamps[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void SampleHistory::write(const int16_t* data, const SteadyTime* sampleTimes, size_t count) {
+    uint64_t index = beginWrite(count);
+
+    for (size_t i = 0; i < count; i++) {
+        size_t slot = (index + i) & mask;
+        samples[slot] = data[i];
+        timestamps[slot].store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   sampleTimes[i].time_since_epoch()).count(),
+                               std::memory_order_relaxed);
+    }
+
+    // Publish the new samples to readers
+    writeIndex.store(index + count, std::memory_order_release);
+}
+
+uint64_t SampleHistory::beginWrite(size_t count) {
+    uint64_t index = writeIndex.load(std::memory_order_relaxed);
+
+    // Announce the slots we are about to overwrite before touching them
+    reserveIndex.store(index + count, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return index;
+}
+
+uint64_t SampleHistory::totalWritten() const {
+    return writeIndex.load(std::memory_order_acquire);
+}
+
+uint64_t SampleHistory::oldestIndex() const {
+    uint64_t written = totalWritten();
+    return written > capacity() ? written - capacity() : 0;
+}
+
+SteadyTime SampleHistory::timeOfIndex(uint64_t index) const {
+    int64_t ns = timestamps[index & mask].load(std::memory_order_relaxed);
+    return SteadyTime(std::chrono::duration_cast<SteadyTime::duration>(std::chrono::nanoseconds(ns)));
+}
+
+bool SampleHistory::indexForTime(SteadyTime time, uint64_t& index) const {
+    uint64_t end = totalWritten();
+    // Leave one slot of slack so the writer cannot overwrite the oldest
+    // sample while we are searching
+    uint64_t begin = end > capacity() ? end - capacity() + 1 : 0;
+    if (begin >= end || timeOfIndex(begin) > time || timeOfIndex(end - 1) < time) {
+        return false;
+    }
+
+    // Timestamps are monotonic, so binary search for the first one >= time
+    uint64_t lo = begin;
+    uint64_t hi = end - 1;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (timeOfIndex(mid) < time) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    index = lo;
+    return index >= oldestIndex();
+}
+
+bool SampleHistory::window(uint64_t start, size_t count, SampleWindow& out) const {
+    uint64_t end = totalWritten();
+    uint64_t oldest = end > capacity() ? end - capacity() : 0;
+    if (count > capacity() || start < oldest || start + count > end) {
+        return false;
+    }
+
+    size_t slot = start & mask;
+    size_t firstCount = std::min(count, capacity() - slot);
+
+    out.first = {samples.get() + slot, firstCount};
+    out.second = {samples.get(), count - firstCount};
+    if (out.second.size == 0) {
+        out.second.data = nullptr;
+    }
+    out.startIndex = start;
+    out.startTime = timeOfIndex(start);
+    return true;
+}
+
+bool SampleHistory::isIntact(const SampleWindow& window) const {
+    // Pairs with the fence in beginWrite(): if the writer started overwriting any
+    // of our slots before we finished reading, we see its reservation
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t reserved = reserveIndex.load(std::memory_order_relaxed);
+    return reserved <= capacity() || window.startIndex >= reserved - capacity();
+}
@@ -0,0 +1,461 @@
+#include "sample_source.hpp"
+#include "doppler.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+// Sleep until shortly before the deadline, then spin for the rest so the
+// scheduler's wakeup latency doesn't delay the next transfer
+void waitUntil(std::chrono::steady_clock::time_point deadline) {
+    constexpr auto spinMargin = std::chrono::microseconds(100);
+    if (deadline - std::chrono::steady_clock::now() > spinMargin) {
+        std::this_thread::sleep_until(deadline - spinMargin);
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+    }
+}
+
+// Nominal timestamps for generated or replayed samples
+void fillNominalTimestamps(SteadyTime* timestamps, size_t count, SteadyTime start,
+                           uint64_t firstIndex, int rate) {
+    if (!timestamps) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        timestamps[i] = start + std::chrono::duration_cast<SteadyTime::duration>(
+            std::chrono::duration<double>(static_cast<double>(firstIndex + i) / rate));
+    }
+}
+
+// Hold back replayed samples so they are delivered at `speed` times real time
+void paceReplay(std::chrono::steady_clock::time_point start, uint64_t delivered,
+                int rate, double speed) {
+    if (speed <= 0.0) {
+        return;
+    }
+    auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(delivered / (rate * speed)));
+    std::this_thread::sleep_until(due);
+}
+
+// Convert between ADC counts and signed 16-bit PCM (10-bit ADC, midscale 512)
+int pcm16ToAdc(int16_t value) {
+    return std::max(0, std::min(1023, (value >> 6) + 512));
+}
+
+int16_t adcToPcm16(int value) {
+    return static_cast<int16_t>((std::max(0, std::min(1023, value)) - 512) * 64);
+}
+
+uint32_t readLe32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t readLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+void writeLe32(std::ofstream& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void writeLe16(std::ofstream& out, uint16_t value) {
+    out.put(static_cast<char>(value & 0xFF));
+    out.put(static_cast<char>(value >> 8));
+}
+
+// Split "a=1,b=2" into key/value pairs
+std::map<std::string, std::string> parseOptions(const std::string& options) {
+    std::map<std::string, std::string> result;
+    size_t pos = 0;
+    while (pos < options.size()) {
+        size_t comma = options.find(',', pos);
+        std::string item = options.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        size_t eq = item.find('=');
+        if (eq != std::string::npos) {
+            result[item.substr(0, eq)] = item.substr(eq + 1);
+        } else if (!item.empty()) {
+            result[item] = "1";
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        pos = comma + 1;
+    }
+    return result;
+}
+
+double optionValue(const std::map<std::string, std::string>& options, const std::string& key,
+                   double fallback) {
+    auto it = options.find(key);
+    return it == options.end() ? fallback : std::stod(it->second);
+}
+}
+
+Mcp3008SampleSource::Mcp3008SampleSource(std::unique_ptr<SpiTransport> spi, int adcChannel,
+                                         int sampleRate, int batch)
+    : transport(std::move(spi)), channel(adcChannel), rate(sampleRate),
+      batchSize(std::max(1, batch)) {
+}
+
+bool Mcp3008SampleSource::setSampleRate(int hz) {
+    if (hz <= 0) {
+        return false;
+    }
+    rate = hz;
+    scheduled = false;
+    return true;
+}
+
+void Mcp3008SampleSource::setBatchSize(int size) {
+    batchSize = std::max(1, size);
+}
+
+std::string Mcp3008SampleSource::describe() const {
+    return "MCP3008 channel " + std::to_string(channel) + " at " + std::to_string(rate) + " Hz";
+}
+
+size_t Mcp3008SampleSource::read(int* dst, size_t count, SteadyTime* timestamps) {
+    if (!transport) {
+        throw std::runtime_error("SPI transport not initialized");
+    }
+
+    auto samplePeriod = std::chrono::nanoseconds(1000000000LL / rate);
+    transport->setFramePeriod(samplePeriod);
+    frames.resize(batchSize * MCP3008_FRAME_SIZE);
+
+    // Carry on with the schedule of the previous read, so time spent between
+    // reads doesn't delay every block that follows. Start over on the first
+    // read or when more than a batch behind.
+    auto start = std::chrono::steady_clock::now();
+    if (!scheduled || start - nextDeadline > samplePeriod * batchSize) {
+        nextDeadline = start;
+        scheduled = true;
+    }
+    for (size_t done = 0; done < count; ) {
+        size_t batch = std::min(static_cast<size_t>(batchSize), count - done);
+
+        // Queue one MCP3008 conversion per frame
+        for (size_t i = 0; i < batch; i++) {
+            mcp3008EncodeRead(&frames[i * MCP3008_FRAME_SIZE], channel);
+        }
+
+        waitUntil(nextDeadline);
+        auto batchStart = std::chrono::steady_clock::now();
+        if (!transport->transferFrames(frames.data(), MCP3008_FRAME_SIZE, batch)) {
+            throw std::runtime_error("SPI transfer failed");
+        }
+        
+        // Stamp each conversion when the transport started it. Transports
+        // that queue the batch in one go only pace the frames, so theirs are
+        // stamped on the sample period from the start of the batch. The
+        // transfer's duration can't stand in for either: there is no gap
+        // after the last frame, so it is short of batch periods.
+        if (timestamps && !transport->frameTimes(timestamps + done, batch)) {
+            for (size_t i = 0; i < batch; i++) {
+                timestamps[done + i] = batchStart + samplePeriod * i;
+            }
+        }
+
+        for (size_t i = 0; i < batch; i++) {
+            dst[done + i] = mcp3008Decode(&frames[i * MCP3008_FRAME_SIZE]);
+        }
+        done += batch;
+
+        // Next batch is due a whole number of sample periods after the first one.
+        // If we fell more than a batch behind, restart the schedule instead of
+        // bursting to catch up.
+        nextDeadline += samplePeriod * batch;
+        auto now = std::chrono::steady_clock::now();
+        if (now - nextDeadline > samplePeriod * batchSize) {
+            nextDeadline = now;
+        }
+    }
+    return count;
+}
+
+FileSampleSource::FileSampleSource(const std::string& filePath, double replaySpeed, bool loopReplay,
+                                   int rawSampleRate)
+    : path(filePath), speed(replaySpeed), loop(loopReplay), rate(rawSampleRate) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        Logger::error("Failed to open capture file " + path);
+        return;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (data.size() >= 12 && std::memcmp(data.data(), "RIFF", 4) == 0 &&
+        std::memcmp(data.data() + 8, "WAVE", 4) == 0) {
+        if (!loadWav(data)) {
+            Logger::error("Unsupported WAV format in " + path);
+            samples.clear();
+            return;
+        }
+    } else {
+        loadRaw(data);
+    }
+
+    Logger::debug("Loaded " + std::to_string(samples.size()) + " samples at " +
+                 std::to_string(rate) + " Hz from " + path);
+}
+
+bool FileSampleSource::loadWav(const std::vector<uint8_t>& data) {
+    uint16_t format = 0;
+    uint16_t channels = 0;
+    uint16_t bitsPerSample = 0;
+
+    // Walk the RIFF chunks after the 12-byte header
+    size_t pos = 12;
+    while (pos + 8 <= data.size()) {
+        const uint8_t* chunk = data.data() + pos;
+        uint32_t chunkSize = readLe32(chunk + 4);
+        size_t bodySize = std::min<size_t>(chunkSize, data.size() - pos - 8);
+        const uint8_t* body = chunk + 8;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && bodySize >= 16) {
+            format = readLe16(body);
+            channels = readLe16(body + 2);
+            rate = static_cast<int>(readLe32(body + 4));
+            bitsPerSample = readLe16(body + 14);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (format != 1 || channels == 0 || (bitsPerSample != 16 && bitsPerSample != 8)) {
+                return false;
+            }
+            size_t frameBytes = channels * (bitsPerSample / 8);
+            size_t frames = bodySize / frameBytes;
+            samples.resize(frames);
+            for (size_t i = 0; i < frames; i++) {
+                const uint8_t* frame = body + i * frameBytes;
+                if (bitsPerSample == 16) {
+                    samples[i] = pcm16ToAdc(static_cast<int16_t>(readLe16(frame)));
+                } else {
+                    samples[i] = (frame[0] - 128) * 4 + 512;
+                }
+            }
+            return true;
+        }
+
+        // Chunks are padded to an even size
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+    return false;
+}
+
+void FileSampleSource::loadRaw(const std::vector<uint8_t>& data) {
+    samples.resize(data.size() / 2);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<int16_t>(readLe16(data.data() + 2 * i));
+    }
+}
+
+std::string FileSampleSource::describe() const {
+    return "replay of " + path + " (" + std::to_string(samples.size()) + " samples at " +
+           std::to_string(rate) + " Hz)";
+}
+
+size_t FileSampleSource::read(int* dst, size_t count, SteadyTime* timestamps) {
+    // Replay timing starts with the first read
+    if (delivered == 0) {
+        replayStart = std::chrono::steady_clock::now();
+    }
+    
+    size_t done = 0;
+    while (done < count && !samples.empty()) {
+        if (position >= samples.size()) {
+            if (!loop) {
+                break;
+            }
+            position = 0;
+        }
+        size_t chunk = std::min(count - done, samples.size() - position);
+        std::copy(samples.begin() + position, samples.begin() + position + chunk, dst + done);
+        position += chunk;
+        done += chunk;
+    }
+
+    fillNominalTimestamps(timestamps, done, replayStart, delivered, rate);
+    delivered += done;
+    paceReplay(replayStart, delivered, rate, speed);
+    return done;
+}
+
+SyntheticSampleSource::SyntheticSampleSource(const SyntheticSignal& params, int sampleRate,
+                                             double generationSpeed)
+    : signal(params), rate(sampleRate), speed(generationSpeed), rng(params.seed) {
+}
+
+bool SyntheticSampleSource::setSampleRate(int hz) {
+    if (hz <= 0) {
+        return false;
+    }
+    rate = hz;
+    return true;
+}
+
+std::string SyntheticSampleSource::describe() const {
+    return "synthetic signal (ball " + std::to_string(signal.ballSpeedMPH) + " mph, club " +
+           std::to_string(signal.clubSpeedMPH) + " mph) at " + std::to_string(rate) + " Hz";
+}
+
+size_t SyntheticSampleSource::read(int* dst, size_t count, SteadyTime* timestamps) {
+    const double twoPi = 2.0 * M_PI;
+    double ballFreq = dopplerFrequencyForSpeed(signal.ballSpeedMPH / MPS_TO_MPH);
+    double clubFreq = dopplerFrequencyForSpeed(signal.clubSpeedMPH / MPS_TO_MPH);
+    // Rate the ball's frequency falls at, in Hz/s
+    double ballChirp = dopplerFrequencyForSpeed(signal.ballDecelerationMPHPerS / MPS_TO_MPH);
+    if (sampleIndex == 0) {
+        start = std::chrono::steady_clock::now();
+    }
+    fillNominalTimestamps(timestamps, count, start, sampleIndex, rate);
+
+    for (size_t i = 0; i < count; i++) {
+        double t = static_cast<double>(sampleIndex++) / rate;
+        double ballGain = 1.0;
+        double clubGain = 1.0;
+        double sinceImpact = t;
+
+        if (signal.shotIntervalMs > 0.0f) {
+            // Position inside the current shot cycle; impact happens once the
+            // club has finished its approach
+            double cycleMs = std::fmod(t * 1000.0, signal.shotIntervalMs);
+            double sinceImpactMs = cycleMs - signal.clubApproachMs;
+            sinceImpact = std::max(0.0, sinceImpactMs / 1000.0);
+            if (sinceImpactMs < 0.0) {
+                clubGain = cycleMs / signal.clubApproachMs;
+                ballGain = 0.0;
+            } else {
+                clubGain = std::exp(-sinceImpactMs / signal.clubDecayMs);
+                ballGain = sinceImpactMs < signal.ballDurationMs ? 1.0 : 0.0;
+            }
+        }
+
+        // The ball's phase is the integral of its falling frequency since impact
+        double ballCycles = ballFreq * t - 0.5 * ballChirp * sinceImpact * sinceImpact;
+        double value = 512.0
+            + ballGain * signal.ballAmplitude * std::sin(twoPi * ballCycles)
+            + clubGain * signal.clubAmplitude * std::sin(twoPi * clubFreq * t)
+            + signal.noiseAmplitude * noise(rng);
+
+        dst[i] = static_cast<int>(std::max(0.0, std::min(1023.0, value)));
+    }
+
+    paceReplay(start, sampleIndex, rate, speed);
+    return count;
+}
+
+std::unique_ptr<SampleSource> makeSampleSource(const std::string& spec, int adcChannel,
+                                               int sampleRate) {
+    size_t colon = spec.find(':');
+    std::string kind = spec.substr(0, colon);
+    std::string argument = colon == std::string::npos ? "" : spec.substr(colon + 1);
+
+    try {
+        if (kind == "mcp3008") {
+            auto transport = std::make_unique<Bcm2835SpiTransport>();
+            if (!transport->isOpen()) {
+                return nullptr;
+            }
+            return std::make_unique<Mcp3008SampleSource>(std::move(transport), adcChannel, sampleRate);
+        }
+
+        if (kind == "spidev") {
+            auto transport = std::make_unique<SpidevSpiTransport>(
+                argument.empty() ? "/dev/spidev0.0" : argument);
+            if (!transport->isOpen()) {
+                return nullptr;
+            }
+            return std::make_unique<Mcp3008SampleSource>(std::move(transport), adcChannel, sampleRate);
+        }
+
+        if (kind == "file") {
+            size_t comma = argument.find(',');
+            std::string path = argument.substr(0, comma);
+            auto options = parseOptions(comma == std::string::npos ? "" : argument.substr(comma + 1));
+            auto source = std::make_unique<FileSampleSource>(
+                path, optionValue(options, "speed", 1.0), optionValue(options, "loop", 0.0) != 0.0,
+                static_cast<int>(optionValue(options, "rate", sampleRate)));
+            if (!source->isOpen()) {
+                return nullptr;
+            }
+            return source;
+        }
+
+        if (kind == "synthetic") {
+            auto options = parseOptions(argument);
+            SyntheticSignal signal;
+            signal.ballSpeedMPH = optionValue(options, "ball", signal.ballSpeedMPH);
+            signal.clubSpeedMPH = optionValue(options, "club", signal.clubSpeedMPH);
+            signal.clubAmplitude = optionValue(options, "club_amplitude",
+                                               signal.clubSpeedMPH > 0.0f ? 150.0f : 0.0f);
+            signal.noiseAmplitude = optionValue(options, "noise", signal.noiseAmplitude);
+            signal.shotIntervalMs = optionValue(options, "interval", signal.shotIntervalMs);
+            signal.ballDecelerationMPHPerS = optionValue(options, "decel", signal.ballDecelerationMPHPerS);
+            signal.seed = static_cast<unsigned>(optionValue(options, "seed", signal.seed));
+            return std::make_unique<SyntheticSampleSource>(
+                signal, sampleRate, optionValue(options, "speed", 1.0));
+        }
+    } catch (const std::exception& e) {
+        Logger::error("Invalid sample source option in '" + spec + "': " + e.what());
+        return nullptr;
+    }
+
+    Logger::error("Unknown sample source '" + spec + "'");
+    return nullptr;
+}
+
+bool writeWavFile(const std::string& path, const std::vector<int>& samples, int sampleRate) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        Logger::error("Failed to open " + path + " for writing");
+        return false;
+    }
+
+    uint32_t dataBytes = static_cast<uint32_t>(samples.size() * 2);
+    out.write("RIFF", 4);
+    writeLe32(out, 36 + dataBytes);
+    out.write("WAVE", 4);
+
+    out.write("fmt ", 4);
+    writeLe32(out, 16);
+    writeLe16(out, 1);                                  // PCM
+    writeLe16(out, 1);                                  // Mono
+    writeLe32(out, static_cast<uint32_t>(sampleRate));
+    writeLe32(out, static_cast<uint32_t>(sampleRate) * 2);  // Byte rate
+    writeLe16(out, 2);                                  // Block align
+    writeLe16(out, 16);                                 // Bits per sample
+
+    out.write("data", 4);
+    writeLe32(out, dataBytes);
+    for (int sample : samples) {
+        writeLe16(out, static_cast<uint16_t>(adcToPcm16(sample)));
+    }
+    return static_cast<bool>(out);
+}
+
+std::vector<std::string> listCaptureFiles(const std::string& directory) {
+    std::vector<std::string> files;
+    std::error_code error;
+    std::filesystem::directory_iterator entries(directory, error);
+    if (error) {
+        Logger::error("Failed to read capture directory " + directory + ": " + error.message());
+        return files;
+    }
+    for (const auto& entry : entries) {
+        std::string extension = entry.path().extension().string();
+        if (entry.is_regular_file(error) && (extension == ".wav" || extension == ".raw")) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
@@ -0,0 +1,98 @@
+#include "shot_tracker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace {
+// Speed of the peak in `frame` closest to `speed`, if one is within
+// `tolerance` (a fraction of `speed`), otherwise 0
+float matchingSpeed(const StftFrame& frame, float speed, float tolerance) {
+    float best = 0.0f;
+    for (size_t i = 0; i < frame.peakCount; i++) {
+        float difference = std::abs(frame.peaks[i].speedMPH - speed);
+        if (difference <= tolerance * speed && (best == 0.0f || difference < std::abs(best - speed))) {
+            best = frame.peaks[i].speedMPH;
+        }
+    }
+    return best;
+}
+
+// Speeds of the frames that have a peak matching `speed`, and the first such frame
+std::vector<float> matchingSpeeds(const std::vector<StftFrame>& frames, float speed, float tolerance,
+                                  size_t& first) {
+    std::vector<float> matches;
+    for (size_t i = 0; i < frames.size(); i++) {
+        float match = matchingSpeed(frames[i], speed, tolerance);
+        if (match > 0.0f) {
+            if (matches.empty()) {
+                first = i;
+            }
+            matches.push_back(match);
+        }
+    }
+    return matches;
+}
+
+float median(std::vector<float> values) {
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+}
+
+ShotSpeeds trackShot(const std::vector<StftFrame>& frames, const ShotTrackerConfig& config) {
+    ShotSpeeds shot;
+
+    // Every return in the track, fastest first
+    std::vector<float> candidates;
+    for (const StftFrame& frame : frames) {
+        for (size_t i = 0; i < frame.peakCount; i++) {
+            if (frame.peaks[i].speedMPH > 0.0f) {
+                candidates.push_back(frame.peaks[i].speedMPH);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), std::greater<float>());
+
+    // The ball: the fastest return seen at about the same speed in enough frames
+    size_t impact = 0;
+    std::vector<float> ball;
+    float tried = 0.0f;
+    for (float candidate : candidates) {
+        // Candidates this close to one already tried would find the same frames
+        if (tried > 0.0f && candidate >= tried * (1.0f - config.speedTolerance / 4)) {
+            continue;
+        }
+        tried = candidate;
+        ball = matchingSpeeds(frames, candidate, config.speedTolerance, impact);
+        if (ball.size() >= config.minBallFrames) {
+            // Settle on the cluster's own center rather than its fastest member
+            ball = matchingSpeeds(frames, median(ball), config.speedTolerance, impact);
+            break;
+        }
+        ball.clear();
+    }
+    if (ball.size() < config.minBallFrames || ball.empty()) {
+        return shot;
+    }
+    shot.ballSpeedMPH = median(ball);
+    shot.ballFrames = ball.size();
+    shot.impactSample = frames[impact].firstSample;
+
+    // The club: slower than the ball, fastest at impact
+    float slowest = shot.ballSpeedMPH / config.maxSmashFactor;
+    float fastest = shot.ballSpeedMPH * (1.0f - config.speedTolerance);
+    size_t first = impact + 1 > config.clubFrames ? impact + 1 - config.clubFrames : 0;
+    for (size_t i = first; i <= impact; i++) {
+        for (size_t j = 0; j < frames[i].peakCount; j++) {
+            float speed = frames[i].peaks[j].speedMPH;
+            if (speed >= slowest && speed <= fastest) {
+                shot.clubSpeedMPH = std::max(shot.clubSpeedMPH, speed);
+            }
+        }
+    }
+    if (shot.clubSpeedMPH > 0.0f) {
+        shot.smashFactor = shot.ballSpeedMPH / shot.clubSpeedMPH;
+    }
+    return shot;
+}
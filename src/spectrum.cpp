@@ -0,0 +1,328 @@
+#include "spectrum.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+template <typename Real>
+void magnitudesOf(const Real* __restrict spectrum, size_t bins, Real* __restrict magnitudes) {
+    // Plain loop over separate arrays so the compiler can vectorize it
+    for (size_t i = 0; i < bins; i++) {
+        Real real = spectrum[2 * i];
+        Real imag = spectrum[2 * i + 1];
+        magnitudes[i] = std::sqrt(real * real + imag * imag);
+    }
+}
+
+template <typename Real>
+void powersOf(const Real* __restrict spectrum, size_t bins, Real* __restrict powers) {
+    for (size_t i = 0; i < bins; i++) {
+        Real real = spectrum[2 * i];
+        Real imag = spectrum[2 * i + 1];
+        powers[i] = real * real + imag * imag;
+    }
+}
+
+// Median of the bins between DC and the last bin. Works for magnitudes and
+// powers alike, since squaring doesn't change the order.
+template <typename Real>
+double medianBin(const Real* values, size_t bins) {
+    static thread_local std::vector<Real> sorted;
+    sorted.assign(values + 1, values + bins - 1);
+    auto median = sorted.begin() + sorted.size() / 2;
+    std::nth_element(sorted.begin(), median, sorted.end());
+    return static_cast<double>(*median);
+}
+
+// The median bin power of complex gaussian noise is ln 2 times its mean,
+// and a few strong bins barely move the median
+template <typename Real>
+double peakToNoiseOf(const Real* magnitudes, size_t bins, double peak) {
+    if (bins < 3) {
+        return 0.0;
+    }
+    double noise = medianBin(magnitudes, bins);
+    return noise > 0.0 ? peak * peak * std::log(2.0) / (noise * noise) : 0.0;
+}
+
+// Cell averaging: the training sums come from a prefix sum, kept in double
+// so float spectra don't lose small sums to cancellation
+template <typename Real>
+void cellAveragingThresholds(const Real* powers, size_t bins, int guard, int training, double scale,
+                             Real* thresholds) {
+    static thread_local std::vector<double> prefix;
+    prefix.resize(bins + 1);
+    prefix[0] = 0.0;
+    prefix[1] = 0.0;  // DC
+    for (size_t i = 1; i < bins; i++) {
+        prefix[i + 1] = prefix[i] + powers[i];
+    }
+
+    // Sum of cells [first, last), clipped to [1, bins)
+    auto sum = [&](long first, long last, long& count) {
+        first = std::max(first, 1L);
+        last = std::min(last, static_cast<long>(bins));
+        if (last <= first) {
+            return 0.0;
+        }
+        count += last - first;
+        return prefix[last] - prefix[first];
+    };
+    for (long i = 0; i < static_cast<long>(bins); i++) {
+        long count = 0;
+        double total = sum(i - guard - training, i - guard, count) + sum(i + guard + 1, i + guard + training + 1, count);
+        thresholds[i] = count > 0 ? static_cast<Real>(scale * total / count) : Real(0);
+    }
+}
+
+template <typename Real>
+void orderedStatisticThresholds(const Real* powers, size_t bins, int guard, int training, double fraction,
+                                double scale, Real* thresholds) {
+    static thread_local std::vector<Real> cells;
+    for (long i = 0; i < static_cast<long>(bins); i++) {
+        cells.clear();
+        for (long j = std::max(1L, i - guard - training); j < i - guard; j++) {
+            cells.push_back(powers[j]);
+        }
+        for (long j = i + guard + 1; j <= i + guard + training && j < static_cast<long>(bins); j++) {
+            cells.push_back(powers[j]);
+        }
+        if (cells.empty()) {
+            thresholds[i] = Real(0);
+            continue;
+        }
+        size_t rank = std::min(cells.size() - 1, static_cast<size_t>(std::ceil(fraction * cells.size())) - 1);
+        std::nth_element(cells.begin(), cells.begin() + rank, cells.end());
+        thresholds[i] = static_cast<Real>(scale * cells[rank]);
+    }
+}
+
+template <typename Real>
+void cfarThresholdsOf(const Real* powers, size_t bins, const CfarConfig& config, Real* thresholds) {
+    int guard = std::max(0, config.guardCells);
+    int training = std::max(1, config.trainingCells);
+    double scale = cfarScale(config);
+    if (config.method == CfarMethod::OrderedStatistic) {
+        orderedStatisticThresholds(powers, bins, guard, training, config.orderFraction, scale, thresholds);
+    } else {
+        cellAveragingThresholds(powers, bins, guard, training, scale, thresholds);
+    }
+}
+
+template <typename Real>
+double noisePowerOf(const Real* powers, size_t bins) {
+    return bins < 3 ? 0.0 : medianBin(powers, bins) / std::log(2.0);
+}
+
+template <typename Real>
+double peakPowerToNoiseOf(const Real* powers, size_t bins, double peakPower) {
+    double noise = noisePowerOf(powers, bins);
+    return noise > 0.0 ? peakPower / noise : 0.0;
+}
+}
+
+void computeMagnitudes(const float* spectrum, size_t bins, float* magnitudes) {
+    magnitudesOf(spectrum, bins, magnitudes);
+}
+
+void computeMagnitudes(const double* spectrum, size_t bins, double* magnitudes) {
+    magnitudesOf(spectrum, bins, magnitudes);
+}
+
+void computePowers(const float* spectrum, size_t bins, float* powers) {
+    powersOf(spectrum, bins, powers);
+}
+
+void computePowers(const double* spectrum, size_t bins, double* powers) {
+    powersOf(spectrum, bins, powers);
+}
+
+std::string peakEstimatorName(PeakEstimator estimator) {
+    switch (estimator) {
+        case PeakEstimator::None: return "none";
+        case PeakEstimator::Parabolic: return "parabolic";
+        case PeakEstimator::Jacobsen: return "jacobsen";
+        case PeakEstimator::Quinn: return "quinn";
+        case PeakEstimator::ZeroPadded: return "zero-padded";
+    }
+    return "unknown";
+}
+
+bool parsePeakEstimator(const std::string& name, PeakEstimator& estimator) {
+    for (PeakEstimator candidate : {PeakEstimator::None, PeakEstimator::Parabolic, PeakEstimator::Jacobsen,
+                                    PeakEstimator::Quinn, PeakEstimator::ZeroPadded}) {
+        if (name == peakEstimatorName(candidate)) {
+            estimator = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+double clampOffset(double offset) {
+    if (!std::isfinite(offset)) {
+        return 0.0;
+    }
+    return std::max(-0.5, std::min(0.5, offset));
+}
+
+// Quinn's tau function
+double quinnTau(double x) {
+    const double root = std::sqrt(2.0 / 3.0);
+    return 0.25 * std::log(3.0 * x * x + 6.0 * x + 1.0) -
+           std::sqrt(6.0) / 24.0 * std::log((x + 1.0 - root) / (x + 1.0 + root));
+}
+}
+
+double parabolicPeakOffset(double below, double peak, double above) {
+    if (below <= 0.0 || peak <= 0.0 || above <= 0.0) {
+        return 0.0;
+    }
+    double a = std::log(below);
+    double b = std::log(peak);
+    double c = std::log(above);
+    double curvature = a - 2.0 * b + c;
+    if (curvature >= 0.0) {
+        return 0.0;
+    }
+    return clampOffset(0.5 * (a - c) / curvature);
+}
+
+double jacobsenPeakOffset(const std::complex<double> bins[3]) {
+    std::complex<double> denominator = 2.0 * bins[1] - bins[0] - bins[2];
+    if (std::abs(denominator) == 0.0) {
+        return 0.0;
+    }
+    return clampOffset(std::real((bins[0] - bins[2]) / denominator));
+}
+
+double quinnPeakOffset(const std::complex<double> bins[3]) {
+    double peakPower = std::norm(bins[1]);
+    if (peakPower == 0.0) {
+        return 0.0;
+    }
+    double alphaBelow = std::real(bins[0] * std::conj(bins[1])) / peakPower;
+    double alphaAbove = std::real(bins[2] * std::conj(bins[1])) / peakPower;
+    double deltaBelow = alphaBelow / (1.0 - alphaBelow);
+    double deltaAbove = -alphaAbove / (1.0 - alphaAbove);
+    double offset = (deltaAbove + deltaBelow) / 2.0 + quinnTau(deltaAbove * deltaAbove) -
+                    quinnTau(deltaBelow * deltaBelow);
+    return clampOffset(offset);
+}
+
+namespace {
+template <typename Sample>
+std::complex<double> goertzelOf(const Sample* samples, size_t count, double offset, double bin) {
+    if (count == 0) {
+        return 0.0;
+    }
+    double omega = 2.0 * M_PI * bin / count;
+    double coefficient = 2.0 * std::cos(omega);
+    double previous = 0.0;
+    double beforePrevious = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double state = (samples[i] - offset) + coefficient * previous - beforePrevious;
+        beforePrevious = previous;
+        previous = state;
+    }
+    // Rotate so the phase matches a DFT starting at sample 0
+    std::complex<double> y = previous - std::polar(1.0, -omega) * beforePrevious;
+    return y * std::polar(1.0, -omega * (count - 1));
+}
+}
+
+std::complex<double> goertzel(const int* samples, size_t count, double offset, double bin) {
+    return goertzelOf(samples, count, offset, bin);
+}
+
+std::complex<double> goertzel(const int16_t* samples, size_t count, double offset, double bin) {
+    return goertzelOf(samples, count, offset, bin);
+}
+
+double peakToNoise(const float* magnitudes, size_t bins, double peak) {
+    return peakToNoiseOf(magnitudes, bins, peak);
+}
+
+double peakToNoise(const double* magnitudes, size_t bins, double peak) {
+    return peakToNoiseOf(magnitudes, bins, peak);
+}
+
+double peakPowerToNoise(const float* powers, size_t bins, double peakPower) {
+    return peakPowerToNoiseOf(powers, bins, peakPower);
+}
+
+double peakPowerToNoise(const double* powers, size_t bins, double peakPower) {
+    return peakPowerToNoiseOf(powers, bins, peakPower);
+}
+
+double noisePower(const float* powers, size_t bins) {
+    return noisePowerOf(powers, bins);
+}
+
+double noisePower(const double* powers, size_t bins) {
+    return noisePowerOf(powers, bins);
+}
+
+double peakConfidence(double peakToNoise, size_t bins) {
+    if (peakToNoise <= 0.0) {
+        return 0.0;
+    }
+    // Noise power in a bin is exponentially distributed, so each bin stays
+    // below the peak with probability 1 - e^-ratio
+    return std::exp(static_cast<double>(bins) * std::log1p(-std::exp(-peakToNoise)));
+}
+
+double cfarScale(const CfarConfig& config) {
+    double cells = 2.0 * std::max(1, config.trainingCells);
+    double rate = std::max(1e-300, std::min(1.0, config.falseAlarmRate));
+    if (config.method == CfarMethod::CellAveraging) {
+        return cells * (std::pow(rate, -1.0 / cells) - 1.0);
+    }
+
+    // Ordered statistic: the false alarm rate is prod_{i<k} (N - i) / (N - i + scale)
+    // for the k-th smallest of N cells; it falls as the scale grows
+    int rank = std::max(1, std::min(static_cast<int>(cells), static_cast<int>(std::ceil(config.orderFraction * cells))));
+    auto falseAlarms = [&](double scale) {
+        double product = 1.0;
+        for (int i = 0; i < rank; i++) {
+            product *= (cells - i) / (cells - i + scale);
+        }
+        return product;
+    };
+    double low = 0.0;
+    double high = 1.0;
+    while (falseAlarms(high) > rate && high < 1e12) {
+        high *= 2.0;
+    }
+    for (int i = 0; i < 100; i++) {
+        double middle = 0.5 * (low + high);
+        (falseAlarms(middle) > rate ? low : high) = middle;
+    }
+    return high;
+}
+
+void cfarThresholds(const float* powers, size_t bins, const CfarConfig& config, float* thresholds) {
+    cfarThresholdsOf(powers, bins, config, thresholds);
+}
+
+void cfarThresholds(const double* powers, size_t bins, const CfarConfig& config, double* thresholds) {
+    cfarThresholdsOf(powers, bins, config, thresholds);
+}
+
+double peakUncertaintyBins(PeakEstimator estimator, double peakToNoise, int zeroPadFactor) {
+    // Cramer-Rao bound for a single tone: with a peak to noise power ratio R
+    // in the FFT, the position can't be known better than sqrt(6 / R) / 2 pi bins
+    double noise = peakToNoise > 0.0 ? std::sqrt(6.0 / peakToNoise) / (2.0 * M_PI) : 0.5;
+    
+    // Typical worst case error of each estimator on a clean tone
+    double bias = 0.0;
+    switch (estimator) {
+        case PeakEstimator::None: bias = 1.0 / std::sqrt(12.0); break;
+        case PeakEstimator::Parabolic: bias = 0.02; break;
+        case PeakEstimator::Jacobsen: bias = 0.005; break;
+        case PeakEstimator::Quinn: bias = 0.002; break;
+        case PeakEstimator::ZeroPadded: bias = 0.02 / std::max(1, zeroPadFactor); break;
+    }
+    return std::min(0.5, std::sqrt(noise * noise + bias * bias));
+}
@@ -0,0 +1,163 @@
+#include "spi_transport.hpp"
+#include "logger.hpp"
+#include <bcm2835.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include <cstring>
+#include <algorithm>
+
+// The spidev driver rejects messages with more transfers than fit in the ioctl size field
+constexpr size_t SPIDEV_MAX_TRANSFERS = 256;
+
+void mcp3008EncodeRead(uint8_t* frame, int channel) {
+    frame[0] = 0x01;                    // Start bit
+    frame[1] = 0x80 | (channel << 4);   // Single-ended, channel select
+    frame[2] = 0x00;                    // Don't care
+}
+
+int mcp3008Decode(const uint8_t* frame) {
+    // 10-bit result in the low bits of the last two bytes
+    return ((frame[1] & 0x03) << 8) | frame[2];
+}
+
+uint32_t spiFrameGapMicros(std::chrono::nanoseconds framePeriod, size_t frameSize, uint32_t clockHz,
+                           size_t index) {
+    int64_t frameNanos = static_cast<int64_t>(frameSize * 8 * 1000000000ULL / clockHz);
+    int64_t idle = framePeriod.count() - frameNanos;
+    if (idle <= 0) {
+        return 0;
+    }
+    // Idle time up to the end of this frame, rounded, less what the earlier frames got
+    int64_t through = (idle * static_cast<int64_t>(index + 1) + 500) / 1000;
+    int64_t before = (idle * static_cast<int64_t>(index) + 500) / 1000;
+    return static_cast<uint32_t>(through - before);
+}
+
+Bcm2835SpiTransport::Bcm2835SpiTransport() {
+    // Initialize BCM2835 library for SPI communication
+    if (!bcm2835_init()) {
+        Logger::error("Failed to initialize BCM2835 library");
+        return;
+    }
+    
+    // Initialize SPI
+    if (!bcm2835_spi_begin()) {
+        Logger::error("Failed to initialize SPI");
+        bcm2835_close();
+        return;
+    }
+    
+    // Configure SPI
+    bcm2835_spi_setBitOrder(BCM2835_SPI_BIT_ORDER_MSBFIRST);
+    bcm2835_spi_setDataMode(BCM2835_SPI_MODE0);
+    bcm2835_spi_setClockDivider(BCM2835_SPI_CLOCK_DIVIDER_64); // ~4MHz
+    bcm2835_spi_chipSelect(BCM2835_SPI_CS0);
+    open = true;
+}
+
+Bcm2835SpiTransport::~Bcm2835SpiTransport() {
+    if (open) {
+        // End SPI communication
+        bcm2835_spi_end();
+        // Close BCM2835 library
+        bcm2835_close();
+    }
+}
+
+bool Bcm2835SpiTransport::transferFrames(uint8_t* buffer, size_t frameSize, size_t count) {
+    if (!open) {
+        return false;
+    }
+    
+    if (startTimes.size() < count) {
+        startTimes.resize(count);
+    }
+    timedFrames = 0;
+    
+    // Busy-wait for each frame's start; the gaps are a few microseconds at
+    // the rates this is used for, well below the scheduler's wakeup latency
+    auto due = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            due += framePeriod;
+            while (std::chrono::steady_clock::now() < due) {
+            }
+        }
+        startTimes[i] = std::chrono::steady_clock::now();
+        bcm2835_spi_transfern(reinterpret_cast<char*>(buffer + i * frameSize), frameSize);
+    }
+    timedFrames = count;
+    return true;
+}
+
+bool Bcm2835SpiTransport::frameTimes(SteadyTime* times, size_t count) const {
+    if (count > timedFrames) {
+        return false;
+    }
+    std::copy(startTimes.begin(), startTimes.begin() + count, times);
+    return true;
+}
+
+SpidevSpiTransport::SpidevSpiTransport(const std::string& device, uint32_t speed)
+    : speedHz(speed) {
+    fd = open(device.c_str(), O_RDWR);
+    if (fd < 0) {
+        Logger::error("Failed to open SPI device " + device + ": " + std::strerror(errno));
+        return;
+    }
+
+    uint8_t mode = SPI_MODE_0;
+    uint8_t bits = 8;
+    if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+        ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+        ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speedHz) < 0) {
+        Logger::error("Failed to configure SPI device " + device + ": " + std::strerror(errno));
+        close(fd);
+        fd = -1;
+        return;
+    }
+
+    Logger::info("Opened SPI device " + device + " at " + std::to_string(speedHz) + " Hz");
+}
+
+SpidevSpiTransport::~SpidevSpiTransport() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool SpidevSpiTransport::transferFrames(uint8_t* buffer, size_t frameSize, size_t count) {
+    if (fd < 0) {
+        return false;
+    }
+
+    for (size_t done = 0; done < count; ) {
+        size_t batch = std::min(count - done, SPIDEV_MAX_TRANSFERS);
+        if (transfers.size() < batch) {
+            transfers.resize(batch);
+        }
+
+        // Describe one transfer per frame, releasing chip select after each
+        for (size_t i = 0; i < batch; i++) {
+            spi_ioc_transfer& xfer = transfers[i];
+            std::memset(&xfer, 0, sizeof(xfer));
+            uint8_t* frame = buffer + (done + i) * frameSize;
+            xfer.tx_buf = reinterpret_cast<uintptr_t>(frame);
+            xfer.rx_buf = reinterpret_cast<uintptr_t>(frame);
+            xfer.len = static_cast<uint32_t>(frameSize);
+            xfer.speed_hz = speedHz;
+            xfer.bits_per_word = 8;
+            xfer.delay_usecs = static_cast<uint16_t>(
+                spiFrameGapMicros(framePeriod, frameSize, speedHz, done + i));
+            xfer.cs_change = (i + 1 < batch) ? 1 : 0;
+        }
+
+        if (ioctl(fd, SPI_IOC_MESSAGE(batch), transfers.data()) < 0) {
+            return false;
+        }
+        done += batch;
+    }
+    return true;
+}
@@ -0,0 +1,173 @@
+#include "stft.hpp"
+#include "doppler.hpp"
+#include "spectrum.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+StftEngine::StftEngine(FftPlanCache& plans, WindowCache& windows, double rate,
+                       const StftConfig& config, unsigned planFlags)
+    : settings(config), sampleRate(rate) {
+    if (settings.frameSize < 8 || settings.hopSize < 1 || settings.hopSize > settings.frameSize) {
+        throw std::invalid_argument("Invalid STFT frame size " + std::to_string(settings.frameSize) +
+                                    " and hop " + std::to_string(settings.hopSize));
+    }
+    if (sampleRate <= 0.0) {
+        throw std::invalid_argument("Invalid STFT sample rate");
+    }
+
+    plan = plans.get({settings.frameSize, FftDirection::RealToComplex, FftPrecision::Double, planFlags});
+    if (!plan) {
+        throw std::runtime_error("Could not plan a " + std::to_string(settings.frameSize) + " point FFT");
+    }
+    window = windows.get(settings.window, settings.frameSize, settings.kaiserBeta).data();
+
+    size_t size = settings.frameSize;
+    history.resize(2 * size);
+    times.resize(size);
+    magnitudes.resize(size / 2 + 1);
+
+    // Never report DC, or the Nyquist bin which has no neighbour above it
+    firstBin = std::max<size_t>(1, static_cast<size_t>(std::ceil(settings.minFrequency / binWidth())));
+    firstBin = std::min(firstBin, size / 2 - 1);
+    reset();
+}
+
+void StftEngine::reset() {
+    pushed = 0;
+    untilFrame = settings.frameSize;
+    frames.clear();
+    std::fill(magnitudes.begin(), magnitudes.end(), 0.0);
+}
+
+size_t StftEngine::push(const int* samples, size_t count, const SteadyTime* sampleTimes) {
+    return pushAs(samples, count, sampleTimes);
+}
+
+size_t StftEngine::push(const int16_t* samples, size_t count, const SteadyTime* sampleTimes) {
+    return pushAs(samples, count, sampleTimes);
+}
+
+template <typename Sample>
+size_t StftEngine::pushAs(const Sample* samples, size_t count, const SteadyTime* sampleTimes) {
+    size_t size = settings.frameSize;
+    size_t computed = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t slot = pushed % size;
+        history[slot] = samples[i];
+        history[slot + size] = samples[i];
+        times[slot] = sampleTimes ? sampleTimes[i] : SteadyTime();
+        pushed++;
+
+        if (--untilFrame == 0) {
+            computeFrame();
+            untilFrame = settings.hopSize;
+            computed++;
+        }
+    }
+    return computed;
+}
+
+void StftEngine::computeFrame() {
+    size_t size = settings.frameSize;
+    size_t bins = size / 2 + 1;
+    size_t start = pushed % size;  // Slot of the oldest sample
+
+    double* fftIn = workspace.input<double>(*plan);
+    double* fftOut = workspace.output<double>(*plan);
+    windowSamples(&history[start], size, window, fftIn);
+    plan->execute(fftIn, fftOut);
+    computeMagnitudes(fftOut, bins, magnitudes.data());
+
+    size_t peak = firstBin;
+    for (size_t i = firstBin + 1; i < bins - 1; i++) {
+        if (magnitudes[i] > magnitudes[peak]) {
+            peak = i;
+        }
+    }
+    double offset = parabolicPeakOffset(magnitudes[peak - 1], magnitudes[peak], magnitudes[peak + 1]);
+
+    StftFrame frame;
+    frame.firstSample = pushed - size;
+    frame.time = times[(start + size / 2) % size];
+    frame.frequency = static_cast<float>((peak + offset) * binWidth());
+    frame.speedMPH = speedForDopplerFrequency(frame.frequency) * MPS_TO_MPH;
+    frame.magnitude = static_cast<float>(magnitudes[peak]);
+    // Peak power over noise is proportional to the squared magnitude
+    double noiseScale = peakToNoise(magnitudes.data(), bins, 1.0);
+    frame.peakToNoise = static_cast<float>(noiseScale * magnitudes[peak] * magnitudes[peak]);
+
+    // Other local maxima, kept sorted by magnitude
+    double minMagnitude = std::max(magnitudes[peak] * settings.minPeakRatio,
+                                   noiseScale > 0.0 ? std::sqrt(settings.minPeakToNoise / noiseScale) : 0.0);
+    frame.peakCount = 0;
+    for (size_t i = firstBin; i < bins - 1; i++) {
+        double magnitude = magnitudes[i];
+        if (magnitude < minMagnitude || magnitude <= magnitudes[i - 1] || magnitude < magnitudes[i + 1]) {
+            continue;
+        }
+        if (frame.peakCount == MAX_STFT_PEAKS && magnitude <= frame.peaks[MAX_STFT_PEAKS - 1].magnitude) {
+            continue;
+        }
+        size_t slot = std::min(frame.peakCount, MAX_STFT_PEAKS - 1);
+        while (slot > 0 && frame.peaks[slot - 1].magnitude < magnitude) {
+            frame.peaks[slot] = frame.peaks[slot - 1];
+            slot--;
+        }
+        float frequency = static_cast<float>(
+            (i + parabolicPeakOffset(magnitudes[i - 1], magnitude, magnitudes[i + 1])) * binWidth());
+        frame.peaks[slot] = {frequency, speedForDopplerFrequency(frequency) * MPS_TO_MPH,
+                             static_cast<float>(magnitude)};
+        frame.peakCount = std::min(frame.peakCount + 1, MAX_STFT_PEAKS);
+    }
+
+    frames.push_back(frame);
+    while (frames.size() > settings.maxTrackFrames) {
+        frames.pop_front();
+    }
+}
+
+namespace {
+bool sameConfig(const StftConfig& a, const StftConfig& b) {
+    return a.frameSize == b.frameSize && a.hopSize == b.hopSize && a.window == b.window &&
+           a.kaiserBeta == b.kaiserBeta && a.minFrequency == b.minFrequency &&
+           a.minPeakToNoise == b.minPeakToNoise && a.minPeakRatio == b.minPeakRatio &&
+           a.maxTrackFrames == b.maxTrackFrames;
+}
+}
+
+std::unique_ptr<StftEngine> StftEnginePool::take(FftPlanCache& plans, WindowCache& windows, double sampleRate,
+                                                 const StftConfig& config, unsigned planFlags) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = idle.begin(); it != idle.end(); ++it) {
+            if (it->sampleRate == sampleRate && it->planFlags == planFlags &&
+                sameConfig(it->engine->config(), config)) {
+                std::unique_ptr<StftEngine> engine = std::move(it->engine);
+                idle.erase(it);
+                return engine;
+            }
+        }
+    }
+    return std::make_unique<StftEngine>(plans, windows, sampleRate, config, planFlags);
+}
+
+void StftEnginePool::give(std::unique_ptr<StftEngine> engine, double sampleRate, unsigned planFlags) {
+    if (!engine) {
+        return;
+    }
+    engine->reset();
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.push_back({sampleRate, planFlags, std::move(engine)});
+}
+
+size_t StftEnginePool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return idle.size();
+}
+
+void StftEnginePool::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.clear();
+}
@@ -0,0 +1,123 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace {
+// The pool and queue of the worker running on this thread, if any
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentQueue = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    taskQueued.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t index = currentPool == this ? currentQueue : nextQueue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queued++;
+        unfinished++;
+    }
+    taskQueued.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allFinished.wait(lock, [this] { return unfinished == 0; });
+    if (firstError) {
+        std::exception_ptr error = std::move(firstError);
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    for (size_t i = 0; i < count; i++) {
+        submit([&body, i] { body(i); });
+    }
+    wait();
+}
+
+bool ThreadPool::take(size_t index, std::function<void()>& task) {
+    // Newest from our own queue, while its data is still in cache
+    {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // Oldest from the others, starting with the next one along
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        Queue& other = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(size_t index) {
+    currentPool = this;
+    currentQueue = index;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            taskQueued.wait(lock, [this] { return queued > 0 || stopping; });
+            if (queued == 0) {
+                return;
+            }
+            // Claim one of the queued tasks. Only claimed workers take tasks,
+            // so there is always one left in some queue for this worker.
+            queued--;
+        }
+
+        std::function<void()> task;
+        while (!take(index, task)) {
+            std::this_thread::yield();
+        }
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!firstError) {
+                firstError = std::current_exception();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (--unfinished == 0) {
+            allFinished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#include "timing.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+double secondsSince(SteadyTime origin, SteadyTime time) {
+    return std::chrono::duration<double>(time - origin).count();
+}
+}
+
+SampleTiming analyzeSampleTiming(const std::vector<SteadyTime>& timestamps) {
+    SampleTiming timing;
+    if (timestamps.size() < 2) {
+        return timing;
+    }
+
+    size_t intervals = timestamps.size() - 1;
+    double span = secondsSince(timestamps.front(), timestamps.back());
+    if (span <= 0.0) {
+        return timing;
+    }
+    double meanInterval = span / intervals;
+    timing.effectiveRate = 1.0 / meanInterval;
+
+    double sumSquares = 0.0;
+    double maxDeviation = 0.0;
+    for (size_t i = 0; i < intervals; i++) {
+        double deviation = secondsSince(timestamps[i], timestamps[i + 1]) - meanInterval;
+        sumSquares += deviation * deviation;
+        maxDeviation = std::max(maxDeviation, std::abs(deviation));
+    }
+
+    timing.jitterRmsMicros = std::sqrt(sumSquares / intervals) * 1e6;
+    timing.jitterMaxMicros = maxDeviation * 1e6;
+    return timing;
+}
+
+void resampleUniform(const std::vector<int>& samples, const std::vector<SteadyTime>& timestamps,
+                     std::vector<int>& resampled) {
+    size_t n = std::min(samples.size(), timestamps.size());
+    resampled.resize(n);
+    if (n < 4) {
+        std::copy(samples.begin(), samples.begin() + n, resampled.begin());
+        return;
+    }
+
+    // Sample times relative to the first sample
+    std::vector<double> times(n);
+    for (size_t i = 0; i < n; i++) {
+        times[i] = secondsSince(timestamps.front(), timestamps[i]);
+    }
+    double step = times[n - 1] / (n - 1);
+
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        double t = i * step;
+
+        // Advance to the interval [times[k], times[k + 1]] containing t
+        while (k + 2 < n && times[k + 1] < t) {
+            k++;
+        }
+
+        // Four surrounding samples, shifted inwards at the edges
+        size_t first = std::min(k > 0 ? k - 1 : 0, n - 4);
+        double value = 0.0;
+        bool degenerate = false;
+        for (size_t a = first; a < first + 4 && !degenerate; a++) {
+            double weight = 1.0;
+            for (size_t b = first; b < first + 4; b++) {
+                if (a == b) {
+                    continue;
+                }
+                if (times[a] == times[b]) {
+                    degenerate = true;
+                    break;
+                }
+                weight *= (t - times[b]) / (times[a] - times[b]);
+            }
+            value += weight * samples[a];
+        }
+
+        // Duplicate timestamps: fall back to the nearest sample
+        resampled[i] = degenerate ? samples[k] : static_cast<int>(std::lround(value));
+    }
+}
@@ -49,42 +49,126 @@ void TriggerManager::cleanup() {
 }
 
 void TriggerManager::setTriggerCallback(std::function<void(std::chrono::time_point<std::chrono::steady_clock>)> callback) {
+    std::lock_guard<std::mutex> lock(triggerMutex);
     triggerCallback = callback;
 }
 
 void TriggerManager::update() {
     auto now = std::chrono::steady_clock::now();
+    std::function<void(std::chrono::time_point<std::chrono::steady_clock>)> callback;
+    std::chrono::time_point<std::chrono::steady_clock> triggerTime;
     
-    // State machine for the trigger
-    switch (state) {
-        case TriggerState::IDLE:
-            // Check if the sensor is triggered (ball detected)
-            if (readDigitalPin()) {
-                state = TriggerState::TRIGGERED;
-                lastTriggerTime = now;
+    {
+        std::lock_guard<std::mutex> lock(triggerMutex);
+        
+        // State machine for the trigger
+        switch (state) {
+            case TriggerState::IDLE:
+                // Check if the sensor is triggered (ball detected)
+                if (mode != TriggerMode::Radar && readDigitalPin()) {
+                    Logger::debug("IR Trigger activated");
+                    if (mode != TriggerMode::Both) {
+                        triggerTime = now;
+                        callback = fire(now);
+                    } else if (radarPending && now - radarPendingTime <= coincidenceWindow) {
+                        // The radar saw it too; its timestamp is the precise one
+                        triggerTime = radarPendingTime;
+                        callback = fire(radarPendingTime);
+                    } else if (!irPending || now - irPendingTime > coincidenceWindow) {
+                        irPending = true;
+                        irPendingTime = now;
+                    }
+                }
+                break;
                 
-                Logger::debug("IR Trigger activated");
+            case TriggerState::TRIGGERED:
+                // Transition to cooldown state
+                state = TriggerState::COOLDOWN;
+                break;
                 
-                // Call the registered callback if there is one
-                if (triggerCallback) {
-                    triggerCallback(lastTriggerTime);
+            case TriggerState::COOLDOWN:
+                // Wait for cooldown period to avoid multiple triggers
+                if (now - lastTriggerTime >= cooldownPeriod) {
+                    state = TriggerState::IDLE;
+                    Logger::debug("IR Trigger cooldown complete");
                 }
-            }
-            break;
-            
-        case TriggerState::TRIGGERED:
-            // Transition to cooldown state
-            state = TriggerState::COOLDOWN;
-            break;
-            
-        case TriggerState::COOLDOWN:
-            // Wait for cooldown period to avoid multiple triggers
-            if (now - lastTriggerTime >= cooldownPeriod) {
-                state = TriggerState::IDLE;
-                Logger::debug("IR Trigger cooldown complete");
-            }
-            break;
+                break;
+        }
+    }
+    
+    // Call the registered callback if there is one
+    if (callback) {
+        callback(triggerTime);
+    }
+}
+
+void TriggerManager::radarTriggered(std::chrono::time_point<std::chrono::steady_clock> time) {
+    std::function<void(std::chrono::time_point<std::chrono::steady_clock>)> callback;
+    {
+        std::lock_guard<std::mutex> lock(triggerMutex);
+        if (mode == TriggerMode::Ir) {
+            return;
+        }
+        // update() may not have run to end the cooldown yet
+        if (state != TriggerState::IDLE && time - lastTriggerTime < cooldownPeriod) {
+            return;
+        }
+        Logger::debug("Radar trigger activated");
+        
+        if (mode != TriggerMode::Both) {
+            callback = fire(time);
+        } else if (irPending && time - irPendingTime <= coincidenceWindow &&
+                   irPendingTime - time <= coincidenceWindow) {
+            callback = fire(time);
+        } else {
+            radarPending = true;
+            radarPendingTime = time;
+        }
+    }
+    if (callback) {
+        callback(time);
+    }
+}
+
+std::function<void(std::chrono::time_point<std::chrono::steady_clock>)> TriggerManager::fire(
+    std::chrono::time_point<std::chrono::steady_clock> time) {
+    state = TriggerState::TRIGGERED;
+    lastTriggerTime = time;
+    irPending = false;
+    radarPending = false;
+    return triggerCallback;
+}
+
+void TriggerManager::setTriggerMode(TriggerMode newMode) {
+    std::lock_guard<std::mutex> lock(triggerMutex);
+    mode = newMode;
+    irPending = false;
+    radarPending = false;
+}
+
+TriggerMode TriggerManager::getTriggerMode() const {
+    std::lock_guard<std::mutex> lock(triggerMutex);
+    return mode;
+}
+
+std::string triggerModeName(TriggerMode mode) {
+    switch (mode) {
+        case TriggerMode::Ir: return "ir";
+        case TriggerMode::Radar: return "radar";
+        case TriggerMode::Either: return "either";
+        case TriggerMode::Both: return "both";
     }
+    return "unknown";
+}
+
+bool parseTriggerMode(const std::string& name, TriggerMode& mode) {
+    for (TriggerMode candidate : {TriggerMode::Ir, TriggerMode::Radar, TriggerMode::Either, TriggerMode::Both}) {
+        if (name == triggerModeName(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
 }
 
 bool TriggerManager::readDigitalPin() {
@@ -109,13 +193,16 @@ bool TriggerManager::readDigitalPin() {
 
 void TriggerManager::simulateTrigger() {
     auto now = std::chrono::steady_clock::now();
-    lastTriggerTime = now;
-    state = TriggerState::TRIGGERED;
+    std::function<void(std::chrono::time_point<std::chrono::steady_clock>)> callback;
+    {
+        std::lock_guard<std::mutex> lock(triggerMutex);
+        callback = fire(now);
+    }
     
     Logger::debug("IR Trigger manually simulated");
     
     // Call the registered callback if there is one
-    if (triggerCallback) {
-        triggerCallback(lastTriggerTime);
+    if (callback) {
+        callback(now);
     }
 }
@@ -0,0 +1,229 @@
+#include "window.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+// Generalized cosine window: sum of a[k] * cos(2 pi k i / (size - 1)) with alternating signs
+std::vector<double> cosineWindow(size_t size, const std::vector<double>& coefficients) {
+    std::vector<double> window(size);
+    for (size_t i = 0; i < size; i++) {
+        double x = 2.0 * M_PI * i / (size - 1);
+        double value = 0.0;
+        double sign = 1.0;
+        for (size_t k = 0; k < coefficients.size(); k++) {
+            value += sign * coefficients[k] * std::cos(k * x);
+            sign = -sign;
+        }
+        window[i] = value;
+    }
+    return window;
+}
+
+// Zeroth order modified Bessel function of the first kind
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    double quarterSquare = x * x / 4.0;
+    for (int k = 1; k < 50; k++) {
+        term *= quarterSquare / (static_cast<double>(k) * k);
+        sum += term;
+        if (term < sum * 1e-17) {
+            break;
+        }
+    }
+    return sum;
+}
+
+std::vector<double> kaiserWindow(size_t size, double beta) {
+    std::vector<double> window(size);
+    double denominator = besselI0(beta);
+    for (size_t i = 0; i < size; i++) {
+        double r = 2.0 * i / (size - 1) - 1.0;
+        window[i] = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / denominator;
+    }
+    return window;
+}
+}
+
+std::vector<double> makeWindow(WindowType type, size_t size, double kaiserBeta) {
+    if (size < 2) {
+        return std::vector<double>(size, 1.0);
+    }
+    
+    switch (type) {
+        case WindowType::Hamming:
+            return cosineWindow(size, {0.54, 0.46});
+        case WindowType::Hann:
+            return cosineWindow(size, {0.5, 0.5});
+        case WindowType::BlackmanHarris:
+            return cosineWindow(size, {0.35875, 0.48829, 0.14128, 0.01168});
+        case WindowType::Kaiser:
+            return kaiserWindow(size, kaiserBeta);
+        case WindowType::FlatTop:
+            return cosineWindow(size, {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368});
+    }
+    return std::vector<double>(size, 1.0);
+}
+
+std::string windowTypeName(WindowType type) {
+    switch (type) {
+        case WindowType::Hamming: return "hamming";
+        case WindowType::Hann: return "hann";
+        case WindowType::BlackmanHarris: return "blackman-harris";
+        case WindowType::Kaiser: return "kaiser";
+        case WindowType::FlatTop: return "flat-top";
+    }
+    return "unknown";
+}
+
+bool parseWindowType(const std::string& name, WindowType& type) {
+    for (WindowType candidate : {WindowType::Hamming, WindowType::Hann, WindowType::BlackmanHarris,
+                                 WindowType::Kaiser, WindowType::FlatTop}) {
+        if (name == windowTypeName(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const WindowCache::Table& WindowCache::table(WindowType type, size_t size, double kaiserBeta) {
+    // Beta doesn't change any other window, so don't cache copies per beta
+    if (type != WindowType::Kaiser) {
+        kaiserBeta = 0.0;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = tables[Key(type, size, kaiserBeta)];
+    if (!entry) {
+        std::vector<double> window = makeWindow(type, size, kaiserBeta);
+        auto table = std::make_unique<Table>();
+        table->coefficients.assign(window.begin(), window.end());
+        table->singleCoefficients.assign(window.begin(), window.end());
+        for (double coefficient : window) {
+            double fixed = std::round(coefficient * (1 << WINDOW_FRACTION_BITS));
+            table->fixedCoefficients.push_back(static_cast<int16_t>(std::max(-32768.0, std::min(32767.0, fixed))));
+        }
+        entry = std::move(table);
+    }
+    return *entry;
+}
+
+const AlignedVector<double>& WindowCache::get(WindowType type, size_t size, double kaiserBeta) {
+    return table(type, size, kaiserBeta).coefficients;
+}
+
+const AlignedVector<float>& WindowCache::getSingle(WindowType type, size_t size, double kaiserBeta) {
+    return table(type, size, kaiserBeta).singleCoefficients;
+}
+
+const AlignedVector<int16_t>& WindowCache::getFixed(WindowType type, size_t size, double kaiserBeta) {
+    return table(type, size, kaiserBeta).fixedCoefficients;
+}
+
+size_t WindowCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tables.size();
+}
+
+namespace {
+template <typename Real>
+Real windowSamplesAs(const int* __restrict samples, size_t count, const Real* __restrict window,
+                     Real* __restrict out) {
+    if (count == 0) {
+        return 0;
+    }
+    
+    // Integer sum is exact, and ADC values are far too small to overflow it
+    int64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    Real mean = static_cast<Real>(static_cast<double>(sum) / count);
+    
+    // No trig and no dependencies between iterations, so this vectorizes
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (static_cast<Real>(samples[i]) - mean) * window[i];
+    }
+    return mean;
+}
+}
+
+double windowSamples(const int* samples, size_t count, const double* window, double* out) {
+    return windowSamplesAs(samples, count, window, out);
+}
+
+float windowSamples(const int* samples, size_t count, const float* window, float* out) {
+    return windowSamplesAs(samples, count, window, out);
+}
+
+namespace {
+template <typename Real>
+void applyWindowAs(const int* __restrict samples, size_t count, const Real* __restrict window,
+                   Real* __restrict out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = static_cast<Real>(samples[i]) * window[i];
+    }
+}
+}
+
+void applyWindow(const int* samples, size_t count, const double* window, double* out) {
+    applyWindowAs(samples, count, window, out);
+}
+
+void applyWindow(const int* samples, size_t count, const float* window, float* out) {
+    applyWindowAs(samples, count, window, out);
+}
+
+namespace {
+// Fraction bits kept of the mean when centering fixed-point samples
+constexpr int MEAN_FRACTION_BITS = 3;
+// Largest span of sample values the 32-bit products can take: 2^12 counts
+// with 3 fraction bits times a Q15 coefficient stays within 2^30
+constexpr int FIXED_POINT_SPAN = 4096;
+
+template <typename Real>
+Real windowFixedAs(const int16_t* __restrict samples, size_t count, const int16_t* __restrict window,
+                   Real* __restrict out) {
+    if (count == 0) {
+        return 0;
+    }
+    
+    int64_t sum = 0;
+    int16_t low = samples[0];
+    int16_t high = samples[0];
+    for (size_t i = 0; i < count; i++) {
+        sum += samples[i];
+        low = std::min(low, samples[i]);
+        high = std::max(high, samples[i]);
+    }
+    double mean = static_cast<double>(sum) / count;
+    
+    if (high - low >= FIXED_POINT_SPAN) {
+        const double windowScale = 1.0 / (1 << WINDOW_FRACTION_BITS);
+        for (size_t i = 0; i < count; i++) {
+            out[i] = static_cast<Real>((samples[i] - mean) * window[i] * windowScale);
+        }
+        return static_cast<Real>(mean);
+    }
+    
+    // Integer multiplies on 16-bit lanes widened to 32 bits, which NEON and
+    // SSE both have
+    const Real scale = Real(1) / (1 << (MEAN_FRACTION_BITS + WINDOW_FRACTION_BITS));
+    int32_t fixedMean = static_cast<int32_t>(std::lround(mean * (1 << MEAN_FRACTION_BITS)));
+    for (size_t i = 0; i < count; i++) {
+        int32_t centered = (static_cast<int32_t>(samples[i]) << MEAN_FRACTION_BITS) - fixedMean;
+        out[i] = static_cast<Real>(centered * static_cast<int32_t>(window[i])) * scale;
+    }
+    return static_cast<Real>(mean);
+}
+}
+
+double windowSamples(const int16_t* samples, size_t count, const int16_t* window, double* out) {
+    return windowFixedAs(samples, count, window, out);
+}
+
+float windowSamples(const int16_t* samples, size_t count, const int16_t* window, float* out) {
+    return windowFixedAs(samples, count, window, out);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+#include "czt.hpp"
+#include "spectrum.hpp"
+#include "window.hpp"
+
+namespace {
+// Hann windowed tone at `bin` (in bins of a size-point DFT)
+std::vector<double> windowedTone(size_t size, double bin) {
+    std::vector<double> window = makeWindow(WindowType::Hann, size);
+    std::vector<double> samples(size);
+    for (size_t i = 0; i < size; i++) {
+        samples[i] = window[i] * 300.0 * std::cos(2.0 * M_PI * bin * i / size + 0.4);
+    }
+    return samples;
+}
+}
+
+// Test the zoomed spectrum against the DFT evaluated directly
+TEST(ChirpZTest, MatchesDirectDft) {
+    FftPlanCache plans;
+    const size_t size = 256;
+    ChirpZ zoom(plans, size, 40.0, 60.0, 81, FFT_PLAN_ESTIMATE);
+    EXPECT_DOUBLE_EQ(zoom.spacing(), 0.25);
+    EXPECT_DOUBLE_EQ(zoom.bin(4), 41.0);
+    
+    std::vector<double> samples = windowedTone(size, 47.3);
+    std::vector<double> powers(zoom.points());
+    zoom.powers(samples.data(), powers.data());
+    for (size_t k = 0; k < zoom.points(); k++) {
+        std::complex<double> sum;
+        for (size_t n = 0; n < size; n++) {
+            sum += samples[n] * std::polar(1.0, -2.0 * M_PI * zoom.bin(k) * n / size);
+        }
+        ASSERT_NEAR(powers[k], std::norm(sum), 1e-6 * std::norm(sum) + 1e-6) << k;
+    }
+    
+    // Single precision input gives the same spectrum
+    std::vector<float> single(samples.begin(), samples.end());
+    std::vector<double> singlePowers(zoom.points());
+    zoom.powers(single.data(), singlePowers.data());
+    for (size_t k = 0; k < zoom.points(); k++) {
+        ASSERT_NEAR(singlePowers[k], powers[k], 1e-4 * powers[k] + 1e-3) << k;
+    }
+}
+
+// Test that a tone between bins is located far more finely than the FFT bins
+TEST(ChirpZTest, LocatesToneBetweenBins) {
+    FftPlanCache plans;
+    const size_t size = 1024;
+    ChirpZ zoom(plans, size, 150.0, 450.0, 3001, FFT_PLAN_ESTIMATE);
+    for (double bin : {200.37, 321.81, 400.5}) {
+        std::vector<double> samples = windowedTone(size, bin);
+        std::vector<double> powers(zoom.points());
+        zoom.powers(samples.data(), powers.data());
+        size_t best = 1;
+        for (size_t k = 1; k + 1 < powers.size(); k++) {
+            if (powers[k] > powers[best]) {
+                best = k;
+            }
+        }
+        double fine = parabolicPeakOffset(powers[best - 1], powers[best], powers[best + 1]);
+        EXPECT_NEAR(zoom.bin(best + fine), bin, 0.002) << bin;
+    }
+}
+
+// Test that transforms and their plans are built once and shared
+TEST(ChirpZTest, CacheReusesTransforms) {
+    FftPlanCache plans;
+    ChirpZCache cache;
+    const ChirpZ& first = cache.get(plans, 512, 60, 200, 1024, FFT_PLAN_ESTIMATE);
+    EXPECT_EQ(&cache.get(plans, 512, 60, 200, 1024, FFT_PLAN_ESTIMATE), &first);
+    cache.get(plans, 512, 60, 180, 1024, FFT_PLAN_ESTIMATE);
+    EXPECT_EQ(cache.size(), 2u);
+    // 512 + 1024 - 1 samples convolve in 2048 point FFTs, forward and backward
+    EXPECT_EQ(plans.size(), 2u);
+    
+    EXPECT_THROW(cache.get(plans, 512, 200, 60, 1024, FFT_PLAN_ESTIMATE), std::invalid_argument);
+    EXPECT_EQ(cache.size(), 2u);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include "energy_trigger.hpp"
+#include "sample_source.hpp"
+
+namespace {
+const int RATE = 10000;
+
+// Synthetic ball returns every `intervalMs`, impact 40 ms into each interval
+std::vector<int> shots(size_t count, float intervalMs, float ballAmplitude = 200.0f) {
+    SyntheticSignal signal;
+    signal.ballSpeedMPH = 140.0f;
+    signal.ballAmplitude = ballAmplitude;
+    signal.shotIntervalMs = intervalMs;
+    SyntheticSampleSource source(signal, RATE);
+    std::vector<int> samples(count);
+    source.read(samples.data(), count);
+    return samples;
+}
+
+// Write samples as a raw recording and replay it as fast as it can be read
+std::vector<int> replay(const std::vector<int>& samples, std::vector<SteadyTime>& times) {
+    std::string path = "/tmp/energy_trigger_test.raw";
+    {
+        std::ofstream out(path, std::ios::binary);
+        for (int sample : samples) {
+            int16_t value = static_cast<int16_t>(sample);
+            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+    }
+    FileSampleSource source(path, 0.0, false, RATE);
+    std::vector<int> replayed(source.totalSamples());
+    times.resize(replayed.size());
+    source.read(replayed.data(), replayed.size(), times.data());
+    std::remove(path.c_str());
+    return replayed;
+}
+
+// Sample indexes the trigger fires at
+std::vector<uint64_t> detect(RadarEnergyTrigger& trigger, const std::vector<int>& samples, size_t block = 64) {
+    std::vector<uint64_t> fired;
+    trigger.setCallback([&fired](const EnergyTriggerEvent& event) { fired.push_back(event.sample); });
+    for (size_t i = 0; i < samples.size(); i += block) {
+        trigger.push(samples.data() + i, std::min(block, samples.size() - i));
+    }
+    return fired;
+}
+}
+
+// Test that noise alone never fires
+TEST(EnergyTriggerTest, QuietStream) {
+    RadarEnergyTrigger trigger(RATE);
+    EXPECT_TRUE(detect(trigger, shots(20000, 0.0f, 0.0f)).empty());
+    EXPECT_GT(trigger.noiseFloor(), 0.0);
+}
+
+// Test that each shot fires once, within a window of impact
+TEST(EnergyTriggerTest, DetectsEachShot) {
+    RadarEnergyTrigger trigger(RATE);
+    std::vector<uint64_t> fired = detect(trigger, shots(30000, 1000.0f));
+    ASSERT_EQ(fired.size(), 3u);
+    for (size_t i = 0; i < fired.size(); i++) {
+        uint64_t impact = 400 + i * 10000;
+        EXPECT_GE(fired[i], impact) << i;
+        EXPECT_LT(fired[i], impact + 64) << i;
+    }
+}
+
+// Test replaying a recording gives the same detections as the live stream
+TEST(EnergyTriggerTest, ReplayedRecording) {
+    std::vector<int> samples = shots(20000, 700.0f);
+    std::vector<SteadyTime> times;
+    std::vector<int> replayed = replay(samples, times);
+    ASSERT_EQ(replayed.size(), samples.size());
+
+    RadarEnergyTrigger live(RATE);
+    RadarEnergyTrigger fromFile(RATE);
+    std::vector<uint64_t> expected = detect(live, samples);
+    std::vector<EnergyTriggerEvent> events;
+    fromFile.setCallback([&events](const EnergyTriggerEvent& event) { events.push_back(event); });
+    fromFile.push(replayed.data(), replayed.size(), times.data());
+
+    ASSERT_EQ(events.size(), expected.size());
+    ASSERT_EQ(events.size(), 3u);
+    for (size_t i = 0; i < events.size(); i++) {
+        EXPECT_EQ(events[i].sample, expected[i]);
+        EXPECT_EQ(events[i].time, times[events[i].sample]);
+        EXPECT_GT(events[i].energyRatio, 10.0);
+    }
+}
+
+// Test replayed streams with no noise in them. A return already under way
+// when the replay starts doesn't fire during the warm-up; once the floor has
+// settled at zero, rounding doesn't fire either, while a real return does.
+TEST(EnergyTriggerTest, NoiseFreeReplay) {
+    double frequency = 140.0 / 2.23694 * 2.0 * 10.525e9 / 299792458.0;
+    auto addTone = [frequency](std::vector<int>& samples, size_t first, size_t last, double amplitude) {
+        for (size_t i = first; i < last; i++) {
+            samples[i] += static_cast<int>(std::lround(amplitude * std::sin(2.0 * M_PI * frequency * i / RATE)));
+        }
+    };
+    std::vector<SteadyTime> times;
+
+    std::vector<int> midShot(2000, 512);
+    addTone(midShot, 0, 400, 200.0);
+    RadarEnergyTrigger warmingUp(RATE);
+    EXPECT_TRUE(detect(warmingUp, replay(midShot, times)).empty());
+
+    // One count of in-band ripple, then a ball
+    std::vector<int> quiet(20000, 512);
+    addTone(quiet, 8000, 9000, 1.0);
+    addTone(quiet, 15000, 15500, 200.0);
+    RadarEnergyTrigger trigger(RATE);
+    std::vector<uint64_t> fired = detect(trigger, replay(quiet, times));
+    ASSERT_EQ(fired.size(), 1u);
+    EXPECT_GE(fired[0], 15000u);
+    EXPECT_LT(fired[0], 15064u);
+}
+
+// Test that strong movement outside the band is ignored
+TEST(EnergyTriggerTest, IgnoresOutOfBandReturns) {
+    // Someone walking past at 8 mph, fading in over 20 ms on top of the noise
+    std::vector<int> samples = shots(20000, 0.0f, 0.0f);
+    double frequency = 8.0 / 2.23694 * 2.0 * 10.525e9 / 299792458.0;
+    for (size_t i = 5000; i < samples.size(); i++) {
+        double gain = std::min(1.0, (i - 5000) / 200.0);
+        samples[i] += static_cast<int>(300.0 * gain * std::sin(2.0 * M_PI * frequency * i / RATE));
+    }
+
+    RadarEnergyTrigger trigger(RATE);
+    EXPECT_TRUE(detect(trigger, samples).empty());
+}
+
+// Test the band and configuration checks
+TEST(EnergyTriggerTest, Band) {
+    RadarEnergyTrigger trigger(RATE);
+    // 40 mph is ~1255 Hz and 200 mph is beyond Nyquist, with 156 Hz bins
+    EXPECT_EQ(trigger.firstBin(), 9);
+    EXPECT_EQ(trigger.lastBin(), 31);
+
+    EnergyTriggerConfig config;
+    config.minSpeedMPH = 190.0f;
+    EXPECT_THROW(RadarEnergyTrigger(RATE, config), std::invalid_argument);
+    config = EnergyTriggerConfig();
+    config.windowSize = 4;
+    EXPECT_THROW(RadarEnergyTrigger(RATE, config), std::invalid_argument);
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "fft_plan_cache.hpp"
+
+#ifdef HAVE_FFTW
+#include <fftw3.h>
+#endif
+
+// Test that plans are created once per key and reused
+TEST(FftPlanCacheTest, ReusesPlans) {
+    FftPlanCache cache;
+    FftPlan* plan = cache.get({1024, FftDirection::RealToComplex, FftPrecision::Double, FFT_PLAN_ESTIMATE});
+    ASSERT_NE(plan, nullptr);
+    EXPECT_EQ(plan->size(), 1024);
+    EXPECT_EQ(cache.get({1024, FftDirection::RealToComplex, FftPrecision::Double, FFT_PLAN_ESTIMATE}), plan);
+    
+    // Any part of the key makes a different plan
+    EXPECT_NE(cache.get({2048, FftDirection::RealToComplex, FftPrecision::Double, FFT_PLAN_ESTIMATE}), plan);
+    EXPECT_NE(cache.get({1024, FftDirection::ComplexToReal, FftPrecision::Double, FFT_PLAN_ESTIMATE}), plan);
+    EXPECT_NE(cache.get({1024, FftDirection::RealToComplex, FftPrecision::Single, FFT_PLAN_ESTIMATE}), plan);
+    EXPECT_EQ(cache.size(), 4u);
+    
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+// Test that invalid sizes are rejected
+TEST(FftPlanCacheTest, RejectsInvalidSize) {
+    FftPlanCache cache;
+    EXPECT_EQ(cache.get({0, FftDirection::Forward, FftPrecision::Double, FFT_PLAN_ESTIMATE}), nullptr);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+#ifdef HAVE_FFTW
+// Test a real-to-complex transform of a non-power-of-two length
+TEST(FftPlanCacheTest, RealToComplexAnySize) {
+    FftPlanCache cache;
+    for (int size : {512, 1000, 4096}) {
+        FftPlan* plan = cache.get({size, FftDirection::RealToComplex, FftPrecision::Double, FFT_PLAN_ESTIMATE});
+        ASSERT_NE(plan, nullptr);
+        
+        // Cosine exactly on bin 37
+        double* in = plan->input<double>();
+        for (int i = 0; i < size; i++) {
+            in[i] = std::cos(2.0 * M_PI * 37 * i / size);
+        }
+        plan->execute();
+        
+        FftComplex* out = plan->output<FftComplex>();
+        EXPECT_NEAR(out[37][0], size / 2.0, 1e-6 * size) << size;
+        EXPECT_NEAR(out[36][0], 0.0, 1e-6 * size) << size;
+    }
+}
+#endif
+
+// Test a single precision round trip through the forward and inverse real transforms
+TEST(FftPlanCacheTest, SinglePrecisionRoundTrip) {
+    const int size = 256;
+    FftPlanCache cache;
+    FftPlan* forward = cache.get({size, FftDirection::RealToComplex, FftPrecision::Single, FFT_PLAN_ESTIMATE});
+    FftPlan* inverse = cache.get({size, FftDirection::ComplexToReal, FftPrecision::Single, FFT_PLAN_ESTIMATE});
+    ASSERT_NE(forward, nullptr);
+    ASSERT_NE(inverse, nullptr);
+    
+    float* in = forward->input<float>();
+    for (int i = 0; i < size; i++) {
+        in[i] = static_cast<float>(std::sin(0.1 * i) + 0.25 * i / size);
+    }
+    forward->execute();
+    
+    FftComplexF* spectrum = forward->output<FftComplexF>();
+    FftComplexF* inverseIn = inverse->input<FftComplexF>();
+    for (int i = 0; i < size / 2 + 1; i++) {
+        inverseIn[i][0] = spectrum[i][0];
+        inverseIn[i][1] = spectrum[i][1];
+    }
+    inverse->execute();
+    
+    // FFTW's inverse is unnormalized
+    float* out = inverse->output<float>();
+    for (int i = 0; i < size; i++) {
+        EXPECT_NEAR(out[i] / size, std::sin(0.1 * i) + 0.25 * i / size, 1e-4);
+    }
+}
+
+// Test a complex forward transform
+TEST(FftPlanCacheTest, ComplexForward) {
+    const int size = 64;
+    FftPlanCache cache;
+    FftPlan* plan = cache.get({size, FftDirection::Forward, FftPrecision::Double, FFT_PLAN_ESTIMATE});
+    ASSERT_NE(plan, nullptr);
+    
+    // e^(2 pi i 5 n / N) lands entirely in bin 5
+    FftComplex* in = plan->input<FftComplex>();
+    for (int i = 0; i < size; i++) {
+        in[i][0] = std::cos(2.0 * M_PI * 5 * i / size);
+        in[i][1] = std::sin(2.0 * M_PI * 5 * i / size);
+    }
+    plan->execute();
+    
+    FftComplex* out = plan->output<FftComplex>();
+    EXPECT_NEAR(out[5][0], size, 1e-9);
+    EXPECT_NEAR(out[size - 5][0], 0.0, 1e-9);
+}
+
+#ifdef HAVE_FFTW
+// Test falling back to an estimated plan when there is no wisdom
+TEST(FftPlanCacheTest, WisdomOnlyFallsBackToEstimate) {
+    fftw_forget_wisdom();
+    FftPlanCache cache;
+    FftPlan* plan = cache.get({768, FftDirection::RealToComplex, FftPrecision::Double,
+                               FFT_PLAN_MEASURE | FFT_PLAN_WISDOM_ONLY});
+    ASSERT_NE(plan, nullptr);
+    EXPECT_EQ(plan->key().flags, static_cast<unsigned>(FFT_PLAN_ESTIMATE));
+    
+    // Cached under the requested flags
+    EXPECT_EQ(cache.get({768, FftDirection::RealToComplex, FftPrecision::Double,
+                         FFT_PLAN_MEASURE | FFT_PLAN_WISDOM_ONLY}), plan);
+}
+
+// Test saving wisdom and using it to plan after a restart
+TEST(FftPlanCacheTest, WisdomRoundTrip) {
+    std::string path = "/tmp/fft_plan_cache_test.wisdom";
+    fftw_forget_wisdom();
+    fftwf_forget_wisdom();
+    EXPECT_FALSE(importFftWisdom(path + ".missing"));
+    
+    ASSERT_TRUE(planFftWisdom({384}));
+    ASSERT_TRUE(exportFftWisdom(path));
+    
+    // Simulate a fresh boot
+    fftw_forget_wisdom();
+    fftwf_forget_wisdom();
+    ASSERT_TRUE(importFftWisdom(path));
+    
+    FftPlanCache cache;
+    for (FftPrecision precision : {FftPrecision::Double, FftPrecision::Single}) {
+        FftPlan* plan = cache.get({384, FftDirection::RealToComplex, precision,
+                                   FFT_PLAN_MEASURE | FFT_PLAN_WISDOM_ONLY});
+        ASSERT_NE(plan, nullptr);
+        EXPECT_EQ(plan->key().flags, static_cast<unsigned>(FFT_PLAN_MEASURE | FFT_PLAN_WISDOM_ONLY));
+    }
+    
+    std::remove(path.c_str());
+    std::remove((path + ".float").c_str());
+}
+#endif
+
+// Test several threads running one shared plan on their own workspaces
+TEST(FftPlanCacheTest, ConcurrentExecuteWithWorkspaces) {
+    const int size = 512;
+    FftPlanCache cache;
+    FftPlan* plan = cache.get({size, FftDirection::RealToComplex, FftPrecision::Single, FFT_PLAN_ESTIMATE});
+    ASSERT_NE(plan, nullptr);
+    
+    const int threadCount = 4;
+    std::vector<int> wrongResults(threadCount, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+            FftWorkspace workspace;
+            float* in = workspace.input<float>(*plan);
+            FftComplexF* out = workspace.output<FftComplexF>(*plan);
+            EXPECT_NE(static_cast<void*>(in), plan->input<void>());
+            
+            // Every thread transforms a tone in a different bin
+            int bin = 10 + 20 * t;
+            for (int iteration = 0; iteration < 50; iteration++) {
+                for (int i = 0; i < size; i++) {
+                    in[i] = static_cast<float>(std::cos(2.0 * M_PI * bin * i / size));
+                }
+                plan->execute(in, out);
+                if (std::abs(out[bin][0] - size / 2.0f) > 0.01f * size || std::abs(out[bin + 1][0]) > 0.01f * size) {
+                    wrongResults[t]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    for (int t = 0; t < threadCount; t++) {
+        EXPECT_EQ(wrongResults[t], 0) << "thread " << t;
+    }
+}
+
+// Test that a workspace reuses its arrays
+TEST(FftPlanCacheTest, WorkspaceReusesArrays) {
+    FftPlanCache cache;
+    FftPlan* plan = cache.get({256, FftDirection::Forward, FftPrecision::Double, FFT_PLAN_ESTIMATE});
+    ASSERT_NE(plan, nullptr);
+    
+    FftWorkspace workspace;
+    FftComplex* in = workspace.input<FftComplex>(*plan);
+    EXPECT_EQ(workspace.input<FftComplex>(*plan), in);
+    EXPECT_NE(workspace.output<FftComplex>(*plan), in);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "fir.hpp"
+
+namespace {
+const size_t TAPS = 127;
+
+std::vector<float> tone(size_t count, double frequency, double rate, double amplitude = 1.0) {
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = static_cast<float>(amplitude * std::sin(2.0 * M_PI * frequency * i / rate));
+    }
+    return samples;
+}
+
+// RMS of the filtered tone once the filter has filled
+double gainAt(double frequency, double rate) {
+    FirDecimator<TAPS> filter(designBandPass(TAPS, 300.0, 4500.0, rate), 1);
+    std::vector<float> samples = tone(4096, frequency, rate);
+    std::vector<float> out(samples.size() + 1);
+    size_t count = filter.process(samples.data(), samples.size(), out.data());
+    double sum = 0.0;
+    for (size_t i = TAPS; i < count; i++) {
+        sum += out[i] * out[i];
+    }
+    return std::sqrt(2.0 * sum / (count - TAPS));
+}
+}
+
+// Test the band-pass response in and out of the band
+TEST(FirTest, BandPassResponse) {
+    const double rate = 10000.0;
+    EXPECT_NEAR(gainAt(2400.0, rate), 1.0, 0.01);
+    EXPECT_NEAR(gainAt(1250.0, rate), 1.0, 0.01);
+    EXPECT_LT(gainAt(50.0, rate), 0.001);
+    EXPECT_LT(gainAt(100.0, rate), 0.01);
+    
+    // DC is removed entirely
+    FirDecimator<TAPS> filter(designBandPass(TAPS, 300.0, 4500.0, rate), 1);
+    std::vector<int> offset(1024, 512);
+    std::vector<float> out(offset.size() + 1);
+    filter.process(offset.data(), offset.size(), out.data());
+    EXPECT_NEAR(out.back(), 0.0f, 0.05f);
+}
+
+// Test that pushing in blocks gives the same output as one block, and that
+// decimated outputs are the kept samples of the full rate filter
+TEST(FirTest, DecimationMatchesFullRate) {
+    const double rate = 40000.0;
+    std::vector<float> coefficients = designBandPass(TAPS, 300.0, 4500.0, rate);
+    std::vector<float> samples = tone(4000, 2000.0, rate, 300.0);
+    
+    FirDecimator<TAPS> full(coefficients, 1);
+    std::vector<float> fullOut(samples.size() + 1);
+    ASSERT_EQ(full.process(samples.data(), samples.size(), fullOut.data()), samples.size());
+    
+    FirDecimator<TAPS> decimator(coefficients, 4);
+    std::vector<float> out;
+    for (size_t i = 0; i < samples.size(); i += 37) {
+        size_t count = std::min<size_t>(37, samples.size() - i);
+        std::vector<float> block(count / 4 + 1);
+        size_t written = decimator.process(samples.data() + i, count, block.data());
+        out.insert(out.end(), block.begin(), block.begin() + written);
+    }
+    ASSERT_EQ(out.size(), 1000u);
+    for (size_t i = 0; i < out.size(); i++) {
+        ASSERT_NEAR(out[i], fullOut[4 * i + 3], 1e-3f) << i;
+    }
+    
+    // Against the convolution written out
+    for (size_t n : {200u, 1001u, 3999u}) {
+        double expected = 0.0;
+        for (size_t k = 0; k < TAPS && k <= n; k++) {
+            expected += coefficients[k] * samples[n - k];
+        }
+        EXPECT_NEAR(fullOut[n], expected, 1e-3) << n;
+    }
+    
+    decimator.reset();
+    float value;
+    EXPECT_FALSE(decimator.push(1.0f, value));
+    EXPECT_EQ(decimator.factor(), 4);
+    EXPECT_DOUBLE_EQ(FirDecimator<TAPS>::groupDelay(), 63.0);
+}
+
+// Test that bad designs are rejected
+TEST(FirTest, InvalidDesign) {
+    EXPECT_THROW(designBandPass(TAPS, 2000.0, 1000.0, 10000.0), std::invalid_argument);
+    EXPECT_THROW(designBandPass(TAPS, 100.0, 6000.0, 10000.0), std::invalid_argument);
+    EXPECT_THROW(FirDecimator<TAPS>(designBandPass(63, 100.0, 2000.0, 10000.0), 2), std::invalid_argument);
+    EXPECT_THROW(FirDecimator<TAPS>(designBandPass(TAPS, 100.0, 2000.0, 10000.0), 0), std::invalid_argument);
+}
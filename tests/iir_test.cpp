@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "iir.hpp"
+
+namespace {
+constexpr double RATE = 10000.0;
+
+// Steady-state gain of a cascade for a tone at `frequency`
+double toneGain(BiquadCascade& filter, double frequency) {
+    filter.reset();
+    double sumSquares = 0.0;
+    const int count = static_cast<int>(RATE);
+    for (int i = 0; i < count; i++) {
+        double out = filter.push(static_cast<float>(std::sin(2.0 * M_PI * frequency * i / RATE)));
+        // Only the second half, after the transient
+        if (i >= count / 2) {
+            sumSquares += out * out;
+        }
+    }
+    return std::sqrt(2.0 * sumSquares / (count / 2));
+}
+}
+
+// Test that the DC blocker follows a drifting offset and passes the tone on it
+TEST(IirTest, DcBlockerFollowsDrift) {
+    DcBlocker blocker(5.0, RATE);
+    EXPECT_NEAR(blocker.poleRadius(), std::exp(-2.0 * M_PI * 5.0 / RATE), 1e-12);
+    
+    // Primed by the first sample rather than ringing down from it
+    EXPECT_EQ(blocker.push(512.0f), 0.0f);
+    
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    int measured = 0;
+    for (int i = 1; i < 10000; i++) {
+        double offset = 512.0 + 80.0 * i / 10000.0;  // Drifting 80 counts a second
+        float out = blocker.push(static_cast<float>(offset + 100.0 * std::sin(2.0 * M_PI * 3000.0 * i / RATE)));
+        if (i >= 5000) {
+            sum += out;
+            sumSquares += static_cast<double>(out) * out;
+            measured++;
+        }
+    }
+    // A ramp leaves a constant residue of slope / (2 pi fc), 2.5 counts here
+    EXPECT_NEAR(sum / measured, 80.0 / (2.0 * M_PI * 5.0), 0.2);
+    double variance = sumSquares / measured - (sum / measured) * (sum / measured);
+    EXPECT_NEAR(std::sqrt(2.0 * variance), 100.0, 1.0);
+}
+
+// Test the response of a fourth order Butterworth high-pass
+TEST(IirTest, ButterworthHighPass) {
+    std::vector<BiquadCoefficients> sections = designButterworthHighPass(2, 100.0, RATE);
+    ASSERT_EQ(sections.size(), 2u);
+    BiquadCascade filter(sections);
+    EXPECT_NEAR(toneGain(filter, 100.0), std::sqrt(0.5), 0.01);
+    EXPECT_NEAR(toneGain(filter, 25.0), std::pow(0.25, 4), 0.001);
+    EXPECT_NEAR(toneGain(filter, 3000.0), 1.0, 0.01);
+    
+    // No gain at DC at all
+    filter.reset();
+    float out = 0.0f;
+    for (int i = 0; i < 20000; i++) {
+        out = filter.push(512.0f);
+    }
+    EXPECT_NEAR(out, 0.0f, 1e-3f);
+}
+
+// Test filtering ADC blocks to centered 16-bit samples
+TEST(IirTest, DcFilterBlocks) {
+    DcBlockerConfig config;
+    config.highPassSections = 1;
+    DcFilter filter(config, RATE);
+    std::vector<int> samples(2048);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<int>(std::lround(700.0 + 300.0 * std::sin(2.0 * M_PI * 2500.0 * i / RATE)));
+    }
+    std::vector<int16_t> out(samples.size());
+    filter.process(samples.data(), samples.size(), out.data());
+    long sum = 0;
+    for (size_t i = 1024; i < out.size(); i++) {
+        sum += out[i];
+        ASSERT_LE(std::abs(out[i]), 302) << i;
+    }
+    EXPECT_NEAR(sum / 1024.0, 0.0, 1.0);
+}
+
+// Test that corners outside the band are rejected
+TEST(IirTest, InvalidCorner) {
+    EXPECT_THROW(DcBlocker(0.0, RATE), std::invalid_argument);
+    EXPECT_THROW(designHighPass(6000.0, RATE), std::invalid_argument);
+    EXPECT_THROW(designHighPass(100.0, RATE, 0.0), std::invalid_argument);
+    DcBlockerConfig config;
+    config.highPassSections = 2;
+    config.highPassHz = -1.0f;
+    EXPECT_THROW(DcFilter(config, RATE), std::invalid_argument);
+}
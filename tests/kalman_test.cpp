@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "kalman.hpp"
+
+namespace {
+constexpr double RATE = 10000.0;
+constexpr int FRAME_SIZE = 256;
+constexpr int HOP_SIZE = 64;
+
+// A frame with returns at the given speeds, strongest first
+StftFrame frame(uint64_t firstSample, std::vector<float> speeds) {
+    StftFrame result{};
+    result.firstSample = firstSample;
+    for (float speed : speeds) {
+        result.peaks[result.peakCount++] = {speed * 31.4f, speed, 100.0f};
+    }
+    return result;
+}
+
+double frameTime(uint64_t firstSample) {
+    return (firstSample + FRAME_SIZE / 2.0) / RATE;
+}
+}
+
+// Test that the filter tracks a decelerating speed forward and backward in time
+TEST(SpeedKalmanTest, TracksDeceleration) {
+    SpeedKalmanFilter filter;
+    EXPECT_FALSE(filter.started());
+
+    // 150 mph at t = 0, slowing by 80 mph/s, measured exactly every 10 ms
+    filter.start(0.1, 150.0 - 80.0 * 0.1);
+    for (int i = 9; i >= 0; i--) {
+        double time = i * 0.01;
+        filter.predict(time);
+        EXPECT_TRUE(filter.update(150.0 - 80.0 * time));
+    }
+    EXPECT_NEAR(filter.speed(), 150.0, 0.3);
+    EXPECT_NEAR(filter.deceleration(), 80.0, 15.0);
+    EXPECT_LT(filter.speedSigma(), 0.5);
+
+    // Extrapolation grows the uncertainty
+    double sigma = filter.speedSigma();
+    filter.predict(-0.05);
+    EXPECT_NEAR(filter.speed(), 154.0, 1.0);
+    EXPECT_GT(filter.speedSigma(), sigma);
+
+    // A return far from the prediction is gated out
+    double speed = filter.speed();
+    EXPECT_FALSE(filter.update(100.0));
+    EXPECT_EQ(filter.speed(), speed);
+}
+
+// Test the launch speed of a noisy decelerating ball among club returns
+TEST(SpeedKalmanTest, LaunchSpeedAtImpact) {
+    const double impactSample = 400.0;
+    const double launchSpeed = 152.0;
+    const double deceleration = 90.0;
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 0.5f);
+
+    std::vector<StftFrame> frames;
+    std::vector<float> ballSpeeds;
+    for (uint64_t first = 0; first + FRAME_SIZE <= 2048; first += HOP_SIZE) {
+        double sinceImpact = frameTime(first) - impactSample / RATE;
+        float club = static_cast<float>(100.0 + 20.0 * sinceImpact);
+        if (sinceImpact < 0.0) {
+            frames.push_back(frame(first, {club}));
+            continue;
+        }
+        float ball = static_cast<float>(launchSpeed - deceleration * sinceImpact) + noise(rng);
+        ballSpeeds.push_back(ball);
+        frames.push_back(sinceImpact < 0.03 ? frame(first, {club, ball}) : frame(first, {ball}));
+    }
+    std::vector<float> sorted = ballSpeeds;
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    float median = sorted[sorted.size() / 2];
+
+    // The ball slows by 9% over this long a track, further than the default
+    // tolerance below the median by its last frame
+    SpeedKalmanConfig config;
+    config.seedTolerance = 0.1f;
+    LaunchSpeed launch = estimateLaunchSpeed(frames, RATE, FRAME_SIZE, median, impactSample, config);
+    EXPECT_EQ(launch.frames, ballSpeeds.size());
+    EXPECT_NEAR(launch.speedMPH, launchSpeed, 0.6);
+    EXPECT_NEAR(launch.decelerationMPHPerS, deceleration, 20.0);
+    EXPECT_GT(launch.uncertaintyMPH, 0.0f);
+    EXPECT_LT(launch.uncertaintyMPH, 1.0f);
+    // The median is the speed some way into the flight
+    EXPECT_GT(launchSpeed - median, 5.0);
+}
+
+// Test that no launch speed is given without enough ball frames
+TEST(SpeedKalmanTest, TooFewFrames) {
+    std::vector<StftFrame> frames = {frame(0, {120.0f}), frame(64, {121.0f}), frame(128, {90.0f})};
+    LaunchSpeed launch = estimateLaunchSpeed(frames, RATE, FRAME_SIZE, 120.0f, 0.0);
+    EXPECT_EQ(launch.speedMPH, 0.0f);
+    EXPECT_EQ(launch.frames, 0u);
+
+    // Frames before the impact don't count
+    frames.push_back(frame(192, {119.5f}));
+    EXPECT_GT(estimateLaunchSpeed(frames, RATE, FRAME_SIZE, 120.0f, 0.0).speedMPH, 0.0f);
+    EXPECT_EQ(estimateLaunchSpeed(frames, RATE, FRAME_SIZE, 120.0f, 150.0).speedMPH, 0.0f);
+}
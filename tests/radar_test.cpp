@@ -3,9 +3,14 @@
 #include <chrono>
 #include <thread>
 #include <cmath>
+#include <random>
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
 #include "radar.hpp"
 #include "logger.hpp"
-#include <fftw3.h>
 
 // Test subclass of RadarManager that doesn't rely on actual hardware
 class TestRadarManager : public RadarManager {
@@ -16,54 +21,48 @@ public:
     void init(int adcChannel = RADAR_ADC_CHANNEL) override {
         this->adcChannel = adcChannel;
         
-        // Initialize FFTW without hardware
-        if (!fftw_initialized) {
-            // Allocate input and output arrays
-            fftw_in = (double*)fftw_malloc(sizeof(double) * DEFAULT_SAMPLE_COUNT);
-            fftw_out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (DEFAULT_SAMPLE_COUNT/2 + 1));
-            
-            // Create FFTW plan with ESTIMATE to avoid overwriting input data
-            fftw_plan_r2c = fftw_plan_dft_r2c_1d(DEFAULT_SAMPLE_COUNT, fftw_in, fftw_out, FFTW_ESTIMATE);
-            
-            if (!fftw_plan_r2c) {
-                Logger::error("Failed to create FFTW plan");
-                fftw_free(fftw_in);
-                fftw_free(fftw_out);
-                return;
-            }
-            
-            fftw_initialized = true;
-        }
+        // Initialize FFTW without hardware, using ESTIMATE plans so tests start quickly
+        fftPlanFlags = FFT_PLAN_ESTIMATE;
+        fftw_initialized = true;
         Logger::info("Radar initialized on ADC channel " + std::to_string(adcChannel));
     }
     
     void cleanup() override {
+        stopAcquisition();
+        
         // Free FFTW resources
-        if (fftw_initialized) {
-            fftw_destroy_plan(fftw_plan_r2c);
-            fftw_free(fftw_in);
-            fftw_free(fftw_out);
-            fftw_initialized = false;
-        }
+        fftPlans.clear();
+        fftw_initialized = false;
         Logger::info("Radar resources cleaned up");
     }
     
-    // Override readSamples to return synthetic test data instead of reading from hardware
-    std::vector<int> readSamples(int numSamples = DEFAULT_SAMPLE_COUNT, 
-                                int sampleFreq = DEFAULT_SAMPLE_FREQ) override {
-        // Generate a test signal based on the test speed
-        std::vector<int> samples(numSamples);
+    // Override readAdc to return synthetic test data instead of reading from hardware
+    void readAdc(int* dst, int numSamples, int sampleFreq, SteadyTime* timestamps) override {
+        if (useSource) {
+            RadarManager::readAdc(dst, numSamples, sampleFreq, timestamps);
+            return;
+        }
         
         // Convert mph to Doppler frequency
         float speedMPS = testSpeedMPH / 2.23694f; // Convert mph to m/s
         float dopplerFreq = (2.0f * speedMPS * RADAR_FREQ) / SPEED_OF_LIGHT;
         
-        Logger::debug("Test generating samples for " + std::to_string(testSpeedMPH) + 
-                     " mph, Doppler freq: " + std::to_string(dopplerFreq) + " Hz");
+        // The simulated ADC may run at a different rate than requested
+        double rate = actualRate > 0.0 ? actualRate : sampleFreq;
+        // Samples are timed from the first read, so the timestamps stay consistent
+        // with the signal even when a block is delivered late
+        if (sampleCounter == 0) {
+            streamStart = std::chrono::steady_clock::now();
+        }
+        std::normal_distribution<double> jitter(0.0, jitterMicros * 1e-6);
         
-        // Generate a sine wave at the Doppler frequency, scaled to ADC range (0-1023)
+        // Generate a sine wave at the Doppler frequency, scaled to ADC range (0-1023).
+        // The phase carries on from the previous call so continuous acquisition
+        // sees an unbroken signal.
         for (int i = 0; i < numSamples; i++) {
-            float t = static_cast<float>(i) / sampleFreq;
+            double timingError = jitterMicros > 0.0 ? jitter(jitterRng) : 0.0;
+            double t = static_cast<double>(sampleCounter++) / rate + timingError;
+            
             // Base signal (DC offset + sine wave)
             float value = 512 + 400 * sin(2 * M_PI * dopplerFreq * t);
             
@@ -74,10 +73,18 @@ public:
             if (value < 0) value = 0;
             if (value > 1023) value = 1023;
             
-            samples[i] = static_cast<int>(value);
+            dst[i] = static_cast<int>(value);
+            if (timestamps) {
+                timestamps[i] = streamStart + std::chrono::duration_cast<SteadyTime::duration>(
+                    std::chrono::duration<double>(t));
+            }
         }
         
-        return samples;
+        // Take as long as real hardware would when running continuously
+        if (realTime) {
+            std::this_thread::sleep_until(streamStart + std::chrono::duration_cast<SteadyTime::duration>(
+                std::chrono::duration<double>(sampleCounter / rate)));
+        }
     }
     
     // Set the speed that will be used for generating test data
@@ -85,8 +92,40 @@ public:
         testSpeedMPH = speedMPH;
     }
     
+    // Pace synthetic samples at the requested sample rate
+    void setRealTime(bool enabled) {
+        realTime = enabled;
+    }
+    
+    // Simulate an ADC running at the wrong rate, with gaussian timing jitter
+    void setSampleTiming(double rate, double jitterRmsMicros) {
+        actualRate = rate;
+        jitterMicros = jitterRmsMicros;
+    }
+    
+    // Read from a sample source instead of the built-in sine
+    void useSampleSource(std::unique_ptr<SampleSource> source) {
+        setSampleSource(std::move(source));
+        useSource = true;
+    }
+    
+    SampleHistory* getHistory() {
+        return history.get();
+    }
+    
+    size_t cachedPlanCount() const {
+        return fftPlans.size();
+    }
+    
 private:
     float testSpeedMPH = 80.0f; // Default test speed in mph
+    uint64_t sampleCounter = 0;
+    SteadyTime streamStart;
+    bool realTime = false;
+    bool useSource = false;
+    double actualRate = 0.0;
+    double jitterMicros = 0.0;
+    std::mt19937 jitterRng{7};
 };
 
 class RadarTest : public ::testing::Test {
@@ -252,3 +291,729 @@ TEST_F(RadarTest, DiagnosticOutput) {
     EXPECT_TRUE(logOutput.find("Speed calculation") != std::string::npos);
 }
 
+
+// Test continuous acquisition with a measurement taken from the history
+TEST_F(RadarTest, ContinuousAcquisitionMeasurement) {
+    float testSpeed = 70.0f;
+    testManager.setTestSpeed(testSpeed);
+    testManager.setRealTime(true);
+    
+    testManager.startAcquisition(8192);
+    EXPECT_TRUE(testManager.isAcquiring());
+    
+    // The processing thread owns the callback until acquisition stops
+    bool replacedCalled = false;
+    testManager.setMeasurementCallback([&replacedCalled](const RadarMeasurement&) { replacedCalled = true; });
+    
+    // Let some pre-trigger history build up, then trigger
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    testManager.startMeasurement(std::chrono::steady_clock::now());
+    
+    // Post-trigger part of the capture takes ~77 ms to acquire
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_FALSE(replacedCalled);
+    EXPECT_NEAR(lastMeasurement.speedMPH, testSpeed, 3.0f);
+    
+    testManager.stopAcquisition();
+    EXPECT_FALSE(testManager.isAcquiring());
+}
+
+// Test measuring from an oversampled stream that is filtered and decimated
+TEST_F(RadarTest, FilteredDecimatedStream) {
+    float testSpeed = 80.0f;
+    testManager.setTestSpeed(testSpeed);
+    testManager.setRealTime(true);
+    StreamFilterConfig filter;
+    filter.enabled = true;
+    filter.decimation = 2;
+    testManager.setStreamFilter(filter);
+    
+    testManager.startAcquisition(8192, 2 * DEFAULT_SAMPLE_FREQ);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    testManager.startMeasurement(std::chrono::steady_clock::now());
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_NEAR(lastMeasurement.speedMPH, testSpeed, 3.0f);
+    EXPECT_NEAR(lastMeasurement.timing.effectiveRate, DEFAULT_SAMPLE_FREQ, 100.0);
+    testManager.stopAcquisition();
+}
+
+// Test that the acquisition stream is centered as it is acquired
+TEST_F(RadarTest, DcBlockedStream) {
+    float testSpeed = 95.0f;
+    testManager.setTestSpeed(testSpeed);
+    testManager.setRealTime(true);
+    DcBlockerConfig dcBlocker;
+    dcBlocker.enabled = true;
+    dcBlocker.highPassSections = 1;
+    testManager.setDcBlocker(dcBlocker);
+
+    testManager.startAcquisition(8192);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    SampleWindow window;
+    ASSERT_TRUE(testManager.captureWindow(std::chrono::steady_clock::now(), std::chrono::milliseconds(30),
+                                          std::chrono::milliseconds(30), window));
+    long sum = 0;
+    for (size_t i = 0; i < window.first.size; i++) {
+        sum += window.first.data[i];
+    }
+    EXPECT_NEAR(static_cast<double>(sum) / window.first.size, 0.0, 5.0);
+
+    testManager.startMeasurement(std::chrono::steady_clock::now());
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    testManager.stopAcquisition();
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_NEAR(lastMeasurement.speedMPH, testSpeed, 3.0f);
+    EXPECT_NE(testStream.str().find("Capture centered upstream"), std::string::npos);
+}
+
+// Test that the zoomed spectrum measures the speed more finely
+TEST_F(RadarTest, ZoomedSpectrum) {
+    float testSpeed = 97.3f;
+    testManager.setTestSpeed(testSpeed);
+    testManager.setPeakEstimator(PeakEstimator::None);
+    std::vector<int> samples = testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ);
+    RadarMeasurement coarse = testManager.processSamples(samples);
+    
+    ZoomConfig zoom;
+    zoom.enabled = true;
+    testManager.setZoom(zoom);
+    RadarMeasurement fine = testManager.processSamples(samples);
+    EXPECT_NEAR(fine.speedMPH, testSpeed, 0.05f);
+    EXPECT_LT(std::abs(fine.speedMPH - testSpeed), std::abs(coarse.speedMPH - testSpeed));
+    EXPECT_LT(fine.speedUncertaintyMPH, coarse.speedUncertaintyMPH);
+    
+    // Returns outside the band fall back to the peak estimator
+    testManager.setTestSpeed(30.0f);
+    RadarMeasurement slow = testManager.processSamples(
+        testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ));
+    EXPECT_NEAR(slow.speedMPH, 30.0f, 0.5f);
+}
+
+// Test captures that aren't the default length
+TEST_F(RadarTest, ArbitraryCaptureLengths) {
+    float testSpeed = 90.0f;
+    testManager.setTestSpeed(testSpeed);
+    
+#ifdef HAVE_FFTW
+    std::vector<int> counts = {512, 1000, 2048, 4096};
+#else
+    // Only FFTW does lengths that aren't powers of two
+    std::vector<int> counts = {512, 2048, 4096};
+#endif
+    for (int count : counts) {
+        std::vector<int> samples = testManager.readSamples(count, DEFAULT_SAMPLE_FREQ);
+        RadarMeasurement measurement = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+        
+        // Within one FFT bin
+        float binMPH = DEFAULT_SAMPLE_FREQ / static_cast<float>(count) / 31.4f;
+        EXPECT_NEAR(measurement.speedMPH, testSpeed, binMPH) << count << " samples";
+    }
+    // One per length, plus the shot tracker's frame plan shared by all of them
+    EXPECT_EQ(testManager.cachedPlanCount(), counts.size() + 1);
+    
+    // Plans are reused for repeated lengths
+    testManager.processSamples(testManager.readSamples(2048, DEFAULT_SAMPLE_FREQ), DEFAULT_SAMPLE_FREQ);
+    EXPECT_EQ(testManager.cachedPlanCount(), counts.size() + 1);
+}
+
+#ifdef HAVE_FFTW
+// Test creating the FFTW wisdom file offline
+TEST_F(RadarTest, PlanWisdom) {
+    std::string path = "/tmp/radar_test.wisdom";
+    testManager.setWisdomFile(path);
+    ASSERT_TRUE(testManager.planWisdom());
+    
+    std::ifstream wisdom(path);
+    EXPECT_TRUE(wisdom.good());
+    EXPECT_NE(testStream.str().find("Saved FFTW wisdom"), std::string::npos);
+    
+    std::remove(path.c_str());
+    std::remove((path + ".float").c_str());
+}
+#endif
+
+// Test that the single precision pipeline measures the same speeds
+TEST_F(RadarTest, SinglePrecisionMatchesDouble) {
+    for (float testSpeed : {60.0f, 95.0f, 150.0f}) {
+        testManager.setTestSpeed(testSpeed);
+        std::vector<int> samples = testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ);
+        
+        testManager.setFftPrecision(FftPrecision::Double);
+        RadarMeasurement doubleResult = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+        testManager.setFftPrecision(FftPrecision::Single);
+        EXPECT_EQ(testManager.getFftPrecision(), FftPrecision::Single);
+        RadarMeasurement singleResult = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+        
+        // The refined peak position differs in the last digits
+        EXPECT_NEAR(singleResult.speedMPH, doubleResult.speedMPH, 0.001f);
+        EXPECT_NEAR(singleResult.signalStrength, doubleResult.signalStrength,
+                    1e-4f * doubleResult.signalStrength);
+        EXPECT_NEAR(singleResult.speedMPH, testSpeed, 1.0f);
+    }
+}
+
+// Test that the built-in FFT kernels measure the same speeds as the default backend
+TEST_F(RadarTest, StaticFftBackend) {
+    EXPECT_EQ(testManager.getFftBackend(), DEFAULT_FFT_BACKEND);
+    for (float testSpeed : {60.0f, 150.0f}) {
+        testManager.setTestSpeed(testSpeed);
+        std::vector<int> samples = testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ);
+        
+        RadarMeasurement expected = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+        ASSERT_TRUE(testManager.setFftBackend(FftBackend::Static));
+        EXPECT_EQ(testManager.getFftBackend(), FftBackend::Static);
+        RadarMeasurement measurement = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+        
+        EXPECT_NEAR(measurement.speedMPH, expected.speedMPH, 0.001f);
+        EXPECT_NEAR(measurement.signalStrength, expected.signalStrength, 1e-4f * expected.signalStrength);
+        EXPECT_NEAR(measurement.speedMPH, testSpeed, 1.0f);
+        testManager.setFftBackend(DEFAULT_FFT_BACKEND);
+    }
+    EXPECT_EQ(testManager.setFftBackend(FftBackend::Fftw), fftBackendAvailable(FftBackend::Fftw));
+    
+    // Not while acquiring
+    testManager.startAcquisition();
+    EXPECT_FALSE(testManager.setFftBackend(FftBackend::Static));
+    testManager.stopAcquisition();
+}
+
+// Test a batch of captures on a thread pool against one at a time
+TEST_F(RadarTest, BatchProcessing) {
+    std::vector<std::vector<int>> captures;
+    for (int i = 0; i < 24; i++) {
+        testManager.setTestSpeed(60.0f + 4.0f * i);
+        // Uneven lengths, so some workers finish early and steal
+        captures.push_back(testManager.readSamples(i % 3 == 0 ? 4096 : DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ));
+    }
+    captures.push_back(std::vector<int>(10, 512));  // Too short to measure
+    
+    std::vector<RadarMeasurement> results = testManager.processBatch(captures, DEFAULT_SAMPLE_FREQ, 4);
+    ASSERT_EQ(results.size(), captures.size());
+    for (int i = 0; i < 24; i++) {
+        RadarMeasurement expected = testManager.processSamples(captures[i], DEFAULT_SAMPLE_FREQ);
+        EXPECT_TRUE(results[i].detected) << i;
+        EXPECT_FLOAT_EQ(results[i].speedMPH, expected.speedMPH) << i;
+        EXPECT_NEAR(results[i].speedMPH, 60.0f + 4.0f * i, 1.0f) << i;
+    }
+    EXPECT_FALSE(results.back().detected);
+    EXPECT_NE(testStream.str().find("Analyzed 25 captures"), std::string::npos);
+    EXPECT_TRUE(testManager.processBatch({}).empty());
+}
+
+// Test reanalyzing a directory of recorded captures
+TEST_F(RadarTest, ProcessCaptureDirectory) {
+    std::string directory = "radar_test_captures";
+    std::filesystem::create_directory(directory);
+    std::vector<float> speeds = {120.0f, 80.0f, 100.0f};
+    for (size_t i = 0; i < speeds.size(); i++) {
+        testManager.setTestSpeed(speeds[i]);
+        std::string path = directory + "/shot" + std::to_string(i) + ".wav";
+        ASSERT_TRUE(writeWavFile(path, testManager.readSamples(2048, DEFAULT_SAMPLE_FREQ), DEFAULT_SAMPLE_FREQ));
+    }
+    std::ofstream(directory + "/shot3.raw");  // Empty
+    
+    std::vector<std::string> files;
+    std::vector<RadarMeasurement> results = testManager.processCaptureDirectory(directory, &files, 2);
+    std::filesystem::remove_all(directory);
+    
+    ASSERT_EQ(results.size(), 4u);
+    ASSERT_EQ(files.size(), 4u);
+    for (size_t i = 0; i < speeds.size(); i++) {
+        EXPECT_EQ(files[i], directory + "/shot" + std::to_string(i) + ".wav");
+        EXPECT_TRUE(results[i].detected) << files[i];
+        EXPECT_NEAR(results[i].speedMPH, speeds[i], 1.0f) << files[i];
+    }
+    EXPECT_FALSE(results[3].detected);
+    EXPECT_NE(testStream.str().find("no samples in " + files[3]), std::string::npos);
+}
+
+// Test analyzing captures on several threads at once
+TEST_F(RadarTest, ConcurrentProcessing) {
+    const int threadCount = 4;
+    std::vector<std::vector<int>> captures;
+    std::vector<float> speeds = {70.0f, 90.0f, 110.0f, 130.0f};
+    for (float speed : speeds) {
+        testManager.setTestSpeed(speed);
+        captures.push_back(testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ));
+    }
+    Logger::setLogLevel(LogLevel::ERROR);
+    
+    std::vector<float> maxError(threadCount, 0.0f);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 20; i++) {
+                RadarMeasurement measurement = testManager.processSamples(captures[t], DEFAULT_SAMPLE_FREQ);
+                maxError[t] = std::max(maxError[t], std::abs(measurement.speedMPH - speeds[t]));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    for (int t = 0; t < threadCount; t++) {
+        EXPECT_LT(maxError[t], 1.0f) << speeds[t] << " mph";
+    }
+}
+
+// Test that sub-bin peak estimators beat whole bins on a short capture
+TEST_F(RadarTest, SubBinPeakEstimators) {
+    // 256 samples at 10 kHz: bins are ~1.25 mph wide
+    const int count = 256;
+    float testSpeed = 101.3f;
+    testManager.setTestSpeed(testSpeed);
+    std::vector<int> samples = testManager.readSamples(count, DEFAULT_SAMPLE_FREQ);
+    
+    testManager.setPeakEstimator(PeakEstimator::None);
+    RadarMeasurement coarse = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+    EXPECT_GT(std::abs(coarse.speedMPH - testSpeed), 0.2f);
+    EXPECT_NEAR(coarse.speedUncertaintyMPH, 1.25f / std::sqrt(12.0f), 0.05f);
+    
+    for (PeakEstimator estimator : {PeakEstimator::Parabolic, PeakEstimator::Jacobsen,
+                                    PeakEstimator::Quinn, PeakEstimator::ZeroPadded}) {
+        testManager.setPeakEstimator(estimator);
+        EXPECT_EQ(testManager.getPeakEstimator(), estimator);
+        RadarMeasurement refined = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+        EXPECT_NEAR(refined.speedMPH, testSpeed, 0.1f) << peakEstimatorName(estimator);
+        EXPECT_GT(refined.speedUncertaintyMPH, 0.0f);
+        EXPECT_LT(refined.speedUncertaintyMPH, coarse.speedUncertaintyMPH);
+        EXPECT_NEAR(refined.dopplerFrequency, dopplerFrequencyForSpeed(refined.speedMPS), 0.01f);
+    }
+}
+
+// Test club speed, ball speed and smash factor from a capture with both returns
+TEST_F(RadarTest, ClubAndBallSpeeds) {
+    // The club closes in at 95 mph, then the ball leaves at 140 mph while
+    // the club slows to 75 mph and its return fades
+    const float clubSpeed = 95.0f;
+    const float ballSpeed = 140.0f;
+    const int impact = 400;
+    std::vector<int> samples(DEFAULT_SAMPLE_COUNT);
+    double clubPhase = 0.0;
+    double ballPhase = 0.0;
+    for (int i = 0; i < DEFAULT_SAMPLE_COUNT; i++) {
+        float club = i < impact ? clubSpeed : 75.0f;
+        double clubAmplitude = i < impact ? 250.0 : 250.0 * std::exp(-(i - impact) / 150.0);
+        double value = 512.0 + clubAmplitude * std::sin(clubPhase) + (rand() % 20) - 10;
+        if (i >= impact) {
+            value += 200.0 * std::sin(ballPhase);
+            ballPhase += 2.0 * M_PI * dopplerFrequencyForSpeed(ballSpeed / MPS_TO_MPH) / DEFAULT_SAMPLE_FREQ;
+        }
+        clubPhase += 2.0 * M_PI * dopplerFrequencyForSpeed(club / MPS_TO_MPH) / DEFAULT_SAMPLE_FREQ;
+        samples[i] = static_cast<int>(std::lround(value));
+    }
+    
+    RadarMeasurement measurement = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+    EXPECT_NEAR(measurement.ballSpeedMPH, ballSpeed, 1.0f);
+    EXPECT_NEAR(measurement.clubSpeedMPH, clubSpeed, 1.0f);
+    EXPECT_NEAR(measurement.smashFactor, ballSpeed / clubSpeed, 0.02f);
+    
+    // A single steady return is a ball with no club
+    testManager.setTestSpeed(120.0f);
+    measurement = testManager.processSamples(testManager.readSamples(), DEFAULT_SAMPLE_FREQ);
+    EXPECT_NEAR(measurement.ballSpeedMPH, 120.0f, 1.0f);
+    EXPECT_EQ(measurement.clubSpeedMPH, 0.0f);
+    EXPECT_EQ(measurement.smashFactor, 0.0f);
+}
+
+// Test measuring with each of the selectable windows
+TEST_F(RadarTest, SelectableWindows) {
+    float testSpeed = 110.0f;
+    testManager.setTestSpeed(testSpeed);
+    
+    for (WindowType type : {WindowType::Hamming, WindowType::Hann, WindowType::BlackmanHarris,
+                            WindowType::Kaiser, WindowType::FlatTop}) {
+        testManager.setWindow(type);
+        EXPECT_EQ(testManager.getWindow(), type);
+        
+        std::vector<int> samples = testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ);
+        RadarMeasurement measurement = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+        EXPECT_NEAR(measurement.speedMPH, testSpeed, 1.0f) << windowTypeName(type);
+    }
+}
+
+// Test a trigger that the processing thread only sees after its samples arrived
+TEST_F(RadarTest, StreamMeasurementFromPastTrigger) {
+    float testSpeed = 95.0f;
+    testManager.setTestSpeed(testSpeed);
+    testManager.setRealTime(true);
+    testManager.startAcquisition(8192);
+    
+    // Trigger 20 ms ago, after the post-trigger samples have mostly arrived
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    testManager.startMeasurement(std::chrono::steady_clock::now() - std::chrono::milliseconds(20));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_NEAR(lastMeasurement.speedMPH, testSpeed, 3.0f);
+    EXPECT_EQ(testManager.getStreamOverruns(), 0u);
+    
+    testManager.stopAcquisition();
+}
+
+// Test the speed track computed from the acquisition stream
+TEST_F(RadarTest, SpeedTrackFromStream) {
+    float testSpeed = 88.0f;
+    testManager.setTestSpeed(testSpeed);
+    testManager.setRealTime(true);
+    testManager.setSpeedTracking(true);
+    SteadyTime start = std::chrono::steady_clock::now();
+    testManager.startAcquisition(8192);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    testManager.stopAcquisition();
+    testManager.setSpeedTracking(false);
+    
+    // ~2000 samples at a hop of 64
+    std::vector<StftFrame> track = testManager.getSpeedTrack();
+    ASSERT_GT(track.size(), 20u);
+    for (size_t i = 0; i < track.size(); i++) {
+        EXPECT_NEAR(track[i].speedMPH, testSpeed, 1.0f);
+        EXPECT_GE(track[i].time, start);
+        if (i > 0) {
+            EXPECT_EQ(track[i].firstSample, track[i - 1].firstSample + 64);
+            EXPECT_GT(track[i].time, track[i - 1].time);
+        }
+    }
+    
+    // Only the frames from the last part
+    SteadyTime since = track[track.size() / 2].time;
+    EXPECT_EQ(testManager.getSpeedTrack(since).size(), track.size() - track.size() / 2);
+}
+
+// Test triggering a measurement from the radar stream itself
+TEST_F(RadarTest, EnergyTriggerStartsMeasurement) {
+    SyntheticSignal signal;
+    signal.ballSpeedMPH = 130.0f;
+    signal.ballAmplitude = 300.0f;
+    signal.shotIntervalMs = 400.0f;
+    testManager.useSampleSource(std::make_unique<SyntheticSampleSource>(signal, DEFAULT_SAMPLE_FREQ, 1.0));
+    
+    std::vector<SteadyTime> triggers;
+    std::mutex triggerMutex;
+    testManager.setEnergyTrigger([&](SteadyTime time) {
+        {
+            std::lock_guard<std::mutex> lock(triggerMutex);
+            triggers.push_back(time);
+        }
+        testManager.startMeasurement(time);
+    });
+    testManager.startAcquisition(8192);
+    
+    // Impact 40 ms in, then the capture needs another ~80 ms
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    testManager.stopAcquisition();
+    testManager.setEnergyTrigger(nullptr);
+    
+    std::lock_guard<std::mutex> lock(triggerMutex);
+    ASSERT_EQ(triggers.size(), 1u);
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_NEAR(lastMeasurement.speedMPH, 130.0f, 1.0f);
+}
+
+// Test that a trigger from before acquisition started is rejected
+TEST_F(RadarTest, StreamMeasurementWithoutPreTriggerSamples) {
+    auto trigger = std::chrono::steady_clock::now();
+    testManager.setRealTime(true);
+    testManager.startAcquisition(8192);
+    
+    testManager.startMeasurement(trigger - std::chrono::seconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    
+    EXPECT_FALSE(callbackCalled);
+    EXPECT_NE(testStream.str().find("Not enough acquisition history"), std::string::npos);
+    
+    testManager.stopAcquisition();
+}
+
+// Test that acquisition keeps running when real-time settings can't be applied
+TEST_F(RadarTest, AcquisitionWithoutRealtimePrivileges) {
+    class UnprivilegedController : public RealtimeController {
+    protected:
+        int setFifoScheduling(int) override { return EPERM; }
+        int lockAllMemory() override { return EPERM; }
+    };
+    
+    RealtimeConfig config;
+    config.enabled = true;
+    testManager.setRealtimeController(std::make_unique<UnprivilegedController>());
+    testManager.setRealtimeConfig(config);
+    testManager.setRealTime(true);
+    
+    testManager.startAcquisition(8192);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    testManager.startMeasurement(std::chrono::steady_clock::now());
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    
+    EXPECT_TRUE(testManager.isAcquiring());
+    EXPECT_TRUE(callbackCalled);
+    
+    RealtimeReport report = testManager.getRealtimeReport();
+    EXPECT_FALSE(report.scheduling);
+    EXPECT_FALSE(report.memoryLocked);
+    EXPECT_NE(testStream.str().find("SCHED_FIFO not permitted"), std::string::npos);
+    
+    testManager.stopAcquisition();
+}
+
+// Test extracting a window spanning both sides of the trigger
+TEST_F(RadarTest, CaptureWindowAroundTrigger) {
+    testManager.setRealTime(true);
+    testManager.startAcquisition(8192);
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto trigger = std::chrono::steady_clock::now();
+    
+    SampleWindow window;
+    ASSERT_TRUE(testManager.captureWindow(trigger, std::chrono::milliseconds(20),
+                                          std::chrono::milliseconds(30), window));
+    
+    // 20 ms + 30 ms at 10 kHz
+    EXPECT_EQ(window.size(), 500u);
+    EXPECT_LE(window.startTime, trigger);
+    EXPECT_TRUE(testManager.getHistory()->isIntact(window));
+    
+    // A trigger from before acquisition started can't be served
+    EXPECT_FALSE(testManager.captureWindow(trigger - std::chrono::seconds(10),
+                                           std::chrono::milliseconds(20),
+                                           std::chrono::milliseconds(30), window));
+}
+
+// Test processing 16-bit samples in place, whole or split across the end of the history
+TEST_F(RadarTest, ProcessSampleViews) {
+    float testSpeed = 105.0f;
+    testManager.setTestSpeed(testSpeed);
+    
+    SampleWindow window;
+#ifdef HAVE_FFTW
+    // Straight from the acquisition history (600 samples, which needs FFTW)
+    testManager.setRealTime(true);
+    testManager.startAcquisition(8192);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_TRUE(testManager.captureWindow(std::chrono::steady_clock::now(), std::chrono::milliseconds(30),
+                                          std::chrono::milliseconds(30), window));
+    RadarMeasurement live = testManager.processSamples(window);
+    EXPECT_TRUE(testManager.getHistory()->isIntact(window));
+    EXPECT_NEAR(live.speedMPH, testSpeed, 3.0f);
+    testManager.stopAcquisition();
+#endif
+    
+    // A capture packed into 16 bits gives the same result as the int one
+    std::vector<int> samples = testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ);
+    std::vector<int16_t> packed(samples.begin(), samples.end());
+    
+    RadarMeasurement expected = testManager.processSamples(samples);
+    RadarMeasurement measurement = testManager.processSamples(SampleSpan{packed.data(), packed.size()});
+    EXPECT_TRUE(measurement.detected);
+    EXPECT_NEAR(measurement.speedMPH, testSpeed, 1.0f);
+    EXPECT_NEAR(measurement.speedMPH, expected.speedMPH, 0.01f);
+    EXPECT_NEAR(measurement.signalStrength, expected.signalStrength, 0.001f * expected.signalStrength);
+    
+    window.first = {packed.data(), 300};
+    window.second = {packed.data() + 300, packed.size() - 300};
+    RadarMeasurement wrapped = testManager.processSamples(window);
+    EXPECT_FLOAT_EQ(wrapped.speedMPH, measurement.speedMPH);
+}
+
+// Without continuous acquisition, a timed measurement reads samples after the trigger
+TEST_F(RadarTest, TimedMeasurementWithoutAcquisition) {
+    testManager.setTestSpeed(60.0f);
+    testManager.startMeasurement(std::chrono::steady_clock::now());
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_NEAR(lastMeasurement.speedMPH, 60.0f, 3.0f);
+}
+
+// Test measuring from a synthetic sample source
+TEST_F(RadarTest, SyntheticSampleSourceMeasurement) {
+    SyntheticSignal signal;
+    signal.ballSpeedMPH = 110.0f;
+    testManager.useSampleSource(std::make_unique<SyntheticSampleSource>(signal, DEFAULT_SAMPLE_FREQ));
+    EXPECT_EQ(testManager.getSampleRate(), DEFAULT_SAMPLE_FREQ);
+    
+    testManager.startMeasurement();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_NEAR(lastMeasurement.speedMPH, 110.0f, 3.0f);
+}
+
+// Test that a capture of nothing but noise isn't reported as a shot
+TEST_F(RadarTest, NoiseOnlyCaptureIsDropped) {
+    SyntheticSignal signal;
+    signal.ballAmplitude = 0.0f;
+    testManager.useSampleSource(std::make_unique<SyntheticSampleSource>(signal, DEFAULT_SAMPLE_FREQ));
+    
+    RadarMeasurement measurement = testManager.processSamples(testManager.readSamples(DEFAULT_SAMPLE_COUNT,
+                                                                                      DEFAULT_SAMPLE_FREQ));
+    EXPECT_FALSE(measurement.detected);
+    testManager.startMeasurement();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(callbackCalled);
+    
+    // Without CFAR the strongest noise bin is reported
+    CfarConfig cfar;
+    cfar.enabled = false;
+    testManager.setCfar(cfar);
+    testManager.startMeasurement();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_TRUE(lastMeasurement.detected);
+}
+
+// Test the SNR against the synthetic signal's, with different windows
+TEST_F(RadarTest, SignalToNoise) {
+    // 400 count tone in 10 counts RMS of noise: 400^2 / 2 / 10^2 is 29 dB
+    SyntheticSignal signal;
+    signal.ballSpeedMPH = 100.0f;
+    testManager.useSampleSource(std::make_unique<SyntheticSampleSource>(signal, DEFAULT_SAMPLE_FREQ));
+    std::vector<int> samples = testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ);
+    
+    for (WindowType window : {WindowType::Hann, WindowType::BlackmanHarris, WindowType::FlatTop}) {
+        testManager.setWindow(window);
+        RadarMeasurement measurement = testManager.processSamples(samples);
+        EXPECT_NEAR(measurement.snrDB, 29.0f, 1.5f) << windowTypeName(window);
+        EXPECT_NEAR(measurement.noiseFloor, 10.0f, 1.0f) << windowTypeName(window);
+        EXPECT_GT(measurement.confidence, 0.999f);
+    }
+    
+    // Reads below the minimum are rejected
+    testManager.setMinimumQuality(35.0);
+    EXPECT_FALSE(testManager.processSamples(samples).detected);
+    testManager.setMinimumQuality(20.0, 0.99);
+    EXPECT_TRUE(testManager.processSamples(samples).detected);
+}
+
+// Test that the launch speed is the ball's speed at the trigger, not its average
+TEST_F(RadarTest, LaunchSpeedAtImpact) {
+    // Impact after the 40 ms club approach, then 100 mph/s of drag
+    SyntheticSignal signal;
+    signal.ballSpeedMPH = 150.0f;
+    signal.ballDecelerationMPHPerS = 100.0f;
+    signal.clubSpeedMPH = 105.0f;
+    signal.clubAmplitude = 150.0f;
+    signal.shotIntervalMs = 1000.0f;
+    SyntheticSampleSource source(signal, DEFAULT_SAMPLE_FREQ);
+    std::vector<int> samples(2048);
+    std::vector<SteadyTime> timestamps(samples.size());
+    source.read(samples.data(), samples.size(), timestamps.data());
+    SteadyTime impact = timestamps[400];
+
+    RadarMeasurement plain = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ, timestamps, impact);
+    EXPECT_EQ(plain.launchSpeedMPH, 0.0f);
+    EXPECT_GT(plain.ballSpeedMPH, 0.0f);
+
+    SpeedKalmanConfig kalman;
+    kalman.enabled = true;
+    testManager.setSpeedKalman(kalman);
+    RadarMeasurement measurement = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ, timestamps, impact);
+    EXPECT_NEAR(measurement.launchSpeedMPH, 150.0f, 1.0f);
+    EXPECT_LT(std::abs(measurement.launchSpeedMPH - 150.0f), std::abs(measurement.ballSpeedMPH - 150.0f));
+    EXPECT_NEAR(measurement.ballDecelerationMPHPerS, 100.0f, 30.0f);
+    EXPECT_GT(measurement.launchSpeedUncertaintyMPH, 0.0f);
+
+    // Without a trigger time, impact is the tracker's first ball frame
+    RadarMeasurement untimed = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+    EXPECT_NEAR(untimed.launchSpeedMPH, 150.0f, 3.0f);
+}
+
+// Test the running noise floor measured from the idle stream
+TEST_F(RadarTest, IdleNoiseFloor) {
+    SyntheticSignal signal;
+    signal.ballAmplitude = 0.0f;
+    signal.noiseAmplitude = 6.0f;
+    testManager.useSampleSource(std::make_unique<SyntheticSampleSource>(signal, DEFAULT_SAMPLE_FREQ, 1.0));
+    EXPECT_EQ(testManager.getNoiseFloor(), 0.0);
+    
+    testManager.startAcquisition(8192);
+    for (int i = 0; i < 200 && testManager.getNoiseFloor() == 0.0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_NEAR(testManager.getNoiseFloor(), 6.0, 0.6);
+    
+    // Measurements now use it; a weak return in a quieter capture is judged
+    // against the stream's noise
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 2.0);
+    std::vector<int> samples(DEFAULT_SAMPLE_COUNT);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<int>(std::lround(512.0 + 30.0 * std::sin(2.0 * M_PI * 3000.0 * i / 10000.0) +
+                                                  noise(rng)));
+    }
+    RadarMeasurement measurement = testManager.processSamples(samples);
+    EXPECT_NEAR(measurement.noiseFloor, 6.0f, 0.6f);
+    EXPECT_NEAR(measurement.snrDB, 10.0f * std::log10(30.0f * 30.0f / 2.0f / 36.0f), 1.5f);
+    
+    // Once the stream stops, a capture is judged on its own noise, whatever ran before
+    testManager.stopAcquisition();
+    EXPECT_EQ(testManager.getNoiseFloor(), 0.0);
+    measurement = testManager.processSamples(samples);
+    EXPECT_NEAR(measurement.noiseFloor, 2.0f, 0.3f);
+    EXPECT_NEAR(measurement.snrDB, 10.0f * std::log10(30.0f * 30.0f / 2.0f / 4.0f), 1.5f);
+}
+
+// Test that the measured sample rate is used instead of the nominal one
+TEST_F(RadarTest, MeasuredSampleRateCorrectsDrift) {
+    float testSpeed = 100.0f;
+    testManager.setTestSpeed(testSpeed);
+    // ADC is actually running 5% slow
+    testManager.setSampleTiming(9500.0, 0.0);
+    
+    std::vector<SteadyTime> timestamps;
+    std::vector<int> samples = testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ, timestamps);
+    
+    // Assuming the nominal rate reads ~5% fast
+    RadarMeasurement nominal = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ);
+    EXPECT_GT(nominal.speedMPH, testSpeed * 1.03f);
+    
+    RadarMeasurement measured = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ, timestamps);
+    EXPECT_NEAR(measured.speedMPH, testSpeed, 1.0f);
+    EXPECT_NEAR(measured.timing.effectiveRate, 9500.0, 5.0);
+    EXPECT_LT(measured.timing.jitterRmsMicros, 1.0);
+    EXPECT_FALSE(measured.timing.resampled);
+}
+
+// Test that jittery captures are resampled before the FFT
+TEST_F(RadarTest, JitterTriggersResampling) {
+    float testSpeed = 120.0f;
+    testManager.setTestSpeed(testSpeed);
+    testManager.setSampleTiming(DEFAULT_SAMPLE_FREQ, 15.0);
+    
+    std::vector<SteadyTime> timestamps;
+    std::vector<int> samples = testManager.readSamples(DEFAULT_SAMPLE_COUNT, DEFAULT_SAMPLE_FREQ, timestamps);
+    
+    RadarMeasurement measurement = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ, timestamps);
+    EXPECT_TRUE(measurement.timing.resampled);
+    EXPECT_GT(measurement.timing.jitterRmsMicros, 10.0);
+    EXPECT_GT(measurement.timing.jitterMaxMicros, measurement.timing.jitterRmsMicros);
+    EXPECT_NEAR(measurement.speedMPH, testSpeed, 3.0f);
+    
+    // With a high enough threshold the capture is used as is
+    testManager.setJitterThreshold(1.0);
+    measurement = testManager.processSamples(samples, DEFAULT_SAMPLE_FREQ, timestamps);
+    EXPECT_FALSE(measurement.timing.resampled);
+}
+
+// Test that shots in the stream don't raise the idle noise floor, even
+// when nothing triggers on them
+TEST_F(RadarTest, NoiseFloorIgnoresShots) {
+    SyntheticSignal signal;
+    signal.ballAmplitude = 400.0f;
+    signal.clubSpeedMPH = 100.0f;
+    signal.clubAmplitude = 300.0f;
+    signal.noiseAmplitude = 6.0f;
+    signal.shotIntervalMs = 600.0f;
+    testManager.useSampleSource(std::make_unique<SyntheticSampleSource>(signal, DEFAULT_SAMPLE_FREQ, 1.0));
+    
+    testManager.startAcquisition(8192);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    double floor = testManager.getNoiseFloor();
+    testManager.stopAcquisition();
+    EXPECT_NEAR(floor, 6.0, 0.6);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <string>
+#include "realtime.hpp"
+
+namespace {
+// Controller that pretends every system call succeeds
+class SucceedingRealtimeController : public RealtimeController {
+public:
+    int priority = 0;
+    int cpu = -1;
+    bool locked = false;
+    std::string isolated = "2-3";
+
+protected:
+    int setFifoScheduling(int priority) override {
+        this->priority = priority;
+        return 0;
+    }
+    int setCpuAffinity(int cpu) override {
+        this->cpu = cpu;
+        return 0;
+    }
+    int lockAllMemory() override {
+        locked = true;
+        return 0;
+    }
+    std::string isolatedCpus() override { return isolated; }
+};
+
+// Controller simulating an unprivileged process
+class FailingRealtimeController : public RealtimeController {
+protected:
+    int setFifoScheduling(int) override { return EPERM; }
+    int setCpuAffinity(int) override { return EINVAL; }
+    int lockAllMemory() override { return ENOMEM; }
+    std::string isolatedCpus() override { return ""; }
+};
+}
+
+// Test that nothing is touched unless real-time mode is enabled
+TEST(RealtimeTest, DisabledDoesNothing) {
+    SucceedingRealtimeController controller;
+    RealtimeReport report = controller.apply(RealtimeConfig());
+    
+    EXPECT_TRUE(report.fullyApplied());
+    EXPECT_FALSE(report.scheduling);
+    EXPECT_FALSE(controller.locked);
+    EXPECT_EQ(controller.priority, 0);
+}
+
+// Test applying every setting on an isolated CPU
+TEST(RealtimeTest, AppliesAllSettings) {
+    SucceedingRealtimeController controller;
+    RealtimeConfig config;
+    config.enabled = true;
+    config.priority = 70;
+    config.cpu = 3;
+    
+    RealtimeReport report = controller.apply(config);
+    EXPECT_TRUE(report.fullyApplied());
+    EXPECT_TRUE(report.scheduling);
+    EXPECT_TRUE(report.affinity);
+    EXPECT_TRUE(report.memoryLocked);
+    EXPECT_EQ(controller.priority, 70);
+    EXPECT_EQ(controller.cpu, 3);
+}
+
+// Test that pinning to a CPU the scheduler still uses is reported
+TEST(RealtimeTest, WarnsAboutNonIsolatedCpu) {
+    SucceedingRealtimeController controller;
+    RealtimeConfig config;
+    config.enabled = true;
+    config.cpu = 1;
+    
+    RealtimeReport report = controller.apply(config);
+    EXPECT_TRUE(report.affinity);
+    ASSERT_EQ(report.problems.size(), 1u);
+    EXPECT_NE(report.problems[0].find("isolcpus=1"), std::string::npos);
+}
+
+// Test the fallback report without the required privileges
+TEST(RealtimeTest, ReportsMissingPrivileges) {
+    FailingRealtimeController controller;
+    RealtimeConfig config;
+    config.enabled = true;
+    config.cpu = 2;
+    
+    RealtimeReport report = controller.apply(config);
+    EXPECT_FALSE(report.fullyApplied());
+    EXPECT_FALSE(report.scheduling);
+    EXPECT_FALSE(report.affinity);
+    EXPECT_FALSE(report.memoryLocked);
+    EXPECT_EQ(report.problems.size(), 3u);
+    
+    std::string summary = report.summary();
+    EXPECT_NE(summary.find("SCHED_FIFO off"), std::string::npos);
+    EXPECT_NE(summary.find("CAP_SYS_NICE"), std::string::npos);
+    EXPECT_NE(summary.find("ulimit -l"), std::string::npos);
+}
+
+// Test parsing kernel cpu lists
+TEST(RealtimeTest, CpuListContains) {
+    EXPECT_TRUE(cpuListContains("3", 3));
+    EXPECT_TRUE(cpuListContains("1,3-5", 4));
+    EXPECT_TRUE(cpuListContains("1,3-5", 1));
+    EXPECT_FALSE(cpuListContains("1,3-5", 2));
+    EXPECT_FALSE(cpuListContains("1,3-5", 6));
+    EXPECT_FALSE(cpuListContains("", 0));
+    EXPECT_FALSE(cpuListContains("garbage", 0));
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <chrono>
+#include "sample_history.hpp"
+
+class SampleHistoryTest : public ::testing::Test {
+protected:
+    SampleHistory history{16};
+    SteadyTime start = std::chrono::steady_clock::now();
+    std::chrono::nanoseconds period{100000}; // 10 kHz
+    
+    // Write `count` samples numbered from `first`, timed as a continuous stream
+    void writeRamp(int first, int count) {
+        std::vector<int16_t> samples(count);
+        std::vector<SteadyTime> times(count);
+        for (int i = 0; i < count; i++) {
+            samples[i] = static_cast<int16_t>(first + i);
+            times[i] = start + period * (first + i);
+        }
+        history.write(samples.data(), times.data(), samples.size());
+    }
+};
+
+// Test capacity rounding
+TEST(SampleHistoryCapacity, RoundsUpToPowerOfTwo) {
+    SampleHistory history(1000);
+    EXPECT_EQ(history.capacity(), 1024u);
+}
+
+// Test a window inside the buffer
+TEST_F(SampleHistoryTest, ContiguousWindow) {
+    writeRamp(0, 10);
+    EXPECT_EQ(history.totalWritten(), 10u);
+    
+    SampleWindow window;
+    ASSERT_TRUE(history.window(2, 5, window));
+    EXPECT_EQ(window.size(), 5u);
+    EXPECT_EQ(window.second.size, 0u);
+    for (size_t i = 0; i < window.size(); i++) {
+        EXPECT_EQ(window[i], static_cast<int16_t>(2 + i));
+    }
+    EXPECT_EQ(window.startTime, start + period * 2);
+}
+
+// Test a window that wraps around the end of the ring
+TEST_F(SampleHistoryTest, WrappedWindow) {
+    writeRamp(0, 12);
+    writeRamp(12, 10);
+    
+    SampleWindow window;
+    ASSERT_TRUE(history.window(10, 10, window));
+    EXPECT_EQ(window.first.size, 6u);
+    EXPECT_EQ(window.second.size, 4u);
+    for (size_t i = 0; i < window.size(); i++) {
+        EXPECT_EQ(window[i], static_cast<int16_t>(10 + i));
+    }
+}
+
+// Test that ranges outside the buffer are rejected
+TEST_F(SampleHistoryTest, RejectsUnavailableRanges) {
+    writeRamp(0, 40);
+    SampleWindow window;
+    
+    // Overwritten
+    EXPECT_FALSE(history.window(10, 4, window));
+    // Not written yet
+    EXPECT_FALSE(history.window(38, 4, window));
+    // Larger than the buffer
+    EXPECT_FALSE(history.window(24, 17, window));
+    EXPECT_TRUE(history.window(24, 16, window));
+}
+
+// Test that overwriting is detected after a window was taken
+TEST_F(SampleHistoryTest, DetectsOverwrittenWindow) {
+    writeRamp(0, 16);
+    SampleWindow window;
+    ASSERT_TRUE(history.window(4, 8, window));
+    EXPECT_TRUE(history.isIntact(window));
+    
+    writeRamp(16, 4);
+    EXPECT_TRUE(history.isIntact(window));
+    
+    writeRamp(20, 1);
+    EXPECT_FALSE(history.isIntact(window));
+}
+
+// Test mapping timestamps to sample indices
+TEST_F(SampleHistoryTest, IndexForTime) {
+    writeRamp(0, 30);
+    uint64_t index = 0;
+    
+    ASSERT_TRUE(history.indexForTime(start + period * 20, index));
+    EXPECT_EQ(index, 20u);
+    
+    // Between two samples: the next sample is returned
+    ASSERT_TRUE(history.indexForTime(start + period * 25 + period / 2, index));
+    EXPECT_EQ(index, 26u);
+    
+    // Too old, and in the future
+    EXPECT_FALSE(history.indexForTime(start + period * 2, index));
+    EXPECT_FALSE(history.indexForTime(start + period * 40, index));
+}
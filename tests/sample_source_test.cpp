@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+#include <vector>
+#include "sample_source.hpp"
+#include "logger.hpp"
+
+class SampleSourceTest : public ::testing::Test {
+protected:
+    std::stringstream testStream;
+    std::string wavPath = "sample_source_test.wav";
+    std::string rawPath = "sample_source_test.raw";
+    
+    void SetUp() override {
+        Logger::init(testStream);
+    }
+    
+    void TearDown() override {
+        std::remove(wavPath.c_str());
+        std::remove(rawPath.c_str());
+        Logger::init();
+    }
+};
+
+// Test the synthetic generator stays centered in the ADC range
+TEST_F(SampleSourceTest, SyntheticSignalRange) {
+    SyntheticSampleSource source;
+    std::vector<int> samples(4096);
+    ASSERT_EQ(source.read(samples.data(), samples.size()), samples.size());
+    
+    double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    EXPECT_NEAR(mean, 512.0, 10.0);
+    for (int sample : samples) {
+        EXPECT_GE(sample, 0);
+        EXPECT_LE(sample, 1023);
+    }
+}
+
+// Test that the same seed gives the same signal
+TEST_F(SampleSourceTest, SyntheticSignalIsDeterministic) {
+    SyntheticSignal signal;
+    signal.clubSpeedMPH = 90.0f;
+    signal.clubAmplitude = 150.0f;
+    signal.shotIntervalMs = 500.0f;
+    
+    SyntheticSampleSource a(signal), b(signal);
+    std::vector<int> samplesA(2048), samplesB(2048);
+    a.read(samplesA.data(), samplesA.size());
+    b.read(samplesB.data(), samplesB.size());
+    EXPECT_EQ(samplesA, samplesB);
+}
+
+// Test that shots have a quiet period with only noise before the club arrives
+TEST_F(SampleSourceTest, SyntheticShotsHaveIdlePeriods) {
+    SyntheticSignal signal;
+    signal.shotIntervalMs = 1000.0f;
+    signal.clubSpeedMPH = 90.0f;
+    signal.clubAmplitude = 150.0f;
+    signal.noiseAmplitude = 0.0f;
+    
+    SyntheticSampleSource source(signal, 10000);
+    std::vector<int> samples(10000);
+    source.read(samples.data(), samples.size());
+    
+    // 500 ms into the cycle both returns have died out
+    for (int i = 5000; i < 5100; i++) {
+        EXPECT_EQ(samples[i], 512);
+    }
+}
+
+// Test WAV recording and replay
+TEST_F(SampleSourceTest, WavRoundTrip) {
+    std::vector<int> recorded(1000);
+    for (size_t i = 0; i < recorded.size(); i++) {
+        recorded[i] = static_cast<int>(i % 1024);
+    }
+    ASSERT_TRUE(writeWavFile(wavPath, recorded, 8000));
+    
+    FileSampleSource source(wavPath, 0.0);
+    ASSERT_TRUE(source.isOpen());
+    EXPECT_EQ(source.sampleRate(), 8000);
+    EXPECT_FALSE(source.setSampleRate(10000));
+    
+    std::vector<int> replayed(1200);
+    EXPECT_EQ(source.read(replayed.data(), replayed.size()), recorded.size());
+    replayed.resize(recorded.size());
+    EXPECT_EQ(replayed, recorded);
+}
+
+// Test raw int16 capture files
+TEST_F(SampleSourceTest, RawFile) {
+    std::ofstream out(rawPath, std::ios::binary);
+    for (int16_t value : {100, 512, 1023}) {
+        out.put(static_cast<char>(value & 0xFF));
+        out.put(static_cast<char>(value >> 8));
+    }
+    out.close();
+    
+    FileSampleSource source(rawPath, 0.0, false, 20000);
+    EXPECT_EQ(source.sampleRate(), 20000);
+    std::vector<int> samples(3);
+    ASSERT_EQ(source.read(samples.data(), samples.size()), 3u);
+    EXPECT_EQ(samples, (std::vector<int>{100, 512, 1023}));
+}
+
+// Test looping replay
+TEST_F(SampleSourceTest, LoopingReplay) {
+    ASSERT_TRUE(writeWavFile(wavPath, {1, 2, 3}, 10000));
+    FileSampleSource source(wavPath, 0.0, true);
+    
+    std::vector<int> samples(7);
+    ASSERT_EQ(source.read(samples.data(), samples.size()), 7u);
+    EXPECT_EQ(samples, (std::vector<int>{1, 2, 3, 1, 2, 3, 1}));
+}
+
+// Test replay pacing faster than real time
+TEST_F(SampleSourceTest, ReplaySpeed) {
+    ASSERT_TRUE(writeWavFile(wavPath, std::vector<int>(2000, 512), 10000));
+    
+    // 200 ms of samples at 4x speed
+    FileSampleSource source(wavPath, 4.0);
+    std::vector<int> samples(2000);
+    auto start = std::chrono::steady_clock::now();
+    source.read(samples.data(), samples.size());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    EXPECT_GE(elapsed, std::chrono::milliseconds(49));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(150));
+}
+
+// Test creating sources from spec strings
+TEST_F(SampleSourceTest, MakeSampleSource) {
+    auto synthetic = makeSampleSource("synthetic:ball=120,noise=5,speed=0", 0, 20000);
+    ASSERT_NE(synthetic, nullptr);
+    EXPECT_EQ(synthetic->sampleRate(), 20000);
+    EXPECT_NE(synthetic->describe().find("ball 120"), std::string::npos);
+    
+    ASSERT_TRUE(writeWavFile(wavPath, {512, 512}, 12000));
+    auto file = makeSampleSource("file:" + wavPath + ",speed=0", 0, 10000);
+    ASSERT_NE(file, nullptr);
+    EXPECT_EQ(file->sampleRate(), 12000);
+    
+    EXPECT_EQ(makeSampleSource("file:does_not_exist.wav", 0, 10000), nullptr);
+    EXPECT_EQ(makeSampleSource("synthetic:ball=fast", 0, 10000), nullptr);
+    EXPECT_EQ(makeSampleSource("microphone", 0, 10000), nullptr);
+}
+
+// Test finding the recordings in a capture directory
+TEST_F(SampleSourceTest, ListCaptureFiles) {
+    std::string directory = "sample_source_test_captures";
+    std::filesystem::create_directory(directory);
+    ASSERT_TRUE(writeWavFile(directory + "/shot2.wav", {512, 512}, 10000));
+    ASSERT_TRUE(writeWavFile(directory + "/shot1.wav", {512, 512}, 10000));
+    std::ofstream(directory + "/shot3.raw") << "raw";
+    std::ofstream(directory + "/notes.txt") << "not a capture";
+    std::filesystem::create_directory(directory + "/old.wav");
+    
+    std::vector<std::string> files = listCaptureFiles(directory);
+    EXPECT_EQ(files, (std::vector<std::string>{directory + "/shot1.wav", directory + "/shot2.wav",
+                                               directory + "/shot3.raw"}));
+    std::filesystem::remove_all(directory);
+    
+    EXPECT_TRUE(listCaptureFiles(directory).empty());
+    EXPECT_NE(testStream.str().find("Failed to read capture directory"), std::string::npos);
+}
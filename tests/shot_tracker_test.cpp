@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <initializer_list>
+#include <vector>
+#include "shot_tracker.hpp"
+
+namespace {
+// A frame with returns at the given speeds, strongest first
+StftFrame frame(uint64_t firstSample, std::initializer_list<float> speeds) {
+    StftFrame result{};
+    result.firstSample = firstSample;
+    for (float speed : speeds) {
+        result.peaks[result.peakCount++] = {speed * 31.4f, speed, 100.0f};
+    }
+    return result;
+}
+}
+
+// Test a club return accelerating into impact followed by the ball
+TEST(ShotTrackerTest, ClubThenBall) {
+    std::vector<StftFrame> frames = {
+        frame(0, {88.0f}),
+        frame(64, {91.0f}),
+        frame(128, {93.0f}),
+        frame(192, {94.0f, 139.0f}),  // Impact
+        frame(256, {140.0f, 75.0f}),
+        frame(320, {139.5f, 74.0f}),
+        frame(384, {139.0f}),
+    };
+    ShotSpeeds shot = trackShot(frames);
+    EXPECT_NEAR(shot.ballSpeedMPH, 139.5f, 0.6f);
+    EXPECT_FLOAT_EQ(shot.clubSpeedMPH, 94.0f);
+    EXPECT_NEAR(shot.smashFactor, 139.5f / 94.0f, 0.01f);
+    EXPECT_EQ(shot.impactSample, 192u);
+    EXPECT_EQ(shot.ballFrames, 4u);
+}
+
+// Test that a fast spike in a single frame isn't taken for the ball
+TEST(ShotTrackerTest, IgnoresShortLivedReturns) {
+    std::vector<StftFrame> frames = {
+        frame(0, {80.0f, 190.0f}),
+        frame(64, {82.0f}),
+        frame(128, {118.0f, 83.0f}),
+        frame(192, {119.0f}),
+        frame(256, {118.5f}),
+    };
+    ShotSpeeds shot = trackShot(frames);
+    EXPECT_NEAR(shot.ballSpeedMPH, 118.5f, 0.6f);
+    EXPECT_EQ(shot.impactSample, 128u);
+    EXPECT_FLOAT_EQ(shot.clubSpeedMPH, 83.0f);
+}
+
+// Test a ball with no club return before it
+TEST(ShotTrackerTest, BallWithoutClub) {
+    std::vector<StftFrame> frames = {
+        frame(0, {150.0f}),
+        frame(64, {151.0f, 40.0f}),  // Far too slow to be the club
+        frame(128, {150.5f}),
+    };
+    ShotSpeeds shot = trackShot(frames);
+    EXPECT_NEAR(shot.ballSpeedMPH, 150.5f, 0.6f);
+    EXPECT_EQ(shot.clubSpeedMPH, 0.0f);
+    EXPECT_EQ(shot.smashFactor, 0.0f);
+}
+
+// Test that nothing is reported without a persistent return
+TEST(ShotTrackerTest, NoBall) {
+    EXPECT_EQ(trackShot({}).ballSpeedMPH, 0.0f);
+
+    std::vector<StftFrame> frames = {frame(0, {90.0f}), frame(64, {120.0f}), frame(128, {}), frame(192, {60.0f})};
+    ShotSpeeds shot = trackShot(frames);
+    EXPECT_EQ(shot.ballSpeedMPH, 0.0f);
+    EXPECT_EQ(shot.clubSpeedMPH, 0.0f);
+
+    ShotTrackerConfig config;
+    config.minBallFrames = 1;
+    EXPECT_FLOAT_EQ(trackShot(frames, config).ballSpeedMPH, 120.0f);
+}
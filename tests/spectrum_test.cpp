@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+#include "spectrum.hpp"
+
+namespace {
+// Samples of a tone at a fractional FFT bin, on a DC offset
+std::vector<int> tone(size_t count, double bin, double amplitude = 400.0, double phase = 0.3) {
+    std::vector<int> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = static_cast<int>(std::lround(512.0 + amplitude * std::cos(2.0 * M_PI * bin * i / count + phase)));
+    }
+    return samples;
+}
+
+// Direct DFT of samples minus the mean at a whole bin
+std::complex<double> dft(const std::vector<int>& samples, double mean, int bin) {
+    std::complex<double> sum = 0.0;
+    for (size_t i = 0; i < samples.size(); i++) {
+        sum += (samples[i] - mean) * std::polar(1.0, -2.0 * M_PI * bin * i / samples.size());
+    }
+    return sum;
+}
+}
+
+// Test magnitudes of interleaved complex values in both precisions
+TEST(SpectrumTest, ComputeMagnitudes) {
+    std::vector<double> spectrum = {3.0, 4.0, 0.0, -2.0, -5.0, 12.0};
+    std::vector<double> magnitudes(3);
+    computeMagnitudes(spectrum.data(), 3, magnitudes.data());
+    EXPECT_DOUBLE_EQ(magnitudes[0], 5.0);
+    EXPECT_DOUBLE_EQ(magnitudes[1], 2.0);
+    EXPECT_DOUBLE_EQ(magnitudes[2], 13.0);
+    
+    std::vector<float> singleSpectrum(spectrum.begin(), spectrum.end());
+    std::vector<float> singleMagnitudes(3);
+    computeMagnitudes(singleSpectrum.data(), 3, singleMagnitudes.data());
+    EXPECT_FLOAT_EQ(singleMagnitudes[0], 5.0f);
+    EXPECT_FLOAT_EQ(singleMagnitudes[1], 2.0f);
+    EXPECT_FLOAT_EQ(singleMagnitudes[2], 13.0f);
+}
+
+// Test the Goertzel recurrence against a direct DFT
+TEST(SpectrumTest, GoertzelMatchesDft) {
+    std::vector<int> samples = tone(256, 20.3);
+    for (int bin : {0, 19, 20, 21, 100}) {
+        std::complex<double> expected = dft(samples, 512.0, bin);
+        std::complex<double> actual = goertzel(samples.data(), samples.size(), 512.0, bin);
+        EXPECT_NEAR(actual.real(), expected.real(), 1e-6 * samples.size()) << bin;
+        EXPECT_NEAR(actual.imag(), expected.imag(), 1e-6 * samples.size()) << bin;
+    }
+}
+
+// Test the complex ratio estimators on tones between bins
+TEST(SpectrumTest, JacobsenAndQuinnOffsets) {
+    for (double offset : {-0.4, -0.17, 0.0, 0.25, 0.45}) {
+        std::vector<int> samples = tone(1024, 100.0 + offset);
+        std::complex<double> bins[3];
+        for (int i = 0; i < 3; i++) {
+            bins[i] = goertzel(samples.data(), samples.size(), 512.0, 99 + i);
+        }
+        EXPECT_NEAR(jacobsenPeakOffset(bins), offset, 0.01) << offset;
+        EXPECT_NEAR(quinnPeakOffset(bins), offset, 0.005) << offset;
+    }
+}
+
+// Test parabolic interpolation on a windowed spectrum
+TEST(SpectrumTest, ParabolicOffset) {
+    const size_t count = 1024;
+    for (double offset : {-0.3, 0.1, 0.35}) {
+        // Hann window, then the three bins around the peak
+        std::vector<int> samples = tone(count, 200.0 + offset);
+        double magnitude[3];
+        for (int k = 0; k < 3; k++) {
+            std::complex<double> sum = 0.0;
+            for (size_t i = 0; i < count; i++) {
+                double window = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / (count - 1));
+                sum += (samples[i] - 512.0) * window * std::polar(1.0, -2.0 * M_PI * (199 + k) * i / count);
+            }
+            magnitude[k] = std::abs(sum);
+        }
+        EXPECT_NEAR(parabolicPeakOffset(magnitude[0], magnitude[1], magnitude[2]), offset, 0.03) << offset;
+    }
+    
+    // Degenerate input stays on the bin
+    EXPECT_EQ(parabolicPeakOffset(0.0, 1.0, 1.0), 0.0);
+    EXPECT_EQ(parabolicPeakOffset(1.0, 1.0, 1.0), 0.0);
+}
+
+// Test that the uncertainty shrinks with SNR and a better estimator
+TEST(SpectrumTest, PeakUncertainty) {
+    EXPECT_NEAR(peakUncertaintyBins(PeakEstimator::None, 1e12), 1.0 / std::sqrt(12.0), 1e-6);
+    EXPECT_LT(peakUncertaintyBins(PeakEstimator::Quinn, 1e6), peakUncertaintyBins(PeakEstimator::Parabolic, 1e6));
+    EXPECT_LT(peakUncertaintyBins(PeakEstimator::Quinn, 1e6), peakUncertaintyBins(PeakEstimator::Quinn, 1e3));
+    EXPECT_LT(peakUncertaintyBins(PeakEstimator::ZeroPadded, 1e9, 8),
+              peakUncertaintyBins(PeakEstimator::ZeroPadded, 1e9, 2));
+    EXPECT_EQ(peakUncertaintyBins(PeakEstimator::Quinn, 0.0), 0.5);
+}
+
+// Test estimator names used on the command line
+TEST(SpectrumTest, ParseEstimatorNames) {
+    PeakEstimator estimator = PeakEstimator::None;
+    EXPECT_TRUE(parsePeakEstimator("quinn", estimator));
+    EXPECT_EQ(estimator, PeakEstimator::Quinn);
+    EXPECT_TRUE(parsePeakEstimator("zero-padded", estimator));
+    EXPECT_EQ(estimator, PeakEstimator::ZeroPadded);
+    EXPECT_FALSE(parsePeakEstimator("cubic", estimator));
+}
+
+// Test that powers are the squared magnitudes
+TEST(SpectrumTest, PowersAreSquaredMagnitudes) {
+    std::vector<double> spectrum = {3.0, 4.0, -1.0, 0.0, 0.5, -0.5};
+    std::vector<double> magnitudes(3);
+    std::vector<double> powers(3);
+    computeMagnitudes(spectrum.data(), 3, magnitudes.data());
+    computePowers(spectrum.data(), 3, powers.data());
+    for (size_t i = 0; i < 3; i++) {
+        EXPECT_DOUBLE_EQ(powers[i], magnitudes[i] * magnitudes[i]);
+    }
+    
+    std::vector<float> singleSpectrum(spectrum.begin(), spectrum.end());
+    std::vector<float> singlePowers(3);
+    computePowers(singleSpectrum.data(), 3, singlePowers.data());
+    EXPECT_FLOAT_EQ(singlePowers[0], 25.0f);
+}
+
+// Test the top-K heap against sorting everything
+TEST(SpectrumTest, TopBinsKeepsLargest) {
+    std::vector<double> values = {5, 1, 9, 3, 9, 7, 2, 8, 6, 0, 4};
+    TopBins<double, 4> top;
+    top.scan(values.data(), 1, values.size());
+    ASSERT_EQ(top.size(), 4u);
+    
+    SpectralBin<double> bins[4];
+    ASSERT_EQ(top.sorted(bins), 4u);
+    // Equal values come out lowest index first
+    EXPECT_EQ(bins[0].index, 2);
+    EXPECT_EQ(bins[1].index, 4);
+    EXPECT_EQ(bins[2].index, 7);
+    EXPECT_EQ(bins[3].index, 5);
+    EXPECT_EQ(bins[3].value, 7.0);
+    
+    // Fewer bins than K
+    TopBins<double, 4> few;
+    few.offer(3, 1.0);
+    few.offer(8, 2.0);
+    EXPECT_EQ(few.sorted(bins), 2u);
+    EXPECT_EQ(bins[0].index, 8);
+    few.clear();
+    EXPECT_EQ(few.size(), 0u);
+}
+
+// Test the noise estimate from powers against the one from magnitudes
+TEST(SpectrumTest, PeakPowerToNoise) {
+    std::vector<double> magnitudes = {100, 2, 3, 1, 50, 2, 4, 3, 0};
+    std::vector<double> powers(magnitudes.size());
+    for (size_t i = 0; i < magnitudes.size(); i++) {
+        powers[i] = magnitudes[i] * magnitudes[i];
+    }
+    EXPECT_NEAR(peakPowerToNoise(powers.data(), powers.size(), 2500.0),
+                peakToNoise(magnitudes.data(), magnitudes.size(), 50.0), 1e-9);
+    EXPECT_NEAR(peakToNoise(magnitudes.data(), magnitudes.size(), 50.0), 2500.0 * std::log(2.0) / 9.0, 1e-9);
+}
+
+// Test the CFAR threshold multipliers against their false alarm rates
+TEST(SpectrumTest, CfarScale) {
+    CfarConfig config;
+    config.falseAlarmRate = 1e-4;
+    EXPECT_NEAR(cfarScale(config), 32.0 * (std::pow(1e-4, -1.0 / 32.0) - 1.0), 1e-9);
+    
+    // Ordered statistic: the 24th smallest of 32 cells
+    config.method = CfarMethod::OrderedStatistic;
+    double scale = cfarScale(config);
+    double falseAlarms = 1.0;
+    for (int i = 0; i < 24; i++) {
+        falseAlarms *= (32.0 - i) / (32.0 - i + scale);
+    }
+    EXPECT_NEAR(falseAlarms, 1e-4, 1e-8);
+}
+
+// Test the running-sum cell averaging against summing each window, and its
+// false alarm rate in exponential noise
+TEST(SpectrumTest, CellAveragingCfar) {
+    std::mt19937 rng(3);
+    std::exponential_distribution<double> noise(1.0);
+    std::vector<double> powers(20000);
+    for (double& power : powers) {
+        power = noise(rng);
+    }
+    CfarConfig config;
+    config.falseAlarmRate = 1e-2;
+    std::vector<double> thresholds(powers.size());
+    cfarThresholds(powers.data(), powers.size(), config, thresholds.data());
+    
+    double scale = cfarScale(config);
+    size_t detections = 0;
+    for (int i = 1; i < static_cast<int>(powers.size()); i++) {
+        double sum = 0.0;
+        int count = 0;
+        for (int j = i - 18; j <= i + 18; j++) {
+            if (j >= 1 && j < static_cast<int>(powers.size()) && std::abs(j - i) > 2) {
+                sum += powers[j];
+                count++;
+            }
+        }
+        ASSERT_NEAR(thresholds[i], scale * sum / count, 1e-9 * thresholds[i]) << i;
+        detections += powers[i] > thresholds[i];
+    }
+    EXPECT_NEAR(detections / 20000.0, 1e-2, 3e-3);
+    
+    // Single precision gives the same thresholds
+    std::vector<float> singlePowers(powers.begin(), powers.end());
+    std::vector<float> singleThresholds(powers.size());
+    cfarThresholds(singlePowers.data(), singlePowers.size(), config, singleThresholds.data());
+    for (size_t i = 1; i < powers.size(); i++) {
+        ASSERT_NEAR(singleThresholds[i], thresholds[i], 1e-4 * thresholds[i]) << i;
+    }
+}
+
+// Test that a weak target next to a strong one is detected by the ordered
+// statistic, which the strong one hides from cell averaging
+TEST(SpectrumTest, OrderedStatisticCfar) {
+    std::vector<double> powers(200, 1.0);
+    powers[100] = 60.0;
+    powers[105] = 1000.0;
+    std::vector<double> thresholds(powers.size());
+    
+    CfarConfig config;
+    cfarThresholds(powers.data(), powers.size(), config, thresholds.data());
+    EXPECT_LT(powers[100], thresholds[100]);
+    EXPECT_GT(powers[105], thresholds[105]);
+    
+    config.method = CfarMethod::OrderedStatistic;
+    cfarThresholds(powers.data(), powers.size(), config, thresholds.data());
+    EXPECT_GT(powers[100], thresholds[100]);
+    EXPECT_GT(powers[105], thresholds[105]);
+    EXPECT_LT(powers[50], thresholds[50]);
+    EXPECT_DOUBLE_EQ(thresholds[50], cfarScale(config));
+}
+
+// Test the noise power behind the peak ratios and the confidence in a peak
+TEST(SpectrumTest, NoisePowerAndConfidence) {
+    std::vector<double> powers = {1e6, 4, 9, 1, 2500, 4, 16, 9, 0};
+    EXPECT_NEAR(noisePower(powers.data(), powers.size()), 9.0 / std::log(2.0), 1e-9);
+    EXPECT_NEAR(peakPowerToNoise(powers.data(), powers.size(), 2500.0),
+                2500.0 / noisePower(powers.data(), powers.size()), 1e-9);
+    
+    // Among 500 noise bins, one is expected to reach ln 500 times the mean
+    EXPECT_NEAR(peakConfidence(std::log(500.0), 500), std::exp(-1.0), 0.01);
+    EXPECT_GT(peakConfidence(30.0, 500), 0.999999);
+    EXPECT_LT(peakConfidence(3.0, 500), 1e-10);
+    EXPECT_EQ(peakConfidence(0.0, 500), 0.0);
+}
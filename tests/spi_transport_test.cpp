@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "sample_source.hpp"
+#include "spi_transport.hpp"
+#include "logger.hpp"
+
+// Mock SPI bus with an MCP3008 that returns a counter as conversion result
+class MockSpiTransport : public SpiTransport {
+public:
+    bool transferFrames(uint8_t* buffer, size_t frameSize, size_t count) override {
+        transferSizes.push_back(count);
+        for (size_t i = 0; i < count; i++) {
+            uint8_t* frame = buffer + i * frameSize;
+            channels.push_back((frame[1] >> 4) & 0x07);
+            int value = nextValue++ & 0x3FF;
+            frame[0] = 0x00;
+            frame[1] = static_cast<uint8_t>(value >> 8);
+            frame[2] = static_cast<uint8_t>(value & 0xFF);
+        }
+        return !fail;
+    }
+    
+    void setFramePeriod(std::chrono::nanoseconds period) override {
+        framePeriod = period;
+    }
+    
+    std::vector<size_t> transferSizes;
+    std::vector<int> channels;
+    std::chrono::nanoseconds framePeriod{0};
+    int nextValue = 0;
+    bool fail = false;
+};
+
+// Transport that takes as long as the hardware: frames a frame period
+// apart, with no gap after the last one, like the bcm2835 transport
+class PacedSpiTransport : public MockSpiTransport {
+public:
+    bool transferFrames(uint8_t* buffer, size_t frameSize, size_t count) override {
+        for (size_t i = 0; i < count; i++) {
+            // A 20 us conversion, then the wait for the next frame
+            auto frameTime = i + 1 < count ? framePeriod : std::chrono::nanoseconds(20000);
+            auto frameEnd = std::chrono::steady_clock::now() + frameTime;
+            while (std::chrono::steady_clock::now() < frameEnd) {
+            }
+        }
+        return MockSpiTransport::transferFrames(buffer, frameSize, count);
+    }
+};
+
+// Transport that times its frames, with every fourth conversion 10 us late
+class TimedSpiTransport : public MockSpiTransport {
+public:
+    bool transferFrames(uint8_t* buffer, size_t frameSize, size_t count) override {
+        auto start = std::chrono::steady_clock::now();
+        starts.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            starts[i] = start + framePeriod * i + std::chrono::microseconds(i % 4 == 3 ? 10 : 0);
+        }
+        return MockSpiTransport::transferFrames(buffer, frameSize, count);
+    }
+    
+    bool frameTimes(SteadyTime* times, size_t count) const override {
+        std::copy(starts.begin(), starts.begin() + count, times);
+        return true;
+    }
+    
+    std::vector<SteadyTime> starts;
+};
+
+class SpiTransportTest : public ::testing::Test {
+protected:
+    std::stringstream testStream;
+    MockSpiTransport* transport = nullptr;
+    std::unique_ptr<Mcp3008SampleSource> source;
+    
+    void SetUp() override {
+        Logger::init(testStream);
+        auto mock = std::make_unique<MockSpiTransport>();
+        transport = mock.get();
+        source = std::make_unique<Mcp3008SampleSource>(std::move(mock), 3, 20000);
+    }
+    
+    void TearDown() override {
+        Logger::init();
+    }
+};
+
+// Test MCP3008 frame encoding and decoding
+TEST(Mcp3008Test, EncodeDecode) {
+    uint8_t frame[MCP3008_FRAME_SIZE];
+    mcp3008EncodeRead(frame, 5);
+    EXPECT_EQ(frame[0], 0x01);
+    EXPECT_EQ(frame[1], 0x80 | (5 << 4));
+    EXPECT_EQ(frame[2], 0x00);
+    
+    // Only the low two bits of the middle byte belong to the result
+    uint8_t response[MCP3008_FRAME_SIZE] = {0xFF, 0xFE, 0x34};
+    EXPECT_EQ(mcp3008Decode(response), (0x02 << 8) | 0x34);
+}
+
+// Test that conversions are queued in batches
+TEST_F(SpiTransportTest, BatchedTransfers) {
+    source->setBatchSize(32);
+    std::vector<int> samples(100);
+    ASSERT_EQ(source->read(samples.data(), samples.size()), 100u);
+    
+    EXPECT_EQ(transport->transferSizes, (std::vector<size_t>{32, 32, 32, 4}));
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(samples[i], i);
+        EXPECT_EQ(transport->channels[i], 3);
+    }
+    
+    // Frames inside a batch are paced at the sample period
+    EXPECT_EQ(transport->framePeriod, std::chrono::microseconds(50));
+}
+
+// Test the frame spacing asked of the transport at a rate that isn't a whole
+// number of microseconds per sample
+TEST_F(SpiTransportTest, FramePeriodAt48kHz) {
+    source->setSampleRate(48000);
+    std::vector<int> samples(64);
+    source->read(samples.data(), samples.size());
+    EXPECT_EQ(transport->framePeriod, std::chrono::nanoseconds(20833));
+    
+    // Gaps a spidev transport would put after each frame at 3.6 MHz, where a
+    // frame takes 6.67 us: some round down and some up, so that 32 frames
+    // span 32 periods to within a microsecond instead of running 4% fast
+    auto framePeriod = transport->framePeriod;
+    double frameMicros = MCP3008_FRAME_SIZE * 8 / 3.6;
+    double total = 0.0;
+    for (size_t i = 0; i < 32; i++) {
+        uint32_t gap = spiFrameGapMicros(framePeriod, MCP3008_FRAME_SIZE, 3600000, i);
+        EXPECT_TRUE(gap == 14 || gap == 15) << i << ": " << gap;
+        total += frameMicros + gap;
+    }
+    EXPECT_NEAR(total, 32 * 20.833, 1.0);
+    
+    // Frames longer than the period get no gap
+    EXPECT_EQ(spiFrameGapMicros(std::chrono::microseconds(5), MCP3008_FRAME_SIZE, 3600000, 3), 0u);
+}
+
+// Test that a batch size of one transfers every sample on its own
+TEST_F(SpiTransportTest, SingleSampleTransfers) {
+    source->setBatchSize(1);
+    std::vector<int> samples(10);
+    source->read(samples.data(), samples.size());
+    EXPECT_EQ(transport->transferSizes, std::vector<size_t>(10, 1));
+}
+
+// Test that batches follow the deadline schedule instead of running early
+TEST_F(SpiTransportTest, DeadlinePacing) {
+    source->setBatchSize(10);
+    source->setSampleRate(10000);
+    std::vector<int> samples(200);
+    
+    auto start = std::chrono::steady_clock::now();
+    source->read(samples.data(), samples.size());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    // 19 batches have to wait for their deadline: 190 samples at 10 kHz
+    EXPECT_GE(elapsed, std::chrono::milliseconds(19));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(200));
+}
+
+// Test that the schedule carries over between reads, as acquisition reads
+// a block at a time and does other work in between
+TEST_F(SpiTransportTest, PacingAcrossReads) {
+    source->setBatchSize(32);
+    source->setSampleRate(10000);
+    std::vector<int> samples(64);
+    std::vector<SteadyTime> timestamps(samples.size());
+    std::vector<double> gaps;
+    SteadyTime previous;
+    for (int block = 0; block < 10; block++) {
+        source->read(samples.data(), samples.size(), timestamps.data());
+        if (block > 0) {
+            gaps.push_back(std::chrono::duration<double, std::milli>(timestamps[0] - previous).count());
+        }
+        previous = timestamps[0];
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    
+    // Blocks start 64 sample periods apart, not a block's transfers plus the work in between
+    std::nth_element(gaps.begin(), gaps.begin() + gaps.size() / 2, gaps.end());
+    EXPECT_NEAR(gaps[gaps.size() / 2], 6.4, 0.1);
+}
+
+// Test that transfer failures are reported
+TEST_F(SpiTransportTest, TransferFailure) {
+    transport->fail = true;
+    std::vector<int> samples(10);
+    EXPECT_THROW(source->read(samples.data(), samples.size()), std::runtime_error);
+}
+
+// Test that evenly paced conversions get evenly spaced timestamps
+TEST_F(SpiTransportTest, EvenTimestamps) {
+    Mcp3008SampleSource paced(std::make_unique<PacedSpiTransport>(), 3, 10000);
+    std::vector<int> samples(640);
+    std::vector<SteadyTime> timestamps(samples.size());
+    ASSERT_EQ(paced.read(samples.data(), samples.size(), timestamps.data()), samples.size());
+    
+    // Typical interval error far below the 2 us (2% of a period) at which
+    // captures are resampled. The median ignores the odd batch boundary a
+    // busy test machine delays; stamping from the transfer time is off on
+    // every interval inside a batch.
+    std::vector<double> errors;
+    for (size_t i = 1; i < timestamps.size(); i++) {
+        double interval = std::chrono::duration<double, std::micro>(timestamps[i] - timestamps[i - 1]).count();
+        errors.push_back(std::abs(interval - 100.0));
+    }
+    std::nth_element(errors.begin(), errors.begin() + errors.size() / 2, errors.end());
+    EXPECT_LT(errors[errors.size() / 2], 0.2);
+}
+
+// Test that conversions the transport timed are stamped with those times, so
+// jitter inside a batch shows in the capture's timing
+TEST_F(SpiTransportTest, MeasuredFrameTimes) {
+    auto timed = std::make_unique<TimedSpiTransport>();
+    TimedSpiTransport* frames = timed.get();
+    Mcp3008SampleSource source(std::move(timed), 3, 10000, 16);
+    std::vector<int> samples(16);
+    std::vector<SteadyTime> timestamps(samples.size());
+    source.read(samples.data(), samples.size(), timestamps.data());
+    EXPECT_EQ(timestamps, frames->starts);
+    
+    SampleTiming timing = analyzeSampleTiming(timestamps);
+    EXPECT_GT(timing.jitterMaxMicros, 5.0);
+}
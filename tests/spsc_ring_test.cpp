@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "spsc_ring.hpp"
+
+// Test capacity rounding
+TEST(SpscRingTest, RoundsUpToPowerOfTwo) {
+    SpscRing<int> ring(100);
+    EXPECT_EQ(ring.capacity(), 128u);
+    EXPECT_TRUE(ring.empty());
+}
+
+// Test single item push and pop
+TEST(SpscRingTest, PushPopSingle) {
+    SpscRing<int> ring(4);
+    EXPECT_TRUE(ring.push(7));
+    EXPECT_TRUE(ring.push(8));
+    EXPECT_EQ(ring.size(), 2u);
+    
+    int value = 0;
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, 7);
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, 8);
+    EXPECT_FALSE(ring.pop(value));
+}
+
+// Test that batch pushes stop when the ring is full and batch pops when it is empty
+TEST(SpscRingTest, PartialBatches) {
+    SpscRing<int> ring(8);
+    std::vector<int> input = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    
+    EXPECT_EQ(ring.push(input.data(), input.size()), 8u);
+    EXPECT_EQ(ring.size(), 8u);
+    EXPECT_FALSE(ring.push(10));
+    
+    std::vector<int> output(16);
+    EXPECT_EQ(ring.pop(output.data(), 5), 5u);
+    EXPECT_EQ(ring.size(), 3u);
+    EXPECT_EQ(ring.pop(output.data() + 5, 16), 3u);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(output[i], i);
+    }
+    EXPECT_TRUE(ring.empty());
+}
+
+// Test batches that wrap around the end of the storage
+TEST(SpscRingTest, WrapAround) {
+    SpscRing<int> ring(8);
+    std::vector<int> batch(5);
+    std::vector<int> output(5);
+    
+    int next = 0;
+    int expected = 0;
+    for (int round = 0; round < 10; round++) {
+        for (auto& value : batch) {
+            value = next++;
+        }
+        ASSERT_EQ(ring.push(batch.data(), batch.size()), 5u);
+        ASSERT_EQ(ring.pop(output.data(), output.size()), 5u);
+        for (int value : output) {
+            EXPECT_EQ(value, expected++);
+        }
+    }
+}
+
+// Test a producer and consumer on separate threads
+TEST(SpscRingTest, ConcurrentTransfer) {
+    SpscRing<uint32_t> ring(256);
+    const uint32_t total = 200000;
+    
+    std::thread producer([&] {
+        std::vector<uint32_t> batch(37);
+        uint32_t next = 0;
+        while (next < total) {
+            size_t count = std::min<size_t>(batch.size(), total - next);
+            for (size_t i = 0; i < count; i++) {
+                batch[i] = next + static_cast<uint32_t>(i);
+            }
+            size_t pushed = 0;
+            while (pushed < count) {
+                size_t n = ring.push(batch.data() + pushed, count - pushed);
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                pushed += n;
+            }
+            next += static_cast<uint32_t>(count);
+        }
+    });
+    
+    std::vector<uint32_t> batch(64);
+    uint32_t expected = 0;
+    bool inOrder = true;
+    while (expected < total) {
+        EXPECT_LE(ring.size(), ring.capacity());
+        size_t count = ring.pop(batch.data(), batch.size());
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < count; i++) {
+            inOrder = inOrder && batch[i] == expected;
+            expected++;
+        }
+    }
+    producer.join();
+    
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "fft_plan_cache.hpp"
+#include "static_fft.hpp"
+
+namespace {
+// Plain O(N^2) DFT of interleaved complex values
+std::vector<std::complex<double>> directDft(const std::vector<double>& interleaved, bool inverse) {
+    size_t n = interleaved.size() / 2;
+    std::vector<std::complex<double>> result(n);
+    for (size_t k = 0; k < n; k++) {
+        for (size_t j = 0; j < n; j++) {
+            double angle = (inverse ? 2.0 : -2.0) * M_PI * static_cast<double>(j * k % n) / n;
+            result[k] += std::complex<double>(interleaved[2 * j], interleaved[2 * j + 1]) * std::polar(1.0, angle);
+        }
+    }
+    return result;
+}
+
+std::vector<double> testSignal(size_t count) {
+    std::vector<double> signal(count);
+    for (size_t i = 0; i < count; i++) {
+        signal[i] = std::sin(0.37 * i * i) + 0.1 * i / count;
+    }
+    return signal;
+}
+}
+
+// Test the compile-time twiddle factors against the library's trig functions
+TEST(StaticFftTest, UnitRoots) {
+    for (size_t j = 0; j < 4096; j++) {
+        static_fft::UnitRoot root = static_fft::unitRoot(j, 4096);
+        EXPECT_NEAR(root.cos, std::cos(2.0 * M_PI * j / 4096), 1e-15) << j;
+        EXPECT_NEAR(root.sin, std::sin(2.0 * M_PI * j / 4096), 1e-15) << j;
+    }
+    static_assert(static_fft::BIT_REVERSAL<8>[1] == 4 && static_fft::BIT_REVERSAL<8>[3] == 6,
+                  "Bit reversal tables are built at compile time");
+}
+
+// Test complex transforms of even and odd powers of two against a direct DFT
+TEST(StaticFftTest, ComplexMatchesDirectDft) {
+    std::vector<double> in = testSignal(2 * 128);
+    std::vector<double> out(2 * 128);
+    for (bool inverse : {false, true}) {
+        if (inverse) {
+            StaticFft<128, double>::transform<true>(in.data(), out.data());
+        } else {
+            StaticFft<128, double>::transform(in.data(), out.data());
+        }
+        std::vector<std::complex<double>> expected = directDft(in, inverse);
+        for (size_t k = 0; k < 128; k++) {
+            EXPECT_NEAR(out[2 * k], expected[k].real(), 1e-11) << k;
+            EXPECT_NEAR(out[2 * k + 1], expected[k].imag(), 1e-11) << k;
+        }
+    }
+
+    // Radix-4 stages only, in place
+    std::vector<double> data = testSignal(2 * 256);
+    std::vector<std::complex<double>> expected = directDft(data, false);
+    StaticFft<256, double>::transformInPlace(data.data());
+    for (size_t k = 0; k < 256; k++) {
+        EXPECT_NEAR(data[2 * k], expected[k].real(), 1e-11) << k;
+        EXPECT_NEAR(data[2 * k + 1], expected[k].imag(), 1e-11) << k;
+    }
+}
+
+// Test the real transform against a direct DFT and back
+TEST(StaticFftTest, RealRoundTrip) {
+    const size_t size = 512;
+    std::vector<double> signal = testSignal(size);
+    std::vector<double> interleaved(2 * size);
+    for (size_t i = 0; i < size; i++) {
+        interleaved[2 * i] = signal[i];
+    }
+    std::vector<std::complex<double>> expected = directDft(interleaved, false);
+
+    std::vector<double> spectrum(size + 2);
+    StaticRealFft<size, double>::forward(signal.data(), spectrum.data());
+    for (size_t k = 0; k <= size / 2; k++) {
+        EXPECT_NEAR(spectrum[2 * k], expected[k].real(), 1e-10) << k;
+        EXPECT_NEAR(spectrum[2 * k + 1], expected[k].imag(), 1e-10) << k;
+    }
+
+    // Unnormalized, like FFTW
+    std::vector<double> back(size);
+    StaticRealFft<size, double>::inverse(spectrum.data(), back.data());
+    for (size_t i = 0; i < size; i++) {
+        EXPECT_NEAR(back[i] / size, signal[i], 1e-13) << i;
+    }
+}
+
+// Test plans from the built-in kernels, and the sizes they don't cover
+TEST(StaticFftTest, PlanCacheBackend) {
+    FftPlanCache cache(FftBackend::Static);
+    const int size = 1024;
+    FftPlan* forward = cache.get({size, FftDirection::RealToComplex, FftPrecision::Single, FFT_PLAN_ESTIMATE});
+    FftPlan* inverse = cache.get({size, FftDirection::ComplexToReal, FftPrecision::Single, FFT_PLAN_ESTIMATE});
+    ASSERT_NE(forward, nullptr);
+    ASSERT_NE(inverse, nullptr);
+    EXPECT_EQ(forward->backend(), FftBackend::Static);
+
+    // Cosine exactly on bin 37, through a workspace like the radar pipeline
+    FftWorkspace workspace;
+    float* in = workspace.input<float>(*forward);
+    FftComplexF* spectrum = workspace.output<FftComplexF>(*forward);
+    for (int i = 0; i < size; i++) {
+        in[i] = static_cast<float>(std::cos(2.0 * M_PI * 37 * i / size));
+    }
+    forward->execute(in, spectrum);
+    EXPECT_NEAR(spectrum[37][0], size / 2.0f, 1e-3f * size);
+    EXPECT_NEAR(spectrum[36][0], 0.0f, 1e-3f * size);
+
+    FftComplexF* inverseIn = inverse->input<FftComplexF>();
+    for (int i = 0; i < size / 2 + 1; i++) {
+        inverseIn[i][0] = spectrum[i][0];
+        inverseIn[i][1] = spectrum[i][1];
+    }
+    inverse->execute();
+    float* out = inverse->output<float>();
+    for (int i = 0; i < size; i += 31) {
+        EXPECT_NEAR(out[i] / size, in[i], 1e-4f) << i;
+    }
+
+    // Other sizes go to FFTW when the build has it
+    FftPlan* odd = cache.get({1000, FftDirection::RealToComplex, FftPrecision::Double, FFT_PLAN_ESTIMATE});
+    FftPlan* large = cache.get({2 * STATIC_FFT_MAX_SIZE, FftDirection::Forward, FftPrecision::Double,
+                                FFT_PLAN_ESTIMATE});
+    if (fftBackendAvailable(FftBackend::Fftw)) {
+        ASSERT_NE(odd, nullptr);
+        ASSERT_NE(large, nullptr);
+        EXPECT_EQ(odd->backend(), FftBackend::Fftw);
+        EXPECT_EQ(large->backend(), FftBackend::Fftw);
+    } else {
+        EXPECT_EQ(odd, nullptr);
+        EXPECT_EQ(large, nullptr);
+    }
+
+    // Changing the backend drops the plans
+    EXPECT_EQ(cache.setBackend(FftBackend::Fftw), fftBackendAvailable(FftBackend::Fftw));
+    if (cache.backend() == FftBackend::Fftw) {
+        EXPECT_EQ(cache.size(), 0u);
+    }
+}
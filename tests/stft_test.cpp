@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "doppler.hpp"
+#include "stft.hpp"
+
+namespace {
+const double RATE = 10000.0;
+
+// A tone whose frequency (Hz) at each sample comes from `frequencyAt`,
+// with continuous phase
+template <typename Frequency>
+std::vector<int> sweep(size_t count, Frequency frequencyAt) {
+    std::vector<int> samples(count);
+    double phase = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = static_cast<int>(std::lround(512.0 + 400.0 * std::sin(phase)));
+        phase += 2.0 * M_PI * frequencyAt(i) / RATE;
+    }
+    return samples;
+}
+}
+
+class StftTest : public ::testing::Test {
+protected:
+    FftPlanCache plans;
+    WindowCache windows;
+};
+
+// Test that a frame is computed once the first frame is full, then every hop
+TEST_F(StftTest, FramesEveryHop) {
+    StftEngine engine(plans, windows, RATE, StftConfig(), FFT_PLAN_ESTIMATE);
+    std::vector<int> samples = sweep(1024, [](size_t) { return 1000.0; });
+
+    EXPECT_EQ(engine.push(samples.data(), 255), 0u);
+    EXPECT_EQ(engine.push(samples.data() + 255, 1), 1u);
+    EXPECT_EQ(engine.push(samples.data() + 256, 768), 12u);
+    ASSERT_EQ(engine.track().size(), 13u);
+    EXPECT_EQ(engine.samplesPushed(), 1024u);
+    EXPECT_DOUBLE_EQ(engine.frameRate(), RATE / 64);
+
+    for (size_t i = 0; i < engine.track().size(); i++) {
+        const StftFrame& frame = engine.track()[i];
+        EXPECT_EQ(frame.firstSample, i * 64);
+        EXPECT_NEAR(frame.frequency, 1000.0f, 2.0f);
+        EXPECT_NEAR(frame.speedMPH, speedForDopplerFrequency(1000.0f) * MPS_TO_MPH, 0.1f);
+        EXPECT_GT(frame.peakToNoise, 1000.0f);
+    }
+    EXPECT_EQ(engine.spectrum().size(), 129u);
+}
+
+// Test that pushing in blocks gives the same frames as pushing everything at once
+TEST_F(StftTest, IncrementalMatchesBatch) {
+    std::vector<int> samples = sweep(2048, [](size_t i) { return 500.0 + i; });
+    StftEngine batch(plans, windows, RATE, StftConfig(), FFT_PLAN_ESTIMATE);
+    StftEngine incremental(plans, windows, RATE, StftConfig(), FFT_PLAN_ESTIMATE);
+
+    batch.push(samples.data(), samples.size());
+    for (size_t i = 0; i < samples.size(); i += 37) {
+        incremental.push(samples.data() + i, std::min<size_t>(37, samples.size() - i));
+    }
+
+    ASSERT_EQ(batch.track().size(), incremental.track().size());
+    for (size_t i = 0; i < batch.track().size(); i++) {
+        EXPECT_EQ(batch.track()[i].firstSample, incremental.track()[i].firstSample);
+        EXPECT_FLOAT_EQ(batch.track()[i].frequency, incremental.track()[i].frequency);
+    }
+}
+
+// Test that the track follows a rising frequency and then a step to another tone
+TEST_F(StftTest, TracksChangingFrequency) {
+    // 1 kHz rising at 1 Hz per sample for 2048 samples, then a steady 1.5 kHz
+    auto frequencyAt = [](size_t i) { return i < 2048 ? 1000.0 + i : 1500.0; };
+    std::vector<int> samples = sweep(4096, frequencyAt);
+    StftConfig config;
+    config.hopSize = 128;
+    StftEngine engine(plans, windows, RATE, config, FFT_PLAN_ESTIMATE);
+    engine.push(samples.data(), samples.size());
+
+    for (const StftFrame& frame : engine.track()) {
+        size_t middle = frame.firstSample + config.frameSize / 2;
+        if (frame.firstSample + config.frameSize <= 2048) {
+            EXPECT_NEAR(frame.frequency, frequencyAt(middle), 20.0) << frame.firstSample;
+        } else if (frame.firstSample >= 2048) {
+            EXPECT_NEAR(frame.frequency, 1500.0, 5.0) << frame.firstSample;
+        }
+    }
+}
+
+// Test that frames are timed at their middle sample
+TEST_F(StftTest, FrameTimes) {
+    std::vector<int> samples = sweep(512, [](size_t) { return 800.0; });
+    std::vector<SteadyTime> times(samples.size());
+    SteadyTime start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < times.size(); i++) {
+        times[i] = start + std::chrono::microseconds(100 * i);
+    }
+
+    StftEngine engine(plans, windows, RATE, StftConfig(), FFT_PLAN_ESTIMATE);
+    engine.push(samples.data(), samples.size(), times.data());
+    ASSERT_EQ(engine.track().size(), 5u);
+    for (const StftFrame& frame : engine.track()) {
+        EXPECT_EQ(frame.time, times[frame.firstSample + 128]);
+    }
+}
+
+// Test the track length limit and reset
+TEST_F(StftTest, TrackLimitAndReset) {
+    StftConfig config;
+    config.maxTrackFrames = 4;
+    StftEngine engine(plans, windows, RATE, config, FFT_PLAN_ESTIMATE);
+    std::vector<int> samples = sweep(1024, [](size_t) { return 800.0; });
+    engine.push(samples.data(), samples.size());
+    ASSERT_EQ(engine.track().size(), 4u);
+    EXPECT_EQ(engine.track().back().firstSample, 768u);
+
+    engine.reset();
+    EXPECT_TRUE(engine.track().empty());
+    EXPECT_EQ(engine.push(samples.data(), 256), 1u);
+    EXPECT_EQ(engine.track().front().firstSample, 0u);
+}
+
+// Test that peaks below the minimum frequency are ignored
+TEST_F(StftTest, MinimumFrequency) {
+    // A strong slow return plus a weaker fast one
+    std::vector<int> samples(512);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<int>(std::lround(512.0 + 300.0 * std::sin(2.0 * M_PI * 200.0 * i / RATE) +
+                                                  100.0 * std::sin(2.0 * M_PI * 2000.0 * i / RATE)));
+    }
+    StftConfig config;
+    config.minFrequency = 500.0;
+    StftEngine engine(plans, windows, RATE, config, FFT_PLAN_ESTIMATE);
+    engine.push(samples.data(), samples.size());
+    ASSERT_FALSE(engine.track().empty());
+    EXPECT_NEAR(engine.track().back().frequency, 2000.0f, 5.0f);
+}
+
+// Test that two returns in a frame are both listed, strongest first
+TEST_F(StftTest, SeparatePeaks) {
+    std::vector<int> samples(256);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<int>(std::lround(512.0 + 300.0 * std::sin(2.0 * M_PI * 2500.0 * i / RATE) +
+                                                  120.0 * std::sin(2.0 * M_PI * 3700.0 * i / RATE)));
+    }
+    StftEngine engine(plans, windows, RATE, StftConfig(), FFT_PLAN_ESTIMATE);
+    ASSERT_EQ(engine.push(samples.data(), samples.size()), 1u);
+    
+    const StftFrame& frame = engine.track().back();
+    ASSERT_EQ(frame.peakCount, 2u);
+    EXPECT_NEAR(frame.peaks[0].frequency, 2500.0f, 3.0f);
+    EXPECT_FLOAT_EQ(frame.peaks[0].frequency, frame.frequency);
+    EXPECT_NEAR(frame.peaks[1].frequency, 3700.0f, 3.0f);
+    EXPECT_GT(frame.peaks[0].magnitude, frame.peaks[1].magnitude);
+    EXPECT_NEAR(frame.peaks[1].speedMPH, speedForDopplerFrequency(frame.peaks[1].frequency) * MPS_TO_MPH, 0.01f);
+}
+
+// Test that a bad configuration is rejected
+TEST_F(StftTest, InvalidConfig) {
+    StftConfig config;
+    config.hopSize = 0;
+    EXPECT_THROW(StftEngine(plans, windows, RATE, config, FFT_PLAN_ESTIMATE), std::invalid_argument);
+    config.hopSize = 512;
+    EXPECT_THROW(StftEngine(plans, windows, RATE, config, FFT_PLAN_ESTIMATE), std::invalid_argument);
+}
+
+// Test that pooled engines are reused for the same settings and come back reset
+TEST_F(StftTest, EnginePool) {
+    StftEnginePool pool;
+    std::vector<int> samples = sweep(512, [](size_t) { return 1500.0; });
+    
+    std::unique_ptr<StftEngine> engine = pool.take(plans, windows, RATE, StftConfig(), FFT_PLAN_ESTIMATE);
+    engine->push(samples.data(), samples.size());
+    ASSERT_FALSE(engine->track().empty());
+    const StftEngine* first = engine.get();
+    pool.give(std::move(engine), RATE, FFT_PLAN_ESTIMATE);
+    EXPECT_EQ(pool.size(), 1u);
+    
+    engine = pool.take(plans, windows, RATE, StftConfig(), FFT_PLAN_ESTIMATE);
+    EXPECT_EQ(engine.get(), first);
+    EXPECT_EQ(engine->samplesPushed(), 0u);
+    EXPECT_TRUE(engine->track().empty());
+    EXPECT_EQ(pool.size(), 0u);
+    
+    // Other settings get an engine of their own
+    StftConfig config;
+    config.hopSize = 32;
+    std::unique_ptr<StftEngine> other = pool.take(plans, windows, RATE, config, FFT_PLAN_ESTIMATE);
+    EXPECT_NE(other.get(), first);
+    EXPECT_EQ(other->config().hopSize, 32);
+    pool.give(std::move(engine), RATE, FFT_PLAN_ESTIMATE);
+    std::unique_ptr<StftEngine> otherRate = pool.take(plans, windows, 2 * RATE, StftConfig(), FFT_PLAN_ESTIMATE);
+    EXPECT_NE(otherRate.get(), first);
+    EXPECT_EQ(pool.size(), 1u);
+    
+    pool.clear();
+    EXPECT_EQ(pool.size(), 0u);
+}
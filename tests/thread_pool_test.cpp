@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "thread_pool.hpp"
+
+// Test that every task runs, and that wait() returns only when they have
+TEST(ThreadPoolTest, RunsEveryTask) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+
+    std::atomic<int> done{0};
+    for (int i = 0; i < 1000; i++) {
+        pool.submit([&done] { done++; });
+    }
+    pool.wait();
+    EXPECT_EQ(done.load(), 1000);
+
+    // Waiting with nothing queued returns at once
+    pool.wait();
+    EXPECT_GE(ThreadPool().size(), 1u);
+}
+
+// Test parallelFor over every index, in place
+TEST(ThreadPoolTest, ParallelFor) {
+    ThreadPool pool(3);
+    std::vector<size_t> squares(500);
+    pool.parallelFor(squares.size(), [&squares](size_t i) { squares[i] = i * i; });
+    for (size_t i = 0; i < squares.size(); i++) {
+        EXPECT_EQ(squares[i], i * i);
+    }
+}
+
+// Test idle workers taking tasks queued on a busy worker
+TEST(ThreadPoolTest, StealsFromBusyWorkers) {
+    ThreadPool pool(4);
+    std::atomic<int> done{0};
+
+    // Tasks submitted from a task all go on that worker's own queue
+    pool.submit([&pool, &done] {
+        for (int i = 0; i < 40; i++) {
+            pool.submit([&done] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                done++;
+            });
+        }
+    });
+    pool.wait();
+    EXPECT_EQ(done.load(), 40);
+    EXPECT_GT(pool.stolenTasks(), 0u);
+}
+
+// Test that a task's exception reaches wait() and the pool keeps working
+TEST(ThreadPoolTest, RethrowsTaskErrors) {
+    ThreadPool pool(2);
+    std::atomic<int> done{0};
+    pool.submit([] { throw std::runtime_error("bad capture"); });
+    for (int i = 0; i < 10; i++) {
+        pool.submit([&done] { done++; });
+    }
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+    EXPECT_EQ(done.load(), 10);
+
+    pool.submit([&done] { done++; });
+    EXPECT_NO_THROW(pool.wait());
+    EXPECT_EQ(done.load(), 11);
+}
+
+// Test that destroying the pool finishes the queued tasks first
+TEST(ThreadPoolTest, DestructorRunsQueuedTasks) {
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 20; i++) {
+            pool.submit([&done] {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                done++;
+            });
+        }
+    }
+    EXPECT_EQ(done.load(), 20);
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "timing.hpp"
+
+namespace {
+SteadyTime atSeconds(SteadyTime origin, double seconds) {
+    return origin + std::chrono::duration_cast<SteadyTime::duration>(
+        std::chrono::duration<double>(seconds));
+}
+}
+
+// Test timing statistics of an evenly spaced capture
+TEST(TimingTest, UniformTimestamps) {
+    auto origin = std::chrono::steady_clock::now();
+    std::vector<SteadyTime> timestamps;
+    for (int i = 0; i < 100; i++) {
+        timestamps.push_back(atSeconds(origin, i / 8000.0));
+    }
+    
+    SampleTiming timing = analyzeSampleTiming(timestamps);
+    EXPECT_NEAR(timing.effectiveRate, 8000.0, 0.5);
+    EXPECT_LT(timing.jitterRmsMicros, 0.01);
+    EXPECT_FALSE(timing.resampled);
+}
+
+// Test timing statistics with one late sample
+TEST(TimingTest, SingleGap) {
+    auto origin = std::chrono::steady_clock::now();
+    std::vector<SteadyTime> timestamps;
+    for (int i = 0; i < 11; i++) {
+        // Sample 5 is 50 us late, so one interval is long and the next short
+        double offset = (i == 5) ? 50e-6 : 0.0;
+        timestamps.push_back(atSeconds(origin, i * 100e-6 + offset));
+    }
+    
+    SampleTiming timing = analyzeSampleTiming(timestamps);
+    EXPECT_NEAR(timing.effectiveRate, 10000.0, 1.0);
+    EXPECT_NEAR(timing.jitterMaxMicros, 50.0, 0.1);
+    EXPECT_NEAR(timing.jitterRmsMicros, std::sqrt(2 * 50.0 * 50.0 / 10), 0.1);
+}
+
+// Test that too few timestamps give empty statistics
+TEST(TimingTest, NotEnoughTimestamps) {
+    SampleTiming timing = analyzeSampleTiming({std::chrono::steady_clock::now()});
+    EXPECT_EQ(timing.effectiveRate, 0.0);
+}
+
+// Test resampling a ramp recorded with irregular spacing
+TEST(TimingTest, ResampleRamp) {
+    auto origin = std::chrono::steady_clock::now();
+    std::vector<SteadyTime> timestamps;
+    std::vector<int> samples;
+    
+    // Value is the sample time in units of 10 us, taken at irregular times
+    double t = 0.0;
+    for (int i = 0; i < 50; i++) {
+        timestamps.push_back(atSeconds(origin, t));
+        samples.push_back(static_cast<int>(std::lround(t * 1e5)));
+        t += (i % 3 == 0) ? 150e-6 : 75e-6;
+    }
+    
+    std::vector<int> resampled;
+    resampleUniform(samples, timestamps, resampled);
+    ASSERT_EQ(resampled.size(), samples.size());
+    
+    // A ramp is reproduced exactly on the uniform grid
+    double step = std::chrono::duration<double>(timestamps.back() - timestamps.front()).count() / 49;
+    for (int i = 0; i < 50; i++) {
+        EXPECT_NEAR(resampled[i], i * step * 1e5, 1.0);
+    }
+}
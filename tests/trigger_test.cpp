@@ -191,3 +191,80 @@ TEST_F(TriggerTest, StateTransitions) {
     EXPECT_EQ(static_cast<int>(testManager.getState()), 
               static_cast<int>(TriggerState::IDLE));
 }
+
+// Test that radar detections are ignored in IR mode and fire in radar mode
+TEST_F(TriggerTest, RadarTriggerMode) {
+    auto detection = std::chrono::steady_clock::now() - std::chrono::milliseconds(3);
+    testManager.radarTriggered(detection);
+    EXPECT_FALSE(callbackCalled);
+    
+    testManager.setTriggerMode(TriggerMode::Radar);
+    EXPECT_EQ(testManager.getTriggerMode(), TriggerMode::Radar);
+    
+    // The IR sensor is ignored
+    testManager.setMockGpioValue(true);
+    testManager.update();
+    EXPECT_FALSE(callbackCalled);
+    
+    // The radar's own timestamp is passed on
+    testManager.radarTriggered(detection);
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_EQ(callbackTimestamp, detection);
+    
+    // Cooldown applies even if update() hasn't run
+    callbackCalled = false;
+    testManager.radarTriggered(detection + std::chrono::milliseconds(100));
+    EXPECT_FALSE(callbackCalled);
+    testManager.radarTriggered(detection + std::chrono::milliseconds(600));
+    EXPECT_TRUE(callbackCalled);
+}
+
+// Test that either detector fires, and the other one is then ignored
+TEST_F(TriggerTest, EitherTriggerMode) {
+    testManager.setTriggerMode(TriggerMode::Either);
+    testManager.setMockGpioValue(true);
+    testManager.update();
+    EXPECT_TRUE(callbackCalled);
+    
+    callbackCalled = false;
+    testManager.radarTriggered(std::chrono::steady_clock::now());
+    EXPECT_FALSE(callbackCalled);
+}
+
+// Test that both detectors are needed, with the radar's timestamp
+TEST_F(TriggerTest, BothTriggerMode) {
+    testManager.setTriggerMode(TriggerMode::Both);
+    
+    // Radar alone waits for the IR sensor
+    auto detection = std::chrono::steady_clock::now() - std::chrono::milliseconds(5);
+    testManager.radarTriggered(detection);
+    EXPECT_FALSE(callbackCalled);
+    
+    testManager.setMockGpioValue(true);
+    testManager.update();
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_EQ(callbackTimestamp, detection);
+    
+    // Back to idle, then IR first and a late radar detection
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    testManager.update();
+    testManager.update();
+    callbackCalled = false;
+    testManager.update();
+    EXPECT_FALSE(callbackCalled);
+    testManager.radarTriggered(std::chrono::steady_clock::now() + std::chrono::milliseconds(200));
+    EXPECT_FALSE(callbackCalled);
+    auto coincident = std::chrono::steady_clock::now();
+    testManager.radarTriggered(coincident);
+    EXPECT_TRUE(callbackCalled);
+    EXPECT_EQ(callbackTimestamp, coincident);
+}
+
+// Test trigger mode names
+TEST_F(TriggerTest, ParseTriggerModes) {
+    TriggerMode mode = TriggerMode::Ir;
+    EXPECT_TRUE(parseTriggerMode("both", mode));
+    EXPECT_EQ(mode, TriggerMode::Both);
+    EXPECT_EQ(triggerModeName(TriggerMode::Either), "either");
+    EXPECT_FALSE(parseTriggerMode("sonar", mode));
+}
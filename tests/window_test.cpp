@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "window.hpp"
+
+// Test the Hamming window against its closed form
+TEST(WindowTest, HammingMatchesFormula) {
+    const size_t size = 64;
+    std::vector<double> window = makeWindow(WindowType::Hamming, size);
+    ASSERT_EQ(window.size(), size);
+    for (size_t i = 0; i < size; i++) {
+        EXPECT_NEAR(window[i], 0.54 - 0.46 * std::cos(2.0 * M_PI * i / (size - 1)), 1e-12);
+    }
+}
+
+// Test the end points and symmetry of every window
+TEST(WindowTest, EndPointsAndSymmetry) {
+    const size_t size = 101;
+    struct Expected {
+        WindowType type;
+        double edge;
+    };
+    for (const Expected& expected : {Expected{WindowType::Hamming, 0.08},
+                                     Expected{WindowType::Hann, 0.0},
+                                     Expected{WindowType::BlackmanHarris, 6e-5},
+                                     Expected{WindowType::FlatTop, -4.2e-4}}) {
+        std::vector<double> window = makeWindow(expected.type, size);
+        EXPECT_NEAR(window.front(), expected.edge, 1e-5) << windowTypeName(expected.type);
+        EXPECT_NEAR(window[size / 2], 1.0, 1e-6) << windowTypeName(expected.type);
+        for (size_t i = 0; i < size / 2; i++) {
+            EXPECT_NEAR(window[i], window[size - 1 - i], 1e-12);
+        }
+    }
+}
+
+// Test Kaiser windows for a few betas
+TEST(WindowTest, KaiserBeta) {
+    // Beta 0 is a rectangular window
+    for (double value : makeWindow(WindowType::Kaiser, 32, 0.0)) {
+        EXPECT_NEAR(value, 1.0, 1e-12);
+    }
+    
+    // Larger beta tapers harder; the edge is 1 / I0(beta)
+    std::vector<double> window = makeWindow(WindowType::Kaiser, 33, 5.0);
+    EXPECT_NEAR(window.front(), 1.0 / 27.239871823604442, 1e-9);
+    EXPECT_NEAR(window[16], 1.0, 1e-12);
+}
+
+// Test window names used on the command line
+TEST(WindowTest, ParseNames) {
+    WindowType type = WindowType::Hamming;
+    EXPECT_TRUE(parseWindowType("blackman-harris", type));
+    EXPECT_EQ(type, WindowType::BlackmanHarris);
+    EXPECT_TRUE(parseWindowType("flat-top", type));
+    EXPECT_EQ(type, WindowType::FlatTop);
+    EXPECT_FALSE(parseWindowType("triangle", type));
+    EXPECT_EQ(type, WindowType::FlatTop);
+}
+
+// Test that tables are computed once and shared
+TEST(WindowTest, CacheReusesTables) {
+    WindowCache cache;
+    const AlignedVector<double>& first = cache.get(WindowType::Hann, 1024);
+    const AlignedVector<double>& second = cache.get(WindowType::Hann, 1024);
+    EXPECT_EQ(&first, &second);
+    
+    // Beta only distinguishes Kaiser tables
+    EXPECT_EQ(&cache.get(WindowType::Hann, 1024, 3.0), &first);
+    EXPECT_NE(&cache.get(WindowType::Kaiser, 1024, 3.0), &cache.get(WindowType::Kaiser, 1024, 8.0));
+    EXPECT_NE(&cache.get(WindowType::Hann, 512), &first);
+    EXPECT_EQ(cache.size(), 4u);
+}
+
+// Test that single precision tables match and all tables are SIMD aligned
+TEST(WindowTest, SinglePrecisionAlignedTables) {
+    WindowCache cache;
+    const AlignedVector<double>& coefficients = cache.get(WindowType::BlackmanHarris, 300);
+    const AlignedVector<float>& singleCoefficients = cache.getSingle(WindowType::BlackmanHarris, 300);
+    ASSERT_EQ(singleCoefficients.size(), coefficients.size());
+    for (size_t i = 0; i < coefficients.size(); i++) {
+        EXPECT_FLOAT_EQ(singleCoefficients[i], static_cast<float>(coefficients[i]));
+    }
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(coefficients.data()) % SIMD_ALIGNMENT, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(singleCoefficients.data()) % SIMD_ALIGNMENT, 0u);
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+// Test the single precision fused pass
+TEST(WindowTest, WindowSamplesSingle) {
+    std::vector<int> samples = {100, 300, 500, 700};
+    std::vector<float> window = {0.5f, 1.0f, 1.0f, 0.5f};
+    std::vector<float> out(samples.size());
+    
+    float mean = windowSamples(samples.data(), samples.size(), window.data(), out.data());
+    EXPECT_FLOAT_EQ(mean, 400.0f);
+    EXPECT_FLOAT_EQ(out[0], -150.0f);
+    EXPECT_FLOAT_EQ(out[1], -100.0f);
+    EXPECT_FLOAT_EQ(out[3], 150.0f);
+}
+
+// Test the fused conversion, DC removal and windowing pass
+TEST(WindowTest, WindowSamples) {
+    std::vector<int> samples = {510, 520, 530, 500, 490, 522, 518, 502};
+    std::vector<double> window = makeWindow(WindowType::Hann, samples.size());
+    std::vector<double> out(samples.size());
+    
+    double mean = windowSamples(samples.data(), samples.size(), window.data(), out.data());
+    EXPECT_DOUBLE_EQ(mean, 511.5);
+    for (size_t i = 0; i < samples.size(); i++) {
+        EXPECT_DOUBLE_EQ(out[i], (samples[i] - 511.5) * window[i]);
+    }
+}
+
+// Test the fixed-point pass from 16-bit samples against the floating point one
+TEST(WindowTest, WindowSamplesFixedPoint) {
+    WindowCache cache;
+    const size_t size = 1024;
+    const AlignedVector<int16_t>& fixed = cache.getFixed(WindowType::BlackmanHarris, size);
+    const AlignedVector<double>& window = cache.get(WindowType::BlackmanHarris, size);
+    ASSERT_EQ(fixed.size(), size);
+    EXPECT_EQ(fixed[size / 2 - 1], 32767);
+    
+    std::vector<int> samples(size);
+    for (size_t i = 0; i < size; i++) {
+        samples[i] = static_cast<int>(512 + 400 * std::sin(0.3 * i) + (i * 7919) % 23);
+    }
+    std::vector<int16_t> packed(samples.begin(), samples.end());
+    std::vector<double> expected(size);
+    std::vector<double> out(size);
+    std::vector<float> singleOut(size);
+    double expectedMean = windowSamples(samples.data(), size, window.data(), expected.data());
+    EXPECT_DOUBLE_EQ(windowSamples(packed.data(), size, fixed.data(), out.data()), expectedMean);
+    EXPECT_FLOAT_EQ(windowSamples(packed.data(), size, fixed.data(), singleOut.data()), expectedMean);
+    for (size_t i = 0; i < size; i++) {
+        // Within the rounding of the mean and the Q15 coefficients
+        ASSERT_NEAR(out[i], expected[i], 0.07) << i;
+        ASSERT_NEAR(singleOut[i], out[i], 1e-3) << i;
+    }
+    
+    // A span too wide for 32-bit products is windowed in floating point
+    packed = {-20000, 20000, -20000, 20000};
+    std::vector<int16_t> flat(4, 32767);
+    out.resize(4);
+    EXPECT_DOUBLE_EQ(windowSamples(packed.data(), 4, flat.data(), out.data()), 0.0);
+    EXPECT_NEAR(out[1], 20000.0 * 32767.0 / 32768.0, 1e-9);
+}
+
+// Test that centered captures are windowed the same without the mean pass
+TEST(WindowTest, ApplyWindowToCenteredSamples) {
+    const size_t size = 256;
+    std::vector<double> window = makeWindow(WindowType::Hann, size);
+    std::vector<float> singleWindow(window.begin(), window.end());
+    std::vector<int> samples(size);
+    for (size_t i = 0; i < size; i++) {
+        samples[i] = static_cast<int>(std::lround(300 * std::sin(2.0 * M_PI * 16 * i / size)));
+    }
+    std::vector<double> expected(size);
+    std::vector<double> out(size);
+    std::vector<float> singleOut(size);
+    EXPECT_NEAR(windowSamples(samples.data(), size, window.data(), expected.data()), 0.0, 1e-9);
+    applyWindow(samples.data(), size, window.data(), out.data());
+    applyWindow(samples.data(), size, singleWindow.data(), singleOut.data());
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_NEAR(out[i], expected[i], 1e-9) << i;
+        ASSERT_NEAR(singleOut[i], expected[i], 1e-3) << i;
+    }
+}